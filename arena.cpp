@@ -0,0 +1,92 @@
+#include "arena.h"
+#include <cstdint>
+#include <cstring>
+
+//Chunks double in size up to this limit
+static const size_t max_chunk_size = 1024 * 1024;
+
+Arena::~Arena() {
+	clear();
+}
+
+char* Arena::allocate_chunk(size_t size) {
+	Chunk* chunk = static_cast<Chunk*>(::operator new(sizeof(Chunk) + size));
+
+	chunk->next = chunks;
+	chunks = chunk;
+	reserved += sizeof(Chunk) + size;
+
+	return reinterpret_cast<char*>(chunk + 1);
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment) {
+	uintptr_t aligned = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+
+	if (cursor == nullptr || aligned + bytes > reinterpret_cast<uintptr_t>(limit)) {
+		if (bytes + alignment > next_chunk_size / 4) {
+			//A large block, like the coordinates of a long path, gets a chunk of its own.
+			//This keeps the free space at the end of the current chunk usable.
+			char* block = allocate_chunk(bytes + alignment);
+
+			used += bytes;
+
+			return reinterpret_cast<void*>((reinterpret_cast<uintptr_t>(block) + alignment - 1) & ~(uintptr_t)(alignment - 1));
+		}
+
+		cursor = allocate_chunk(next_chunk_size);
+		limit = cursor + next_chunk_size;
+
+		if (next_chunk_size < max_chunk_size) {
+			next_chunk_size *= 2;
+		}
+
+		aligned = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+	}
+
+	cursor = reinterpret_cast<char*>(aligned + bytes);
+	used += bytes;
+
+	return reinterpret_cast<void*>(aligned);
+}
+
+void Arena::add_finalizer(void* object, void (*destroy)(void*)) {
+	Finalizer* finalizer = static_cast<Finalizer*>(allocate(sizeof(Finalizer), alignof(Finalizer)));
+
+	finalizer->destroy = destroy;
+	finalizer->object = object;
+	finalizer->next = finalizers;
+	finalizers = finalizer;
+}
+
+std::string_view Arena::copy_string(std::string_view source) {
+	if (source.empty()) {
+		return std::string_view();
+	}
+
+	char* copy = static_cast<char*>(allocate(source.size(), 1));
+
+	std::memcpy(copy, source.data(), source.size());
+
+	return std::string_view(copy, source.size());
+}
+
+void Arena::clear() {
+	//Objects are destroyed in reverse order of creation, like local variables
+	for (Finalizer* finalizer = finalizers; finalizer; finalizer = finalizer->next) {
+		finalizer->destroy(finalizer->object);
+	}
+
+	while (chunks) {
+		Chunk* next = chunks->next;
+
+		::operator delete(chunks);
+		chunks = next;
+	}
+
+	finalizers = nullptr;
+	cursor = nullptr;
+	limit = nullptr;
+	next_chunk_size = 4096;
+	reserved = 0;
+	used = 0;
+}
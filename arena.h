@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+//True for types whose members keep all their memory in the arena, like std::pmr
+//containers made with it, so their destructor has nothing to release and the arena
+//doesn't run it. A type says so with a member naming the type itself:
+//
+//	using ArenaOwned = SVGRectElement;
+//
+//A subclass inherits the member with the name of its base, so a subclass that adds a
+//member of its own is still destroyed unless it says so too.
+template <typename T, typename = void>
+struct is_arena_owned : std::false_type {};
+
+template <typename T>
+struct is_arena_owned<T, std::void_t<typename T::ArenaOwned>> : std::is_same<typename T::ArenaOwned, T> {};
+
+//A monotonic allocator that owns all the memory of a loaded image. Memory is handed
+//out from large chunks by bumping a pointer and is never freed piecemeal. Everything
+//goes back to the heap at once when the arena is cleared or destroyed.
+//Objects that need their destructor to run, because they hold memory or resources
+//from outside the arena, are recorded when they are created and destroyed in reverse
+//order just before the chunks are freed. See is_arena_owned for the ones that don't.
+//The arena is also a std::pmr::memory_resource, so the vectors of an element can
+//live in the same chunks as the element itself.
+class Arena : public std::pmr::memory_resource {
+public:
+	Arena() = default;
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+	~Arena();
+
+	//Creates an object in the arena. It is owned by the arena and must not be deleted.
+	template <typename T, typename... Args>
+	T* create(Args&&... args) {
+		T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+
+		if constexpr (!std::is_trivially_destructible_v<T> && !is_arena_owned<T>::value) {
+			add_finalizer(object, [](void* p) { static_cast<T*>(p)->~T(); });
+		}
+
+		return object;
+	}
+
+	//Copies a string into the arena. The copy is not null terminated.
+	std::string_view copy_string(std::string_view source);
+
+	//Destroys all objects and returns all memory to the heap.
+	void clear();
+
+	//Bytes taken from the heap, including unused space at the end of chunks.
+	size_t reserved_bytes() const { return reserved; }
+	//Bytes handed out so far.
+	size_t used_bytes() const { return used; }
+
+private:
+	struct Chunk {
+		Chunk* next;
+	};
+
+	struct Finalizer {
+		void (*destroy)(void*);
+		void* object;
+		Finalizer* next;
+	};
+
+	Chunk* chunks = nullptr;
+	char* cursor = nullptr;
+	char* limit = nullptr;
+	//Size of the next chunk. Grows as the image gets bigger.
+	size_t next_chunk_size = 4096;
+	Finalizer* finalizers = nullptr;
+	size_t reserved = 0;
+	size_t used = 0;
+
+	void add_finalizer(void* object, void (*destroy)(void*));
+	char* allocate_chunk(size_t size);
+
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	//Memory is only released by clear()
+	void do_deallocate(void*, size_t, size_t) override {}
+	bool do_is_equal(const std::pmr::memory_resource& that) const noexcept override { return this == &that; }
+};
@@ -0,0 +1,258 @@
+#include "atoms.h"
+#include <array>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+//Names of the static atoms in the order of the Atom enum
+static constexpr std::string_view static_atom_names[] = {
+	"",
+	//Elements
+	"svg",
+	"g",
+	"defs",
+	"use",
+	"symbol",
+	"rect",
+	"circle",
+	"ellipse",
+	"line",
+	"path",
+	"polyline",
+	"polygon",
+	"text",
+	"tspan",
+	"linearGradient",
+	"radialGradient",
+	"stop",
+	"style",
+	"title",
+	"desc",
+	"metadata",
+	"image",
+	"clipPath",
+	"mask",
+	"pattern",
+	"marker",
+	"switch",
+	"a",
+	"filter",
+	//Attributes
+	"id",
+	"class",
+	"x",
+	"y",
+	"width",
+	"height",
+	"rx",
+	"ry",
+	"cx",
+	"cy",
+	"r",
+	"fx",
+	"fy",
+	"fr",
+	"x1",
+	"y1",
+	"x2",
+	"y2",
+	"d",
+	"points",
+	"transform",
+	"gradientTransform",
+	"gradientUnits",
+	"spreadMethod",
+	"offset",
+	"href",
+	"viewBox",
+	"preserveAspectRatio",
+	"version",
+	"xmlns",
+	//Presentation properties
+	"fill",
+	"fill-opacity",
+	"fill-rule",
+	"opacity",
+	"stroke",
+	"stroke-opacity",
+	"stroke-width",
+	"stroke-linecap",
+	"stroke-linejoin",
+	"stroke-miterlimit",
+	"stroke-dasharray",
+	"stroke-dashoffset",
+	"stop-color",
+	"stop-opacity",
+	"font-family",
+	"font-size",
+	"font-weight",
+	"font-style",
+	"white-space",
+	"display",
+	"visibility",
+	"color",
+};
+
+static_assert(sizeof(static_atom_names) / sizeof(static_atom_names[0]) == static_cast<size_t>(Atom::Count),
+	"static_atom_names must match the Atom enum");
+
+//The perfect hash is FNV-1a with a seed. The seed is chosen so that no two static
+//atoms share a slot in the table. If a new atom causes a collision the build fails
+//and another seed must be picked.
+static constexpr uint32_t atom_hash_seed = 4;
+static constexpr size_t atom_table_size = 1024;
+
+static constexpr uint32_t atom_hash(std::string_view name) {
+	uint32_t h = 2166136261u ^ atom_hash_seed;
+
+	for (char ch : name) {
+		h ^= static_cast<unsigned char>(ch);
+		h *= 16777619u;
+	}
+
+	return h;
+}
+
+struct AtomTable {
+	//Atom value in each slot. 0 means the slot is empty.
+	std::array<uint8_t, atom_table_size> slots{};
+	bool has_collision = false;
+};
+
+static constexpr AtomTable build_atom_table() {
+	AtomTable table{};
+
+	for (size_t i = 1; i < static_cast<size_t>(Atom::Count); ++i) {
+		size_t slot = atom_hash(static_atom_names[i]) & (atom_table_size - 1);
+
+		if (table.slots[slot] != 0) {
+			table.has_collision = true;
+		}
+
+		table.slots[slot] = static_cast<uint8_t>(i);
+	}
+
+	return table;
+}
+
+static constexpr AtomTable atom_table = build_atom_table();
+
+static_assert(!atom_table.has_collision, "Static atoms collide in the perfect hash. Pick another atom_hash_seed.");
+static_assert(static_cast<size_t>(Atom::Count) <= 256, "Slots are 8 bit");
+
+Atom find_atom(std::string_view name) {
+	uint8_t index = atom_table.slots[atom_hash(name) & (atom_table_size - 1)];
+
+	if (index != 0 && static_atom_names[index] == name) {
+		return static_cast<Atom>(index);
+	}
+
+	return Atom::Unknown;
+}
+
+//Names interned at run time. A deque keeps the strings at stable addresses
+//so that the map can key on views into them.
+struct DynamicAtoms {
+	std::mutex lock;
+	std::deque<std::string> names;
+	std::unordered_map<std::string_view, Atom> index;
+};
+
+static DynamicAtoms& dynamic_atoms() {
+	static DynamicAtoms atoms;
+
+	return atoms;
+}
+
+Atom intern_atom(std::string_view name) {
+	Atom atom = find_atom(name);
+
+	if (atom != Atom::Unknown || name.empty()) {
+		return atom;
+	}
+
+	DynamicAtoms& atoms = dynamic_atoms();
+	std::lock_guard<std::mutex> guard(atoms.lock);
+	auto it = atoms.index.find(name);
+
+	if (it != atoms.index.end()) {
+		return it->second;
+	}
+
+	size_t value = static_cast<size_t>(Atom::Count) + atoms.names.size();
+
+	if (value > UINT16_MAX) {
+		//Table is full. Only a hostile document would get here.
+		return Atom::Unknown;
+	}
+
+	atoms.names.emplace_back(name);
+	atom = static_cast<Atom>(value);
+	atoms.index[atoms.names.back()] = atom;
+
+	return atom;
+}
+
+Atom find_interned_atom(std::string_view name) {
+	Atom atom = find_atom(name);
+
+	if (atom != Atom::Unknown || name.empty()) {
+		return atom;
+	}
+
+	DynamicAtoms& atoms = dynamic_atoms();
+	std::lock_guard<std::mutex> guard(atoms.lock);
+	auto it = atoms.index.find(name);
+
+	return it != atoms.index.end() ? it->second : Atom::Unknown;
+}
+
+std::string_view atom_name(Atom atom) {
+	size_t value = static_cast<size_t>(atom);
+
+	if (value < static_cast<size_t>(Atom::Count)) {
+		return static_atom_names[value];
+	}
+
+	DynamicAtoms& atoms = dynamic_atoms();
+	std::lock_guard<std::mutex> guard(atoms.lock);
+
+	value -= static_cast<size_t>(Atom::Count);
+
+	return value < atoms.names.size() ? std::string_view(atoms.names[value]) : std::string_view();
+}
+
+void AtomMap::set(Atom atom, std::string_view value) {
+	//The entries were created with an arena
+	value = static_cast<Arena*>(entries.get_allocator().resource())->copy_string(value);
+
+	for (auto& entry : entries) {
+		if (entry.first == atom) {
+			entry.second = value;
+
+			return;
+		}
+	}
+
+	entries.emplace_back(atom, value);
+}
+
+const std::string_view* AtomMap::find(Atom atom) const {
+	for (const auto& entry : entries) {
+		if (entry.first == atom) {
+			return &entry.second;
+		}
+	}
+
+	return nullptr;
+}
+
+size_t AtomMap::heap_size() const {
+	size_t bytes = entries.capacity() * sizeof(entries[0]);
+
+	for (const auto& entry : entries) {
+		bytes += entry.second.size();
+	}
+
+	return bytes;
+}
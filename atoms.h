@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "arena.h"
+
+//Interned names of elements, attributes and presentation properties.
+//Names known to the library have fixed values and are found with a perfect hash.
+//Other names are interned on first use and get values from Atom::Count onwards.
+//Atoms are compared as integers, so no string compare is needed once a name is interned.
+enum class Atom : uint16_t {
+	Unknown,
+	//Elements
+	Svg,
+	G,
+	Defs,
+	Use,
+	Symbol,
+	Rect,
+	Circle,
+	Ellipse,
+	Line,
+	Path,
+	Polyline,
+	Polygon,
+	Text,
+	Tspan,
+	LinearGradient,
+	RadialGradient,
+	Stop,
+	Style,
+	Title,
+	Desc,
+	Metadata,
+	Image,
+	ClipPath,
+	Mask,
+	Pattern,
+	Marker,
+	Switch,
+	A,
+	Filter,
+	//Attributes
+	Id,
+	Class,
+	X,
+	Y,
+	Width,
+	Height,
+	Rx,
+	Ry,
+	Cx,
+	Cy,
+	R,
+	Fx,
+	Fy,
+	Fr,
+	X1,
+	Y1,
+	X2,
+	Y2,
+	D,
+	Points,
+	Transform,
+	GradientTransform,
+	GradientUnits,
+	SpreadMethod,
+	Offset,
+	Href,
+	ViewBox,
+	PreserveAspectRatio,
+	Version,
+	Xmlns,
+	//Presentation properties
+	Fill,
+	FillOpacity,
+	FillRule,
+	Opacity,
+	Stroke,
+	StrokeOpacity,
+	StrokeWidth,
+	StrokeLinecap,
+	StrokeLinejoin,
+	StrokeMiterlimit,
+	StrokeDasharray,
+	StrokeDashoffset,
+	StopColor,
+	StopOpacity,
+	FontFamily,
+	FontSize,
+	FontWeight,
+	FontStyle,
+	WhiteSpace,
+	Display,
+	Visibility,
+	Color,
+	//Number of static atoms
+	Count
+};
+
+//Looks up a name among the static atoms. Returns Atom::Unknown if it is not one.
+//Does not allocate or lock.
+Atom find_atom(std::string_view name);
+
+//Returns the atom for a name. Names that are not static atoms are added to a
+//process wide table. This is safe to call from multiple threads. The table never
+//shrinks, so only names chosen by the application, not by documents, are interned.
+Atom intern_atom(std::string_view name);
+
+//Looks up a name among the static atoms and the ones added by intern_atom(). Returns
+//Atom::Unknown for any other name, and never adds it. Used for names read from documents.
+Atom find_interned_atom(std::string_view name);
+
+//Returns the name of an atom. The view remains valid for the life of the process.
+std::string_view atom_name(Atom atom);
+
+//A small map from atoms to string values. Elements only have a handful of entries,
+//so a flat vector with a linear scan is smaller and faster than a tree.
+//The entries and the values are stored in the arena of the document.
+struct AtomMap {
+	std::pmr::vector<std::pair<Atom, std::string_view>> entries;
+
+	explicit AtomMap(Arena& arena) : entries(&arena) {}
+	//Copies that map into arena. Values are shared since they never change.
+	AtomMap(const AtomMap& that, Arena& arena) : entries(that.entries, &arena) {}
+
+	bool empty() const { return entries.empty(); }
+	size_t size() const { return entries.size(); }
+
+	//Adds a value or replaces the existing one. The value is copied into the arena.
+	void set(Atom atom, std::string_view value);
+
+	//Returns the value of atom or null if there is none.
+	const std::string_view* find(Atom atom) const;
+
+	//Bytes used by the entries and their values, for memory reports.
+	size_t heap_size() const;
+};
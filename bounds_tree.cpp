@@ -0,0 +1,295 @@
+#include "bounds_tree.h"
+#include <algorithm>
+#include <cmath>
+
+//Levels above the leaves that a tree of 2^32 entries needs
+static const uint32_t max_levels = 8;
+
+//Spreads the 16 bits of value to the even bits of the result
+static uint32_t interleave_bits(uint32_t value) {
+	value = (value | (value << 8)) & 0x00ff00ff;
+	value = (value | (value << 4)) & 0x0f0f0f0f;
+	value = (value | (value << 2)) & 0x33333333;
+	value = (value | (value << 1)) & 0x55555555;
+
+	return value;
+}
+
+//Position of the point x, y on a Hilbert curve through a 65536 x 65536 grid. The
+//rotations of all 16 levels of the curve are worked out together with bit operations,
+//in 4 steps of doubling width, instead of a loop with a branch per level.
+static uint32_t get_hilbert_index(uint32_t x, uint32_t y) {
+	uint32_t a = x ^ y;
+	uint32_t b = 0xffff ^ a;
+	uint32_t c = 0xffff ^ (x | y);
+	uint32_t d = x & (y ^ 0xffff);
+
+	uint32_t next_a = a | (b >> 1);
+	uint32_t next_b = (a >> 1) ^ a;
+	uint32_t next_c = ((c >> 1) ^ (b & (d >> 1))) ^ c;
+	uint32_t next_d = ((a & (c >> 1)) ^ (d >> 1)) ^ d;
+
+	a = next_a;
+	b = next_b;
+	c = next_c;
+	d = next_d;
+	next_a = (a & (a >> 2)) ^ (b & (b >> 2));
+	next_b = (a & (b >> 2)) ^ (b & ((a ^ b) >> 2));
+	next_c = c ^ (a & (c >> 2)) ^ (b & (d >> 2));
+	next_d = d ^ (b & (c >> 2)) ^ ((a ^ b) & (d >> 2));
+
+	a = next_a;
+	b = next_b;
+	c = next_c;
+	d = next_d;
+	next_a = (a & (a >> 4)) ^ (b & (b >> 4));
+	next_b = (a & (b >> 4)) ^ (b & ((a ^ b) >> 4));
+	next_c = c ^ (a & (c >> 4)) ^ (b & (d >> 4));
+	next_d = d ^ (b & (c >> 4)) ^ ((a ^ b) & (d >> 4));
+
+	a = next_a;
+	b = next_b;
+	c = next_c ^ (next_a & (next_c >> 8)) ^ (next_b & (next_d >> 8));
+	d = next_d ^ (next_b & (next_c >> 8)) ^ ((next_a ^ next_b) & (next_d >> 8));
+
+	a = c ^ (c >> 1);
+	b = d ^ (d >> 1);
+
+	uint32_t low = x ^ y;
+	uint32_t high = b | (0xffff ^ (low | a));
+
+	return (interleave_bits(high) << 1) | interleave_bits(low);
+}
+
+//Maps value from [low, low + size] to a cell of the Hilbert grid. Values that are not
+//finite, like the center of infinite bounds, go to the first cell.
+static uint32_t get_grid_cell(float value, float low, float size) {
+	float cell = size > 0.0f ? (value - low) / size * 65535.0f : 0.0f;
+
+	if (!(cell >= 0.0f)) {
+		return 0;
+	}
+
+	return cell >= 65535.0f ? 65535 : static_cast<uint32_t>(cell);
+}
+
+//Sorts entries by their keys, a byte of the key at a time from the lowest. Entries with
+//the same key keep their order.
+static void sort_by_key(std::vector<uint32_t>& keys, std::vector<uint32_t>& entries) {
+	std::vector<uint32_t> sorted_keys(keys.size());
+	std::vector<uint32_t> sorted_entries(entries.size());
+
+	for (uint32_t shift = 0; shift < 32; shift += 8) {
+		//Where the entries of each byte value go
+		size_t starts[257] = {};
+
+		for (uint32_t key : keys) {
+			++starts[((key >> shift) & 255) + 1];
+		}
+
+		for (size_t i = 1; i < 257; ++i) {
+			starts[i] += starts[i - 1];
+		}
+
+		for (size_t i = 0; i < keys.size(); ++i) {
+			size_t position = starts[(keys[i] >> shift) & 255]++;
+
+			sorted_keys[position] = keys[i];
+			sorted_entries[position] = entries[i];
+		}
+
+		keys.swap(sorted_keys);
+		entries.swap(sorted_entries);
+	}
+}
+
+void BoundsTree::build(const Bounds* bounds, size_t count) {
+	clear();
+
+	if (count == 0) {
+		return;
+	}
+
+	//Extent of the centers that are finite
+	float left = INFINITY, top = INFINITY, right = -INFINITY, bottom = -INFINITY;
+
+	for (size_t i = 0; i < count; ++i) {
+		float x = (bounds[i].left + bounds[i].right) / 2.0f;
+		float y = (bounds[i].top + bounds[i].bottom) / 2.0f;
+
+		if (std::isfinite(x) && std::isfinite(y)) {
+			left = std::fmin(left, x);
+			top = std::fmin(top, y);
+			right = std::fmax(right, x);
+			bottom = std::fmax(bottom, y);
+		}
+	}
+
+	std::vector<uint32_t> keys(count);
+	std::vector<uint32_t> entries(count);
+
+	for (size_t i = 0; i < count; ++i) {
+		uint32_t x = get_grid_cell((bounds[i].left + bounds[i].right) / 2.0f, left, right - left);
+		uint32_t y = get_grid_cell((bounds[i].top + bounds[i].bottom) / 2.0f, top, bottom - top);
+
+		keys[i] = get_hilbert_index(x, y);
+		entries[i] = static_cast<uint32_t>(i);
+	}
+
+	sort_by_key(keys, entries);
+
+	//Each level holds about 1/node_size as many nodes as the one below
+	size_t node_count = count + count / (node_size - 1) + max_levels;
+
+	boxes.reserve(node_count);
+	indices.reserve(node_count);
+	leaf_of.resize(count);
+
+	for (size_t i = 0; i < count; ++i) {
+		uint32_t entry = entries[i];
+
+		boxes.push_back(bounds[entry]);
+		indices.push_back(entry);
+		leaf_of[entry] = static_cast<uint32_t>(i);
+	}
+
+	level_ends.push_back(static_cast<uint32_t>(count));
+
+	uint32_t start = 0;
+	uint32_t end = static_cast<uint32_t>(count);
+
+	while (end - start > 1) {
+		for (uint32_t first = start; first < end; first += node_size) {
+			uint32_t last = std::min(first + node_size, end);
+			Bounds box = boxes[first];
+
+			for (uint32_t child = first + 1; child < last; ++child) {
+				add_bounds(box, boxes[child]);
+			}
+
+			boxes.push_back(box);
+			indices.push_back(first);
+		}
+
+		start = end;
+		end = static_cast<uint32_t>(boxes.size());
+		level_ends.push_back(end);
+	}
+
+	boxes.shrink_to_fit();
+	indices.shrink_to_fit();
+}
+
+void BoundsTree::clear() {
+	boxes.clear();
+	indices.clear();
+	leaf_of.clear();
+	level_ends.clear();
+}
+
+Bounds BoundsTree::get_bounds() const {
+	return boxes.empty() ? Bounds{ INFINITY, INFINITY, -INFINITY, -INFINITY } : boxes.back();
+}
+
+void BoundsTree::query(const Bounds& rect, std::vector<uint32_t>& found) const {
+	if (boxes.empty() || !bounds_intersect(boxes.back(), rect)) {
+		return;
+	}
+
+	//Nodes that reach rect and whose children are still to be tested. Popping a node
+	//pushes at most node_size nodes of the level below it.
+	uint32_t stack[node_size * max_levels + 1];
+	size_t depth = 0;
+	uint32_t leaf_end = level_ends.front();
+
+	stack[depth++] = static_cast<uint32_t>(boxes.size() - 1);
+
+	while (depth > 0) {
+		uint32_t node = stack[--depth];
+
+		if (node < leaf_end) {
+			found.push_back(indices[node]);
+
+			continue;
+		}
+
+		//The children are up to node_size nodes of the level below, and that level ends
+		//at the first level end past them
+		uint32_t first = indices[node];
+		uint32_t last = std::min(first + node_size, *std::upper_bound(level_ends.begin(), level_ends.end(), first));
+
+		for (uint32_t child = first; child < last; ++child) {
+			if (!bounds_intersect(boxes[child], rect)) {
+				continue;
+			}
+
+			if (child < leaf_end) {
+				found.push_back(indices[child]);
+			}
+			else {
+				stack[depth++] = child;
+			}
+		}
+	}
+}
+
+void BoundsTree::query_point(float x, float y, std::vector<uint32_t>& found) const {
+	query(Bounds{ x, y, x, y }, found);
+}
+
+void BoundsTree::update(uint32_t entry, const Bounds& bounds) {
+	uint32_t node = leaf_of[entry];
+
+	boxes[node] = bounds;
+
+	//A node's position in its level gives the position of its parent in the next
+	for (size_t level = 0; level + 1 < level_ends.size(); ++level) {
+		uint32_t start = level == 0 ? 0 : level_ends[level - 1];
+		uint32_t parent = level_ends[level] + (node - start) / node_size;
+		uint32_t first = indices[parent];
+		uint32_t last = std::min(first + node_size, level_ends[level]);
+		Bounds box = boxes[first];
+
+		for (uint32_t child = first + 1; child < last; ++child) {
+			add_bounds(box, boxes[child]);
+		}
+
+		Bounds& old = boxes[parent];
+
+		if (old.left == box.left && old.top == box.top && old.right == box.right && old.bottom == box.bottom) {
+			//The nodes further up don't change either
+			return;
+		}
+
+		old = box;
+		node = parent;
+	}
+}
+
+void BoundsTree::refit(const Bounds* bounds) {
+	uint32_t leaf_end = level_ends.empty() ? 0 : level_ends.front();
+
+	for (uint32_t node = 0; node < leaf_end; ++node) {
+		boxes[node] = bounds[indices[node]];
+	}
+
+	//Each level is made from the one before it
+	for (uint32_t node = leaf_end; node < boxes.size(); ++node) {
+		uint32_t first = indices[node];
+		uint32_t last = std::min(first + node_size, *std::upper_bound(level_ends.begin(), level_ends.end(), first));
+		Bounds box = boxes[first];
+
+		for (uint32_t child = first + 1; child < last; ++child) {
+			add_bounds(box, boxes[child]);
+		}
+
+		boxes[node] = box;
+	}
+}
+
+size_t BoundsTree::get_memory_size() const {
+	return boxes.capacity() * sizeof(Bounds) +
+		indices.capacity() * sizeof(uint32_t) +
+		leaf_of.capacity() * sizeof(uint32_t) +
+		level_ends.capacity() * sizeof(uint32_t);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "transform.h"
+
+//A packed R-tree over a fixed set of boxes, for finding the ones that reach a rect or
+//a point without testing them all. Entries are numbered like the boxes passed to
+//build(). The leaves are sorted along a Hilbert curve through the centers of the boxes,
+//so boxes that are near each other share nodes, and each node holds the union of up to
+//node_size nodes of the level below. Nodes are stored level by level in flat arrays,
+//without pointers. The bounds of an entry can change later with update(), which refits
+//the nodes above it without building the tree again.
+class BoundsTree {
+public:
+	static const uint32_t node_size = 16;
+
+	//Replaces the tree with one for the count boxes in bounds
+	void build(const Bounds* bounds, size_t count);
+	void clear();
+
+	bool empty() const { return leaf_of.empty(); }
+	size_t size() const { return leaf_of.size(); }
+
+	//Union of the bounds of all entries. Empty bounds if the tree is empty.
+	Bounds get_bounds() const;
+
+	//Appends the entries whose bounds intersect rect to found, in no particular order.
+	//Touching counts as intersecting, like bounds_intersect().
+	void query(const Bounds& rect, std::vector<uint32_t>& found) const;
+	//Appends the entries whose bounds hold the point to found, in no particular order
+	void query_point(float x, float y, std::vector<uint32_t>& found) const;
+
+	//Sets the bounds of entry, and refits the nodes above it
+	void update(uint32_t entry, const Bounds& bounds);
+	//Sets the bounds of all entries from the size() boxes in bounds, and refits every node
+	//once. Faster than update() when many entries change. The entries keep their leaves,
+	//so queries slow down if they moved far from their neighbors, and build() is better then.
+	void refit(const Bounds* bounds);
+
+	//Bytes held by the tree
+	size_t get_memory_size() const;
+
+private:
+	//Bounds of the nodes. The leaves come first, in Hilbert order, followed by each level
+	//above them. The root is last.
+	std::vector<Bounds> boxes;
+	//For a leaf, the entry. For a node above, the position of its first child in boxes.
+	std::vector<uint32_t> indices;
+	//Position of the leaf of each entry in boxes
+	std::vector<uint32_t> leaf_of;
+	//Position in boxes after the last node of each level, leaves first
+	std::vector<uint32_t> level_ends;
+};
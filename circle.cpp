@@ -1,25 +1,24 @@
-#include "svglib.h"
-#include "circle.h"
-
-void SVGCircleElement::compute_bbox() {
-	bbox.left = points[0] - points[2];
-	bbox.top = points[1] - points[2];
-	bbox.right = points[0] + points[2];
-	bbox.bottom = points[1] + points[2];
-}
-
-void SVGCircleElement::render(const SVGDevice& device) const {
-	if (fill_brush) {
-		device.device_context->FillEllipse(
-			D2D1::Ellipse(D2D1::Point2F(points[0], points[1]), points[2], points[2]),
-			fill_brush
-		);
-	}
-	if (stroke_brush) {
-		device.device_context->DrawEllipse(
-			D2D1::Ellipse(D2D1::Point2F(points[0], points[1]), points[2], points[2]),
-			stroke_brush,
-			stroke_width
-		);
-	}
+#include "document.h"
+#include "circle.h"
+
+void SVGCircleElement::compute_bbox() {
+	bbox.left = points[0] - points[2];
+	bbox.top = points[1] - points[2];
+	bbox.right = points[0] + points[2];
+	bbox.bottom = points[1] + points[2];
+}
+
+bool SVGCircleElement::to_path_data(PathData& path) const {
+	append_ellipse(path, points[0], points[1], points[2], points[2]);
+
+	return true;
+}
+
+void SVGCircleElement::render(SVGRenderer& renderer, const SVGPaint& paint) const {
+	if (paint.style.fill.type != PaintType::None) {
+		renderer.fill_ellipse(points[0], points[1], points[2], points[2], paint);
+	}
+	if (paint.style.stroke.type != PaintType::None) {
+		renderer.stroke_ellipse(points[0], points[1], points[2], points[2], paint);
+	}
 }
\ No newline at end of file
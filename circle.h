@@ -1,7 +1,11 @@
-#pragma once
-
-struct SVGCircleElement : public SVGGraphicsElement {
-	void compute_bbox() override;
-	void render(const SVGDevice& device) const override;
-};
-
+#pragma once
+
+struct SVGCircleElement : public SVGGraphicsElement {
+	using ArenaOwned = SVGCircleElement;
+	using SVGGraphicsElement::SVGGraphicsElement;
+
+	void compute_bbox();
+	bool to_path_data(PathData& path) const;
+	void render(SVGRenderer& renderer, const SVGPaint& paint) const;
+};
+
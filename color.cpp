@@ -0,0 +1,595 @@
+#include "color.h"
+#include "number.h"
+#include <array>
+#include <cmath>
+
+struct NamedColor {
+	std::string_view name;
+	uint32_t rgb;
+};
+
+static constexpr NamedColor named_colors[] = {
+	{ "aliceblue", 0xF0F8FF },
+	{ "antiquewhite", 0xFAEBD7 },
+	{ "aqua", 0x00FFFF },
+	{ "aquamarine", 0x7FFFD4 },
+	{ "azure", 0xF0FFFF },
+	{ "beige", 0xF5F5DC },
+	{ "bisque", 0xFFE4C4 },
+	{ "black", 0x000000 },
+	{ "blanchedalmond", 0xFFEBCD },
+	{ "blue", 0x0000FF },
+	{ "blueviolet", 0x8A2BE2 },
+	{ "brown", 0xA52A2A },
+	{ "burlywood", 0xDEB887 },
+	{ "cadetblue", 0x5F9EA0 },
+	{ "chartreuse", 0x7FFF00 },
+	{ "chocolate", 0xD2691E },
+	{ "coral", 0xFF7F50 },
+	{ "cornflowerblue", 0x6495ED },
+	{ "cornsilk", 0xFFF8DC },
+	{ "crimson", 0xDC143C },
+	{ "cyan", 0x00FFFF },
+	{ "darkblue", 0x00008B },
+	{ "darkcyan", 0x008B8B },
+	{ "darkgoldenrod", 0xB8860B },
+	{ "darkgray", 0xA9A9A9 },
+	{ "darkgreen", 0x006400 },
+	{ "darkgrey", 0xA9A9A9 },
+	{ "darkkhaki", 0xBDB76B },
+	{ "darkmagenta", 0x8B008B },
+	{ "darkolivegreen", 0x556B2F },
+	{ "darkorange", 0xFF8C00 },
+	{ "darkorchid", 0x9932CC },
+	{ "darkred", 0x8B0000 },
+	{ "darksalmon", 0xE9967A },
+	{ "darkseagreen", 0x8FBC8F },
+	{ "darkslateblue", 0x483D8B },
+	{ "darkslategray", 0x2F4F4F },
+	{ "darkslategrey", 0x2F4F4F },
+	{ "darkturquoise", 0x00CED1 },
+	{ "darkviolet", 0x9400D3 },
+	{ "deeppink", 0xFF1493 },
+	{ "deepskyblue", 0x00BFFF },
+	{ "dimgray", 0x696969 },
+	{ "dimgrey", 0x696969 },
+	{ "dodgerblue", 0x1E90FF },
+	{ "firebrick", 0xB22222 },
+	{ "floralwhite", 0xFFFAF0 },
+	{ "forestgreen", 0x228B22 },
+	{ "fuchsia", 0xFF00FF },
+	{ "gainsboro", 0xDCDCDC },
+	{ "ghostwhite", 0xF8F8FF },
+	{ "gold", 0xFFD700 },
+	{ "goldenrod", 0xDAA520 },
+	{ "gray", 0x808080 },
+	{ "green", 0x008000 },
+	{ "greenyellow", 0xADFF2F },
+	{ "grey", 0x808080 },
+	{ "honeydew", 0xF0FFF0 },
+	{ "hotpink", 0xFF69B4 },
+	{ "indianred", 0xCD5C5C },
+	{ "indigo", 0x4B0082 },
+	{ "ivory", 0xFFFFF0 },
+	{ "khaki", 0xF0E68C },
+	{ "lavender", 0xE6E6FA },
+	{ "lavenderblush", 0xFFF0F5 },
+	{ "lawngreen", 0x7CFC00 },
+	{ "lemonchiffon", 0xFFFACD },
+	{ "lightblue", 0xADD8E6 },
+	{ "lightcoral", 0xF08080 },
+	{ "lightcyan", 0xE0FFFF },
+	{ "lightgoldenrodyellow", 0xFAFAD2 },
+	{ "lightgray", 0xD3D3D3 },
+	{ "lightgreen", 0x90EE90 },
+	{ "lightgrey", 0xD3D3D3 },
+	{ "lightpink", 0xFFB6C1 },
+	{ "lightsalmon", 0xFFA07A },
+	{ "lightseagreen", 0x20B2AA },
+	{ "lightskyblue", 0x87CEFA },
+	{ "lightslategray", 0x778899 },
+	{ "lightslategrey", 0x778899 },
+	{ "lightsteelblue", 0xB0C4DE },
+	{ "lightyellow", 0xFFFFE0 },
+	{ "lime", 0x00FF00 },
+	{ "limegreen", 0x32CD32 },
+	{ "linen", 0xFAF0E6 },
+	{ "magenta", 0xFF00FF },
+	{ "maroon", 0x800000 },
+	{ "mediumaquamarine", 0x66CDAA },
+	{ "mediumblue", 0x0000CD },
+	{ "mediumorchid", 0xBA55D3 },
+	{ "mediumpurple", 0x9370DB },
+	{ "mediumseagreen", 0x3CB371 },
+	{ "mediumslateblue", 0x7B68EE },
+	{ "mediumspringgreen", 0x00FA9A },
+	{ "mediumturquoise", 0x48D1CC },
+	{ "mediumvioletred", 0xC71585 },
+	{ "midnightblue", 0x191970 },
+	{ "mintcream", 0xF5FFFA },
+	{ "mistyrose", 0xFFE4E1 },
+	{ "moccasin", 0xFFE4B5 },
+	{ "navajowhite", 0xFFDEAD },
+	{ "navy", 0x000080 },
+	{ "oldlace", 0xFDF5E6 },
+	{ "olive", 0x808000 },
+	{ "olivedrab", 0x6B8E23 },
+	{ "orange", 0xFFA500 },
+	{ "orangered", 0xFF4500 },
+	{ "orchid", 0xDA70D6 },
+	{ "palegoldenrod", 0xEEE8AA },
+	{ "palegreen", 0x98FB98 },
+	{ "paleturquoise", 0xAFEEEE },
+	{ "palevioletred", 0xDB7093 },
+	{ "papayawhip", 0xFFEFD5 },
+	{ "peachpuff", 0xFFDAB9 },
+	{ "peru", 0xCD853F },
+	{ "pink", 0xFFC0CB },
+	{ "plum", 0xDDA0DD },
+	{ "powderblue", 0xB0E0E6 },
+	{ "purple", 0x800080 },
+	{ "rebeccapurple", 0x663399 },
+	{ "red", 0xFF0000 },
+	{ "rosybrown", 0xBC8F8F },
+	{ "royalblue", 0x4169E1 },
+	{ "saddlebrown", 0x8B4513 },
+	{ "salmon", 0xFA8072 },
+	{ "sandybrown", 0xF4A460 },
+	{ "seagreen", 0x2E8B57 },
+	{ "seashell", 0xFFF5EE },
+	{ "sienna", 0xA0522D },
+	{ "silver", 0xC0C0C0 },
+	{ "skyblue", 0x87CEEB },
+	{ "slateblue", 0x6A5ACD },
+	{ "slategray", 0x708090 },
+	{ "slategrey", 0x708090 },
+	{ "snow", 0xFFFAFA },
+	{ "springgreen", 0x00FF7F },
+	{ "steelblue", 0x4682B4 },
+	{ "tan", 0xD2B48C },
+	{ "teal", 0x008080 },
+	{ "thistle", 0xD8BFD8 },
+	{ "tomato", 0xFF6347 },
+	{ "turquoise", 0x40E0D0 },
+	{ "violet", 0xEE82EE },
+	{ "wheat", 0xF5DEB3 },
+	{ "white", 0xFFFFFF },
+	{ "whitesmoke", 0xF5F5F5 },
+	{ "yellow", 0xFFFF00 },
+	{ "yellowgreen", 0x9ACD32 },
+};
+
+static constexpr size_t named_color_count = sizeof(named_colors) / sizeof(named_colors[0]);
+
+static_assert(named_color_count == 148, "CSS defines 148 named colors");
+
+static constexpr char to_lower(char ch) {
+	return ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch - 'A' + 'a') : ch;
+}
+
+//The perfect hash is FNV-1a of the lower case name with a seed. The seed is chosen
+//so that no two named colors share a slot. The table is built at compile time and
+//the build fails if a collision is introduced.
+static constexpr uint32_t color_hash_seed = 108;
+static constexpr size_t color_table_size = 2048;
+
+static constexpr uint32_t color_name_hash(std::string_view name) {
+	uint32_t h = 2166136261u ^ color_hash_seed;
+
+	for (char ch : name) {
+		h ^= static_cast<unsigned char>(to_lower(ch));
+		h *= 16777619u;
+	}
+
+	return h;
+}
+
+struct NamedColorTable {
+	//Index of the named color plus one in each slot. 0 means the slot is empty.
+	std::array<uint8_t, color_table_size> slots{};
+	bool has_collision = false;
+};
+
+static constexpr NamedColorTable build_named_color_table() {
+	NamedColorTable table{};
+
+	for (size_t i = 0; i < named_color_count; ++i) {
+		size_t slot = color_name_hash(named_colors[i].name) & (color_table_size - 1);
+
+		if (table.slots[slot] != 0) {
+			table.has_collision = true;
+		}
+
+		table.slots[slot] = static_cast<uint8_t>(i + 1);
+	}
+
+	return table;
+}
+
+static constexpr NamedColorTable named_color_table = build_named_color_table();
+
+static_assert(!named_color_table.has_collision, "Named colors collide in the perfect hash. Pick another color_hash_seed.");
+
+static bool equals_ignore_case(std::string_view a, std::string_view lower_case) {
+	if (a.length() != lower_case.length()) {
+		return false;
+	}
+
+	for (size_t i = 0; i < a.length(); ++i) {
+		if (to_lower(a[i]) != lower_case[i]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool find_named_color(std::string_view name, uint32_t& rgb) {
+	uint8_t index = named_color_table.slots[color_name_hash(name) & (color_table_size - 1)];
+
+	if (index != 0 && equals_ignore_case(name, named_colors[index - 1].name)) {
+		rgb = named_colors[index - 1].rgb;
+
+		return true;
+	}
+
+	return false;
+}
+
+static int hex_digit_value(char ch) {
+	if (ch >= '0' && ch <= '9') {
+		return ch - '0';
+	}
+	if (ch >= 'a' && ch <= 'f') {
+		return ch - 'a' + 10;
+	}
+	if (ch >= 'A' && ch <= 'F') {
+		return ch - 'A' + 10;
+	}
+
+	return -1;
+}
+
+//Parses the digits of #RGB, #RGBA, #RRGGBB or #RRGGBBAA after the #
+static bool parse_hex_color(std::string_view digits, float& r, float& g, float& b, float& a) {
+	int values[8];
+
+	if (digits.length() != 3 && digits.length() != 4 && digits.length() != 6 && digits.length() != 8) {
+		return false;
+	}
+
+	for (size_t i = 0; i < digits.length(); ++i) {
+		values[i] = hex_digit_value(digits[i]);
+
+		if (values[i] < 0) {
+			return false;
+		}
+	}
+
+	float channels[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+	if (digits.length() <= 4) {
+		//Each digit is repeated, so #f00 is #ff0000
+		for (size_t i = 0; i < digits.length(); ++i) {
+			channels[i] = values[i] / 15.0f;
+		}
+	}
+	else {
+		for (size_t i = 0; i < digits.length() / 2; ++i) {
+			channels[i] = (values[2 * i] * 16 + values[2 * i + 1]) / 255.0f;
+		}
+	}
+
+	r = channels[0];
+	g = channels[1];
+	b = channels[2];
+	a = channels[3];
+
+	return true;
+}
+
+//A number inside rgb() or hsl()
+struct ColorArgument {
+	float value = 0.0f;
+	bool is_percent = false;
+};
+
+//Reads an angle unit after a hue and converts value to degrees
+static bool scan_angle_unit(const char*& p, const char* end, float& value) {
+	const char* unit = p;
+
+	while (p < end && ((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z'))) {
+		++p;
+	}
+
+	std::string_view name(unit, p - unit);
+
+	if (name.empty() || equals_ignore_case(name, "deg")) {
+		return true;
+	}
+	if (equals_ignore_case(name, "rad")) {
+		value = value * 180.0f / 3.14159265f;
+
+		return true;
+	}
+	if (equals_ignore_case(name, "grad")) {
+		value = value * 0.9f;
+
+		return true;
+	}
+	if (equals_ignore_case(name, "turn")) {
+		value = value * 360.0f;
+
+		return true;
+	}
+
+	return false;
+}
+
+//Reads the 3 or 4 arguments of rgb() or hsl(). Arguments may be separated by commas
+//or spaces. The alpha may also be separated by a "/".
+static bool scan_color_arguments(std::string_view source, bool first_is_hue, ColorArgument args[4], int& count) {
+	const char* p = source.data();
+	const char* end = p + source.length();
+
+	count = 0;
+
+	while (true) {
+		p = skip_spaces(p, end);
+
+		if (p == end) {
+			break;
+		}
+
+		if (count > 0) {
+			if (*p == ',' || (*p == '/' && count == 3)) {
+				p = skip_spaces(p + 1, end);
+			}
+		}
+
+		if (count == 4 || !scan_number(p, end, args[count].value)) {
+			return false;
+		}
+
+		if (p < end && *p == '%') {
+			args[count].is_percent = true;
+			++p;
+		}
+		else if (count == 0 && first_is_hue) {
+			if (!scan_angle_unit(p, end, args[count].value)) {
+				return false;
+			}
+		}
+
+		++count;
+	}
+
+	return count == 3 || count == 4;
+}
+
+static float clamp_unit(float value) {
+	return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+}
+
+//Converts an alpha argument to the 0 to 1 range
+static float alpha_value(const ColorArgument& arg) {
+	return clamp_unit(arg.is_percent ? arg.value / 100.0f : arg.value);
+}
+
+static float hue_to_rgb(float m1, float m2, float h) {
+	if (h < 0.0f) {
+		h += 1.0f;
+	}
+	if (h > 1.0f) {
+		h -= 1.0f;
+	}
+	if (h * 6.0f < 1.0f) {
+		return m1 + (m2 - m1) * h * 6.0f;
+	}
+	if (h * 2.0f < 1.0f) {
+		return m2;
+	}
+	if (h * 3.0f < 2.0f) {
+		return m1 + (m2 - m1) * (2.0f / 3.0f - h) * 6.0f;
+	}
+
+	return m1;
+}
+
+static bool parse_color_function(std::string_view source, float& r, float& g, float& b, float& a) {
+	size_t open = source.find('(');
+
+	if (open == std::string_view::npos || source.back() != ')') {
+		return false;
+	}
+
+	std::string_view name = source.substr(0, open);
+	std::string_view arguments = source.substr(open + 1, source.length() - open - 2);
+	bool is_rgb = equals_ignore_case(name, "rgb") || equals_ignore_case(name, "rgba");
+	bool is_hsl = equals_ignore_case(name, "hsl") || equals_ignore_case(name, "hsla");
+
+	if (!is_rgb && !is_hsl) {
+		return false;
+	}
+
+	ColorArgument args[4];
+	int count = 0;
+
+	if (!scan_color_arguments(arguments, is_hsl, args, count)) {
+		return false;
+	}
+
+	a = count == 4 ? alpha_value(args[3]) : 1.0f;
+
+	if (is_rgb) {
+		float* channels[3] = { &r, &g, &b };
+
+		for (int i = 0; i < 3; ++i) {
+			*channels[i] = clamp_unit(args[i].is_percent ? args[i].value / 100.0f : args[i].value / 255.0f);
+		}
+
+		return true;
+	}
+
+	//Saturation and lightness are percentages. Plain numbers are read the same way.
+	float h = std::fmod(args[0].value, 360.0f);
+
+	if (h < 0.0f) {
+		h += 360.0f;
+	}
+
+	h /= 360.0f;
+
+	float s = clamp_unit(args[1].value / 100.0f);
+	float l = clamp_unit(args[2].value / 100.0f);
+	float m2 = l <= 0.5f ? l * (s + 1.0f) : l + s - l * s;
+	float m1 = l * 2.0f - m2;
+
+	r = hue_to_rgb(m1, m2, h + 1.0f / 3.0f);
+	g = hue_to_rgb(m1, m2, h);
+	b = hue_to_rgb(m1, m2, h - 1.0f / 3.0f);
+
+	return true;
+}
+
+bool get_css_color(std::string_view source, float& r, float& g, float& b, float& a) {
+	//Trim white space
+	const char* p = skip_spaces(source.data(), source.data() + source.length());
+	const char* end = source.data() + source.length();
+
+	while (end > p && is_svg_space(end[-1])) {
+		--end;
+	}
+
+	source = std::string_view(p, end - p);
+
+	if (source.empty()) {
+		return false;
+	}
+
+	if (source[0] == '#') {
+		return parse_hex_color(source.substr(1), r, g, b, a);
+	}
+
+	if (source.back() == ')') {
+		return parse_color_function(source, r, g, b, a);
+	}
+
+	uint32_t rgb;
+
+	if (find_named_color(source, rgb)) {
+		r = ((rgb >> 16) & 0xFF) / 255.0f;
+		g = ((rgb >> 8) & 0xFF) / 255.0f;
+		b = (rgb & 0xFF) / 255.0f;
+		a = 1.0f;
+
+		return true;
+	}
+
+	if (equals_ignore_case(source, "transparent")) {
+		r = g = b = a = 0.0f;
+
+		return true;
+	}
+
+	return false;
+}
+
+//Upper limit of cached strings. Guards against documents made of millions of distinct colors.
+static const size_t max_cached_colors = 4096;
+
+static uint32_t color_source_hash(std::string_view source) {
+	uint32_t h = 2166136261u;
+
+	for (char ch : source) {
+		h ^= static_cast<unsigned char>(ch);
+		h *= 16777619u;
+	}
+
+	return h;
+}
+
+void ColorCache::clear() {
+	slots.clear();
+	count = 0;
+}
+
+void ColorCache::grow() {
+	std::vector<Entry> old_slots;
+
+	old_slots.swap(slots);
+	slots.resize(old_slots.empty() ? 64 : old_slots.size() * 2);
+
+	for (auto& entry : old_slots) {
+		if (!entry.used) {
+			continue;
+		}
+
+		size_t mask = slots.size() - 1;
+		size_t i = entry.hash & mask;
+
+		while (slots[i].used) {
+			i = (i + 1) & mask;
+		}
+
+		slots[i] = std::move(entry);
+	}
+}
+
+bool ColorCache::get_css_color(std::string_view source, float& r, float& g, float& b, float& a) {
+	uint32_t hash = color_source_hash(source);
+
+	if (!slots.empty()) {
+		size_t mask = slots.size() - 1;
+
+		for (size_t i = hash & mask; slots[i].used; i = (i + 1) & mask) {
+			const Entry& entry = slots[i];
+
+			if (entry.hash == hash && entry.source == source) {
+				if (entry.is_color) {
+					r = entry.r;
+					g = entry.g;
+					b = entry.b;
+					a = entry.a;
+				}
+
+				return entry.is_color;
+			}
+		}
+	}
+
+	Entry entry;
+
+	entry.is_color = ::get_css_color(source, entry.r, entry.g, entry.b, entry.a);
+
+	if (entry.is_color) {
+		r = entry.r;
+		g = entry.g;
+		b = entry.b;
+		a = entry.a;
+	}
+
+	if (count >= max_cached_colors) {
+		return entry.is_color;
+	}
+
+	//Keep the table at most half full
+	if ((count + 1) * 2 > slots.size()) {
+		grow();
+	}
+
+	size_t mask = slots.size() - 1;
+	size_t i = hash & mask;
+
+	while (slots[i].used) {
+		i = (i + 1) & mask;
+	}
+
+	entry.source = source;
+	entry.hash = hash;
+	entry.used = true;
+	slots[i] = std::move(entry);
+	++count;
+
+	return slots[i].is_color;
+}
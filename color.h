@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//Parses a CSS color value. Supported forms are #rgb, #rgba, #rrggbb, #rrggbbaa,
+//rgb(), rgba(), hsl(), hsla(), "transparent" and the 148 CSS named colors.
+//Functions accept both the comma separated form and the space separated form
+//with an optional "/ alpha". Components of rgb() can mix numbers and percentages.
+//Names and functions are case insensitive. Components are returned in the 0 to 1 range.
+//Returns false if source is not a supported color. Does not allocate or throw.
+bool get_css_color(std::string_view source, float& r, float& g, float& b, float& a);
+
+//Looks up a CSS named color, ignoring case. On success rgb is set to 0xRRGGBB.
+bool find_named_color(std::string_view name, uint32_t& rgb);
+
+//Remembers the colors already parsed in a document. Documents tend to repeat
+//the same few color values many times, so each distinct string is parsed once.
+//Values that are not colors, like url(#gradient), are remembered as well.
+class ColorCache {
+public:
+	//Same as get_css_color().
+	bool get_css_color(std::string_view source, float& r, float& g, float& b, float& a);
+
+	void clear();
+
+private:
+	struct Entry {
+		std::string source;
+		uint32_t hash = 0;
+		bool used = false;
+		bool is_color = false;
+		float r = 0.0f, g = 0.0f, b = 0.0f, a = 0.0f;
+	};
+
+	//Open addressing hash table. The size is always a power of two.
+	std::vector<Entry> slots;
+	size_t count = 0;
+
+	void grow();
+};
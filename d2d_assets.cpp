@@ -0,0 +1,357 @@
+#include "svglib.h"
+#include "elements.h"
+#include "utils.h"
+#include "d2d_assets.h"
+
+static CComPtr<ID2D1GradientStopCollection> create_gradient_stop_collection(const SVGDevice& device, const std::vector<SVGGradientStop>& gradient_stops) {
+	std::vector<D2D1_GRADIENT_STOP> stops;
+
+	for (const auto& stop : gradient_stops) {
+		stops.push_back(D2D1::GradientStop(stop.offset, D2D1::ColorF(stop.color.r, stop.color.g, stop.color.b, stop.color.a)));
+	}
+
+	CComPtr<ID2D1GradientStopCollection> gradient_stop_collection;
+	HRESULT hr = device.device_context->CreateGradientStopCollection(
+		stops.data(),
+		static_cast<UINT32>(stops.size()),
+		D2D1_GAMMA_2_2,
+		D2D1_EXTEND_MODE_CLAMP,
+		&gradient_stop_collection
+	);
+
+	if (!SUCCEEDED(hr)) {
+		return nullptr;
+	}
+
+	return gradient_stop_collection;
+}
+
+static D2D1_MATRIX_3X2_F to_d2d_matrix(const Matrix& m) {
+	return D2D1::Matrix3x2F(m.a, m.b, m.c, m.d, m.e, m.f);
+}
+
+CComPtr<ID2D1LinearGradientBrush> create_linear_gradient_brush(const SVGDevice& device, const std::map<std::string_view, SVGGraphicsElement*>& id_map, const LengthContext& lengths, const SVGLinearGradientElement& linear_gradient, const SVGGraphicsElement& element) {
+	SVGGradientPaint paint;
+
+	if (!resolve_linear_gradient(id_map, lengths, linear_gradient, element, paint)) {
+		return nullptr;
+	}
+
+	CComPtr<ID2D1GradientStopCollection> gradient_stop_collection = create_gradient_stop_collection(device, paint.stops);
+
+	if (!gradient_stop_collection) {
+		return nullptr;
+	}
+
+	CComPtr<ID2D1LinearGradientBrush> linear_gradient_brush;
+
+	HRESULT hr = device.device_context->CreateLinearGradientBrush(
+		D2D1::LinearGradientBrushProperties(D2D1::Point2F(paint.x1, paint.y1), D2D1::Point2F(paint.x2, paint.y2)),
+		gradient_stop_collection,
+		&linear_gradient_brush
+	);
+
+	if (!SUCCEEDED(hr)) {
+		return nullptr;
+	}
+
+	linear_gradient_brush->SetTransform(to_d2d_matrix(paint.transform));
+
+	return linear_gradient_brush;
+}
+
+CComPtr<ID2D1RadialGradientBrush> create_radial_gradient_brush(const SVGDevice& device, const std::map<std::string_view, SVGGraphicsElement*>& id_map, const LengthContext& lengths, const SVGRadialGradientElement& radial_gradient, const SVGGraphicsElement& element) {
+	SVGGradientPaint paint;
+
+	if (!resolve_radial_gradient(id_map, lengths, radial_gradient, element, paint)) {
+		return nullptr;
+	}
+
+	CComPtr<ID2D1GradientStopCollection> gradient_stop_collection = create_gradient_stop_collection(device, paint.stops);
+
+	if (!gradient_stop_collection) {
+		return nullptr;
+	}
+
+	CComPtr<ID2D1RadialGradientBrush> radial_gradient_brush;
+
+	//Note: Offset origin is the delta from the center and not the actual position of the focal point.
+	HRESULT hr = device.device_context->CreateRadialGradientBrush(
+		D2D1::RadialGradientBrushProperties(D2D1::Point2F(paint.cx, paint.cy), D2D1::Point2F(paint.focal_dx, paint.focal_dy), paint.rx, paint.ry),
+		gradient_stop_collection,
+		&radial_gradient_brush
+	);
+
+	if (!SUCCEEDED(hr)) {
+		return nullptr;
+	}
+
+	radial_gradient_brush->SetTransform(to_d2d_matrix(paint.transform));
+
+	return radial_gradient_brush;
+}
+
+void create_element_assets(const SVGGraphicsElement& element, const ComputedStyle& style, const std::map<std::string_view, SVGGraphicsElement*>& id_map, const LengthContext& lengths, const SVGDevice& device, SVGElementAssets& assets) {
+	visit_element(element, [&](const auto& e) { e.create_presentation_assets(style, id_map, lengths, device, assets); });
+}
+
+//Creates a brush for a fill or stroke paint. Returns null for none.
+static CComPtr<ID2D1Brush> create_paint_brush(const Paint& paint, float opacity, const std::map<std::string_view, SVGGraphicsElement*>& id_map, const LengthContext& lengths, const SVGDevice& device, const SVGGraphicsElement& element) {
+	if (paint.type == PaintType::Color) {
+		CComPtr<ID2D1SolidColorBrush> brush;
+
+		HRESULT hr = device.device_context->CreateSolidColorBrush(
+			D2D1::ColorF(paint.color.r, paint.color.g, paint.color.b, paint.color.a * opacity),
+			&brush
+		);
+
+		if (SUCCEEDED(hr)) {
+			return brush;
+		}
+	}
+#ifndef SVGLIB_NO_GRADIENTS
+	else if (paint.type == PaintType::Url) {
+		auto it = id_map.find(paint.url_id);
+
+		if (it != id_map.end()) {
+			const SVGGraphicsElement* paint_server = it->second;
+
+			if (paint_server->kind == ElementKind::LinearGradient) {
+				return create_linear_gradient_brush(device, id_map, lengths, *static_cast<const SVGLinearGradientElement*>(paint_server), element);
+			}
+			else if (paint_server->kind == ElementKind::RadialGradient) {
+				return create_radial_gradient_brush(device, id_map, lengths, *static_cast<const SVGRadialGradientElement*>(paint_server), element);
+			}
+		}
+	}
+#endif
+
+	return nullptr;
+}
+
+void SVGGraphicsElement::create_presentation_assets(const ComputedStyle& style, const std::map<std::string_view, SVGGraphicsElement*>& id_map, const LengthContext& lengths, const SVGDevice& device, SVGElementAssets& assets) const {
+	//Set brushes
+	assets.stroke_brush = create_paint_brush(style.stroke, style.stroke_opacity, id_map, lengths, device, *this);
+
+	if (style.stroke.type != PaintType::None) {
+		D2D1_CAP_STYLE cap_style = D2D1_CAP_STYLE_FLAT;
+
+		if (style.stroke_linecap == LineCap::Round) {
+			cap_style = D2D1_CAP_STYLE_ROUND;
+		}
+		else if (style.stroke_linecap == LineCap::Square) {
+			cap_style = D2D1_CAP_STYLE_SQUARE;
+		}
+
+		D2D1_LINE_JOIN line_join = D2D1_LINE_JOIN_MITER;
+
+		if (style.stroke_linejoin == LineJoin::Bevel) {
+			line_join = D2D1_LINE_JOIN_BEVEL;
+		}
+		else if (style.stroke_linejoin == LineJoin::Round) {
+			line_join = D2D1_LINE_JOIN_ROUND;
+		}
+
+		D2D1_STROKE_STYLE_PROPERTIES stroke_properties = D2D1::StrokeStyleProperties(
+			cap_style,     // Start cap
+			cap_style,     // End cap
+			D2D1_CAP_STYLE_ROUND,    // Dash cap
+			line_join,    // Line join
+			style.stroke_miterlimit//,                   // Miter limit
+			//D2D1_DASH_STYLE_CUSTOM,  // Dash style
+			//0.0f                     // Dash offset
+		);
+
+		CComPtr<ID2D1StrokeStyle> ss;
+
+		HRESULT hr = device.d2d_factory->CreateStrokeStyle(
+			&stroke_properties,
+			nullptr,
+			0,
+			&ss
+		);
+
+		if (SUCCEEDED(hr)) {
+			assets.stroke_style = ss;
+		}
+	}
+
+	assets.fill_brush = create_paint_brush(style.fill, style.get_fill_opacity(), id_map, lengths, device, *this);
+}
+
+static CComPtr<IDWriteTextFormat> build_text_format(IDWriteFactory* dwrite_factory, std::string_view family, int weight, FontStyle style, float size) {
+	CComPtr<IDWriteTextFormat> tfmt;
+	//Split the family string by commas and try to find the first installed font
+	auto families = split_string(family, ",");
+	DWRITE_FONT_WEIGHT fontWeight = static_cast<DWRITE_FONT_WEIGHT>(weight);
+	DWRITE_FONT_STYLE fontStyle = DWRITE_FONT_STYLE_NORMAL;
+
+	if (style == FontStyle::Italic) {
+		fontStyle = DWRITE_FONT_STYLE_ITALIC;
+	}
+	else if (style == FontStyle::Oblique) {
+		fontStyle = DWRITE_FONT_STYLE_OBLIQUE;
+	}
+
+	for (auto& fam : families) {
+		ltrim_str(fam);
+
+		std::pmr::wstring trimmedFamily;
+
+		utf8_to_wide(fam, trimmedFamily);
+
+		HRESULT hr = dwrite_factory->CreateTextFormat(
+			trimmedFamily.c_str(),
+			nullptr,
+			fontWeight,
+			fontStyle,
+			DWRITE_FONT_STRETCH_NORMAL,
+			size,
+			L"",
+			&tfmt);
+
+		if (SUCCEEDED(hr)) {
+			return tfmt;
+		}
+	}
+
+	return nullptr;
+}
+
+void SVGTextElement::create_presentation_assets(const ComputedStyle& style, const std::map<std::string_view, SVGGraphicsElement*>& id_map, const LengthContext& lengths, const SVGDevice& device, SVGElementAssets& assets) const {
+	SVGGraphicsElement::create_presentation_assets(style, id_map, lengths, device, assets);
+
+	CComPtr<IDWriteTextFormat> text_format = build_text_format(
+		device.dwrite_factory,
+		style.font_family,
+		style.font_weight,
+		style.font_style,
+		style.font_size
+	);
+
+	if (!text_format) {
+		return;
+	}
+
+	CComPtr<IDWriteTextLayout> text_layout;
+
+	HRESULT hr = device.dwrite_factory->CreateTextLayout(
+		text_content.c_str(),           // The string to be laid out
+		text_content.size(),     // The length of the string
+		text_format,    // The initial format (font, size, etc.)
+		device.device_context->GetSize().width,       // Maximum width of the layout box
+		device.device_context->GetSize().height,      // Maximum height of the layout box
+		&text_layout    // Output: the resulting IDWriteTextLayout
+	);
+
+	if (!SUCCEEDED(hr)) {
+		return;
+	}
+
+	assets.text_layout = text_layout;
+
+	// To prevent wrapping and force it to stay on one line:
+	text_layout->SetWordWrapping(DWRITE_WORD_WRAPPING_NO_WRAP);
+
+	//Get the font baseline
+	UINT32 lineCount = 0;
+
+	//First get the line count
+	hr = text_layout->GetLineMetrics(nullptr, 0, &lineCount);
+
+	if (!SUCCEEDED(hr) && hr != HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER)) {
+		return;
+	}
+
+	if (lineCount == 0) {
+		//Nothing there
+		return;
+	}
+
+	//Allocate memory for metrics
+	std::vector<DWRITE_LINE_METRICS> lineMetrics(lineCount);
+
+	hr = text_layout->GetLineMetrics(lineMetrics.data(), lineMetrics.size(), &lineCount);
+
+	if (!SUCCEEDED(hr)) {
+		return;
+	}
+
+	assets.baseline = lineMetrics[0].baseline;
+}
+
+CComPtr<ID2D1PathGeometry> build_path_geometry(ID2D1Factory* d2d_factory, const PathData& path_data, FillRule fill_rule) {
+	CComPtr<ID2D1PathGeometry> path_geometry;
+
+	HRESULT hr = d2d_factory->CreatePathGeometry(&path_geometry);
+
+	if (!SUCCEEDED(hr)) {
+		return nullptr;
+	}
+
+	CComPtr<ID2D1GeometrySink> pSink;
+
+	hr = path_geometry->Open(&pSink);
+
+	if (!SUCCEEDED(hr)) {
+		return nullptr;
+	}
+
+	pSink->SetFillMode(fill_rule == FillRule::EvenOdd ? D2D1_FILL_MODE_ALTERNATE : D2D1_FILL_MODE_WINDING);
+
+	const float* c = path_data.coords.data();
+	bool is_in_figure = false;
+
+	for (PathVerb verb : path_data.verbs) {
+		switch (verb) {
+		case PathVerb::MoveTo:
+			//If we are already in a figure, end it first
+			if (is_in_figure) {
+				pSink->EndFigure(D2D1_FIGURE_END_OPEN);
+			}
+
+			pSink->BeginFigure(D2D1::Point2F(c[0], c[1]), D2D1_FIGURE_BEGIN_FILLED);
+			is_in_figure = true;
+
+			break;
+		case PathVerb::LineTo:
+			pSink->AddLine(D2D1::Point2F(c[0], c[1]));
+
+			break;
+		case PathVerb::QuadTo:
+			pSink->AddQuadraticBezier(D2D1::QuadraticBezierSegment(D2D1::Point2F(c[0], c[1]), D2D1::Point2F(c[2], c[3])));
+
+			break;
+		case PathVerb::CubicTo:
+			pSink->AddBezier(D2D1::BezierSegment(D2D1::Point2F(c[0], c[1]), D2D1::Point2F(c[2], c[3]), D2D1::Point2F(c[4], c[5])));
+
+			break;
+		case PathVerb::ArcTo:
+			pSink->AddArc(D2D1::ArcSegment(
+				D2D1::Point2F(c[5], c[6]),
+				D2D1::SizeF(c[0], c[1]),
+				c[2],
+				c[4] != 0.0f ? D2D1_SWEEP_DIRECTION_CLOCKWISE : D2D1_SWEEP_DIRECTION_COUNTER_CLOCKWISE,
+				c[3] != 0.0f ? D2D1_ARC_SIZE_LARGE : D2D1_ARC_SIZE_SMALL
+			));
+
+			break;
+		case PathVerb::Close:
+			pSink->EndFigure(D2D1_FIGURE_END_CLOSED);
+			is_in_figure = false;
+
+			break;
+		}
+
+		c += path_verb_size(verb);
+	}
+
+	//End of path
+	if (is_in_figure) {
+		pSink->EndFigure(D2D1_FIGURE_END_OPEN);
+	}
+
+	pSink->Close();
+
+	return path_geometry;
+}
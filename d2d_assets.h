@@ -0,0 +1,14 @@
+#pragma once
+
+//Direct2D resources of the elements of a document, created when it is bound to a device.
+//The elements themselves, like the device-free part of a gradient in gradient.h, don't
+//depend on Direct2D. Include svglib.h first.
+
+struct SVGLinearGradientElement;
+struct SVGRadialGradientElement;
+
+CComPtr<ID2D1LinearGradientBrush> create_linear_gradient_brush(const SVGDevice& device, const std::map<std::string_view, SVGGraphicsElement*>& id_map, const LengthContext& lengths, const SVGLinearGradientElement& linear_gradient, const SVGGraphicsElement& element);
+CComPtr<ID2D1RadialGradientBrush> create_radial_gradient_brush(const SVGDevice& device, const std::map<std::string_view, SVGGraphicsElement*>& id_map, const LengthContext& lengths, const SVGRadialGradientElement& radial_gradient, const SVGGraphicsElement& element);
+
+//Creates the Direct2D geometry of path data, filled with fill_rule. Returns null on failure.
+CComPtr<ID2D1PathGeometry> build_path_geometry(ID2D1Factory* d2d_factory, const PathData& path_data, FillRule fill_rule);
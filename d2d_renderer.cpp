@@ -0,0 +1,146 @@
+#include "svglib.h"
+#include "path.h"
+#include "text.h"
+#include "d2d_assets.h"
+#include "d2d_renderer.h"
+
+static D2D1_MATRIX_3X2_F to_d2d_matrix(const Matrix& m) {
+	return D2D1::Matrix3x2F(m.a, m.b, m.c, m.d, m.e, m.f);
+}
+
+SVGDirect2DRenderer::SVGDirect2DRenderer(const SVGDevice& device, const std::vector<SVGElementAssets>& assets, const D2D1_MATRIX_3X2_F& base) :
+	device(device),
+	image_assets(assets) {
+	base_transforms.push_back(base);
+}
+
+const SVGElementAssets& SVGDirect2DRenderer::get_assets(const SVGPaint& paint) const {
+	static const SVGElementAssets no_assets;
+
+	return paint.geometry < image_assets.size() ? image_assets[paint.geometry] : no_assets;
+}
+
+void SVGDirect2DRenderer::push_transform(const Matrix& transform) {
+	base_transforms.push_back(to_d2d_matrix(transform) * base_transforms.back());
+}
+
+void SVGDirect2DRenderer::pop_transform() {
+	base_transforms.pop_back();
+}
+
+void SVGDirect2DRenderer::set_transform(const Matrix& transform) {
+	device.device_context->SetTransform(to_d2d_matrix(transform) * base_transforms.back());
+}
+
+void SVGDirect2DRenderer::fill_rect(float x, float y, float width, float height, float rx, float ry, const SVGPaint& paint) {
+	const SVGElementAssets& assets = get_assets(paint);
+
+	if (!assets.fill_brush) {
+		return;
+	}
+
+	D2D1_RECT_F rect = D2D1::RectF(x, y, x + width, y + height);
+
+	if (rx > 0.0f || ry > 0.0f) {
+		device.device_context->FillRoundedRectangle(D2D1::RoundedRect(rect, rx, ry), assets.fill_brush);
+	}
+	else {
+		device.device_context->FillRectangle(rect, assets.fill_brush);
+	}
+}
+
+void SVGDirect2DRenderer::stroke_rect(float x, float y, float width, float height, float rx, float ry, const SVGPaint& paint) {
+	const SVGElementAssets& assets = get_assets(paint);
+
+	if (!assets.stroke_brush) {
+		return;
+	}
+
+	D2D1_RECT_F rect = D2D1::RectF(x, y, x + width, y + height);
+
+	if (rx > 0.0f || ry > 0.0f) {
+		device.device_context->DrawRoundedRectangle(D2D1::RoundedRect(rect, rx, ry), assets.stroke_brush, paint.style.stroke_width, assets.stroke_style);
+	}
+	else {
+		device.device_context->DrawRectangle(rect, assets.stroke_brush, paint.style.stroke_width, assets.stroke_style);
+	}
+}
+
+void SVGDirect2DRenderer::fill_ellipse(float cx, float cy, float rx, float ry, const SVGPaint& paint) {
+	const SVGElementAssets& assets = get_assets(paint);
+
+	if (assets.fill_brush) {
+		device.device_context->FillEllipse(D2D1::Ellipse(D2D1::Point2F(cx, cy), rx, ry), assets.fill_brush);
+	}
+}
+
+void SVGDirect2DRenderer::stroke_ellipse(float cx, float cy, float rx, float ry, const SVGPaint& paint) {
+	const SVGElementAssets& assets = get_assets(paint);
+
+	if (assets.stroke_brush) {
+		device.device_context->DrawEllipse(D2D1::Ellipse(D2D1::Point2F(cx, cy), rx, ry), assets.stroke_brush, paint.style.stroke_width);
+	}
+}
+
+void SVGDirect2DRenderer::stroke_line(float x1, float y1, float x2, float y2, const SVGPaint& paint) {
+	const SVGElementAssets& assets = get_assets(paint);
+
+	if (assets.stroke_brush) {
+		device.device_context->DrawLine(
+			D2D1::Point2F(x1, y1),
+			D2D1::Point2F(x2, y2),
+			assets.stroke_brush,
+			paint.style.stroke_width,
+			assets.stroke_style
+		);
+	}
+}
+
+ID2D1PathGeometry* SVGDirect2DRenderer::get_path_geometry(const SVGPathElement& path, const SVGPaint& paint, const SVGElementAssets& assets) {
+	if (!assets.path_geometry) {
+		assets.path_geometry = build_path_geometry(device.d2d_factory, path.path_data, paint.style.fill_rule);
+	}
+
+	return assets.path_geometry;
+}
+
+void SVGDirect2DRenderer::fill_path(const SVGPathElement& path, const SVGPaint& paint) {
+	const SVGElementAssets& assets = get_assets(paint);
+
+	if (!assets.fill_brush) {
+		return;
+	}
+
+	ID2D1PathGeometry* geometry = get_path_geometry(path, paint, assets);
+
+	if (geometry) {
+		device.device_context->FillGeometry(geometry, assets.fill_brush);
+	}
+}
+
+void SVGDirect2DRenderer::stroke_path(const SVGPathElement& path, const SVGPaint& paint) {
+	const SVGElementAssets& assets = get_assets(paint);
+
+	if (!assets.stroke_brush) {
+		return;
+	}
+
+	ID2D1PathGeometry* geometry = get_path_geometry(path, paint, assets);
+
+	if (geometry) {
+		device.device_context->DrawGeometry(geometry, assets.stroke_brush, paint.style.stroke_width, assets.stroke_style);
+	}
+}
+
+void SVGDirect2DRenderer::draw_text(const SVGTextElement& text, const SVGPaint& paint) {
+	const SVGElementAssets& assets = get_assets(paint);
+
+	if (assets.fill_brush && assets.text_layout) {
+		//SVG spec requires x and y to specify the position of the text baseline
+		D2D1_POINT_2F origin = D2D1::Point2F(
+			text.points[0],
+			text.points[1] - assets.baseline);
+
+		device.device_context->DrawTextLayout(origin, assets.text_layout, assets.fill_brush);
+	}
+}
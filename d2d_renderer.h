@@ -0,0 +1,35 @@
+#pragma once
+
+//Draws through the device context of an SVGDevice. This is the backend SVG::render()
+//uses for a device. Shapes are drawn with the brushes and stroke styles in the
+//assets of the image, found by the geometry of the paint, so the image must have
+//been bound to the device.
+class SVGDirect2DRenderer : public SVGRenderer {
+public:
+	//assets are the ones of the image. base is the transform of the image on the device.
+	SVGDirect2DRenderer(const SVGDevice& device, const std::vector<SVGElementAssets>& assets, const D2D1_MATRIX_3X2_F& base);
+
+	void push_transform(const Matrix& transform) override;
+	void pop_transform() override;
+	void set_transform(const Matrix& transform) override;
+	void fill_rect(float x, float y, float width, float height, float rx, float ry, const SVGPaint& paint) override;
+	void stroke_rect(float x, float y, float width, float height, float rx, float ry, const SVGPaint& paint) override;
+	void fill_ellipse(float cx, float cy, float rx, float ry, const SVGPaint& paint) override;
+	void stroke_ellipse(float cx, float cy, float rx, float ry, const SVGPaint& paint) override;
+	void stroke_line(float x1, float y1, float x2, float y2, const SVGPaint& paint) override;
+	void fill_path(const SVGPathElement& path, const SVGPaint& paint) override;
+	void stroke_path(const SVGPathElement& path, const SVGPaint& paint) override;
+	void draw_text(const SVGTextElement& text, const SVGPaint& paint) override;
+
+private:
+	const SVGDevice& device;
+	//Shorter than dom.geometries if the image was not bound to the device
+	const std::vector<SVGElementAssets>& image_assets;
+	//Transform of the image, followed by the one of each instance being drawn
+	std::vector<D2D1_MATRIX_3X2_F> base_transforms;
+
+	//Empty assets for a shape that has none
+	const SVGElementAssets& get_assets(const SVGPaint& paint) const;
+	//The geometry of a path is built on first use
+	ID2D1PathGeometry* get_path_geometry(const SVGPathElement& path, const SVGPaint& paint, const SVGElementAssets& assets);
+};
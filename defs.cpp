@@ -1,6 +0,0 @@
-#include "svglib.h"
-#include "defs.h"
-
-//Defs tree doesn't render
-void SVGDefsElement::render_tree(const SVGDevice& device) const {
-}
\ No newline at end of file
@@ -1,4 +1,6 @@
-#pragma once
-struct SVGDefsElement : public SVGGraphicsElement {
-	void render_tree(const SVGDevice& device) const override;
+#pragma once
+struct SVGDefsElement : public SVGGraphicsElement {
+	//Defs tree doesn't render. See walk_drawn_nodes().
+	using ArenaOwned = SVGDefsElement;
+	using SVGGraphicsElement::SVGGraphicsElement;
 };
\ No newline at end of file
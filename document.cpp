@@ -0,0 +1,910 @@
+#include <sstream>
+#include <string_view>
+#include <cstring>
+#include "document.h"
+#include "document_reader.h"
+#include "elements.h"
+#include "utils.h"
+#include "mapped_file.h"
+
+void SVGDocument::clear() {
+	root_element = nullptr;
+	dom.clear();
+	id_map.clear();
+	arena.clear();
+}
+
+void SVGImageBase::clear() {
+	display_list.clear();
+	document.reset();
+}
+
+SVGGraphicsElement::SVGGraphicsElement(Arena& arena)
+	: children(&arena),
+	points(&arena),
+	styles(arena),
+	attributes(arena) {
+
+}
+
+void render_element(const SVGGraphicsElement& element, ElementKind kind, SVGRenderer& renderer, const SVGPaint& paint) {
+	visit_element(element, kind, [&](const auto& e) { e.render(renderer, paint); });
+}
+
+void compute_element_bbox(SVGGraphicsElement& element) {
+	visit_element(element, [](auto& e) { e.compute_bbox(); });
+}
+
+bool element_to_path_data(const SVGGraphicsElement& element, PathData& path) {
+	return visit_element(element, [&](const auto& e) { return e.to_path_data(path); });
+}
+
+//A simple parser for inline CSS styles.
+//Only properties known to the library are kept. Others would never be looked up.
+void parse_css_style_string(std::string_view styleStr, AtomMap& styles) {
+	std::vector<std::string_view> declarations = split_string(styleStr, ";");
+
+	for (const auto& decl : declarations) {
+		size_t colonPos = decl.find(':');
+		if (colonPos != std::string_view::npos) {
+			std::string_view property = decl.substr(0, colonPos);
+			std::string_view value = decl.substr(colonPos + 1);
+			
+			ltrim_str(property);
+			rtrim_str(property);
+			ltrim_str(value);
+
+			Atom atom = find_atom(property);
+
+			if (atom != Atom::Unknown && !value.empty()) {
+				styles.set(atom, value);
+			}
+		}
+	}
+}
+
+//Presentation attributes that are read from XML tag attributes
+static bool is_presentation_attribute(Atom atom) {
+	switch (atom) {
+	case Atom::Fill:
+	case Atom::FillRule:
+	case Atom::FillOpacity:
+	case Atom::Opacity:
+	case Atom::StrokeOpacity:
+	case Atom::StrokeLinecap:
+	case Atom::StrokeLinejoin:
+	case Atom::StrokeMiterlimit:
+	case Atom::Stroke:
+	case Atom::StopColor:
+	case Atom::StopOpacity:
+	case Atom::StrokeWidth:
+	case Atom::FontFamily:
+	case Atom::FontSize:
+	case Atom::FontWeight:
+	case Atom::FontStyle:
+		return true;
+	default:
+		return false;
+	}
+}
+
+//Presentation attributes like fill and stroke are special. They could be inherited from the parents.
+//They may also be supplied as CSS styles in the style attribute. 
+//This function saves a handful of presentation attributes by collecting them from XML tag attributes as well
+//as from the CSS style.
+void save_presentation_attributes(const XmlTokenizer& xml_reader, SVGGraphicsElement* new_element) {
+	std::string_view style_str;
+
+	if (get_attribute(xml_reader, "style", style_str)) {
+		parse_css_style_string(style_str, new_element->styles);
+	}
+
+	//Attribute values override styles in the "style" attribute.
+	for (const auto& attr : xml_reader.attributes()) {
+		if (!attr.prefix.empty()) {
+			continue;
+		}
+
+		Atom atom = find_atom(attr.local_name);
+
+		if (is_presentation_attribute(atom)) {
+			new_element->styles.set(atom, attr.value);
+		}
+	}
+}
+
+//Save all attributes for later processing. Only attributes known to the library are kept.
+void save_all_attributes(const XmlTokenizer& xml_reader, SVGGraphicsElement* element) {
+	for (const auto& attr : xml_reader.attributes()) {
+		if (!attr.is_svg_attribute()) {
+			continue;
+		}
+
+		Atom atom = find_atom(attr.local_name);
+
+		//href wins over xlink:href, whichever comes first
+		if (atom != Atom::Unknown && (attr.prefix.empty() || !element->attributes.find(atom))) {
+			element->attributes.set(atom, attr.value);
+		}
+	}
+}
+
+void SVGGraphicsElement::compute_style(const ComputedStyle* parent_style, StyleContext& context) {
+	computed_style = ::compute_style(parent_style, styles, context);
+}
+
+bool SVGGraphicsElement::get_attribute_in_references(const std::vector<SVGGraphicsElement*>& chain, Atom attr_name, std::string_view& attr_value) const {
+	const std::string_view* value = attributes.find(attr_name);
+
+	if (value) {
+		attr_value = *value;
+
+		return true;
+	}
+
+	for (auto& element : chain) {
+		value = element->attributes.find(attr_name);
+
+		if (value) {
+			attr_value = *value;
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//Sets up the viewBox transform of an <svg> element. The outermost <svg> also
+//establishes the viewport that percentage lengths are relative to.
+bool apply_viewbox(SVGGraphicsElement* e, const XmlTokenizer& xml_reader, LengthContext& lengths, bool is_root) {
+	//Default viewport width and height
+	float width = lengths.viewport_width, height = lengths.viewport_height;
+	float vb_x = 0.0f, vb_y = 0.0f, vb_width = width, vb_height = height;
+
+	//Read width and height attributes
+	get_size_attribute(xml_reader, lengths, "width", width, LengthAxis::Horizontal);
+	get_size_attribute(xml_reader, lengths, "height", height, LengthAxis::Vertical);
+
+	std::string_view viewBoxStr;
+	bool has_viewbox = false;
+
+	if (get_attribute(xml_reader, "viewBox", viewBoxStr)) {
+		//Parse viewBox attribute.
+		//For now expect all four values to be present.
+		has_viewbox = parse_viewbox(viewBoxStr, vb_x, vb_y, vb_width, vb_height) &&
+			vb_width > 0.0f && vb_height > 0.0f;
+	}
+
+	if (is_root) {
+		lengths.viewport_width = has_viewbox ? vb_width : width;
+		lengths.viewport_height = has_viewbox ? vb_height : height;
+	}
+
+	if (!has_viewbox) {
+		return false;
+	}
+
+	//Calculate scale factors
+	float scale_x = width / vb_width;
+	float scale_y = height / vb_height;
+	float scale = scale_x < scale_y ? scale_x : scale_y;
+
+	//Create transform matrix
+	e->combined_transform = Matrix::translation(-vb_x, -vb_y).then(Matrix::scale(scale, scale));
+
+	return true;
+}
+
+//Makes every <use> node in the dom draw the element it references. All instances are
+//added before their styles, since the styles of an instance depend on the instances
+//of the <use> elements inside the subtree it draws.
+static void resolve_instances(SVGDocument& document, SVGDomBuilder& builder, StyleContext& style_context) {
+	SVGDom& dom = document.dom;
+
+	for (NodeIndex i = 0; i < dom.size(); ++i) {
+		if (dom.kind[i] == ElementKind::Use) {
+			auto id_it = document.id_map.find(static_cast<const SVGUseElement*>(dom.element[i])->href_id);
+
+			//Elements outside of the root <svg> are not in the dom
+			if (id_it != document.id_map.end() && id_it->second->node != no_index) {
+				builder.add_instance(i, id_it->second->node);
+			}
+		}
+	}
+
+	for (NodeIndex i = 0; i < dom.size(); ++i) {
+		if (dom.instance_index[i] != no_index) {
+			builder.add_instance_styles(i, style_context);
+		}
+	}
+}
+
+static SVGGraphicsElement* create_svg(const XmlTokenizer& xml_reader, SVGLoadContext& context) {
+	auto svg_element = context.arena.create<SVGGraphicsElement>(context.arena);
+
+	if (!context.is_root) {
+		//Inner svg elements have some special treatment
+		float x = 0.0f, y = 0.0f;
+
+		if (get_size_attribute(xml_reader, context.lengths, "x", x, LengthAxis::Horizontal) &&
+			get_size_attribute(xml_reader, context.lengths, "y", y, LengthAxis::Vertical)) {
+			//Position the inner SVG element
+			svg_element->combined_transform = Matrix::translation(x, y);
+		}
+	}
+
+	apply_viewbox(svg_element, xml_reader, context.lengths, context.is_root);
+
+	return svg_element;
+}
+
+static SVGGraphicsElement* create_rect(const XmlTokenizer& xml_reader, SVGLoadContext& context) {
+	float x = 0.0f, y = 0.0f, width = 0.0f, height = 0.0f, rx = 0.0f, ry = 0.0f;
+
+	get_size_attribute(xml_reader, context.lengths, "x", x, LengthAxis::Horizontal);
+	get_size_attribute(xml_reader, context.lengths, "y", y, LengthAxis::Vertical);
+	get_size_attribute(xml_reader, context.lengths, "width", width, LengthAxis::Horizontal);
+	get_size_attribute(xml_reader, context.lengths, "height", height, LengthAxis::Vertical);
+
+	auto rect_element = context.arena.create<SVGRectElement>(context.arena);
+
+	rect_element->points.assign({ x, y, width, height });
+
+	bool has_rx = get_size_attribute(xml_reader, context.lengths, "rx", rx, LengthAxis::Horizontal);
+	bool has_ry = get_size_attribute(xml_reader, context.lengths, "ry", ry, LengthAxis::Vertical);
+
+	if (has_rx || has_ry) {
+		if (!has_rx) {
+			rx = ry;
+		}
+		if (!has_ry) {
+			ry = rx;
+		}
+
+		rect_element->points.insert(rect_element->points.end(), { rx, ry });
+	}
+
+	return rect_element;
+}
+
+static SVGGraphicsElement* create_circle(const XmlTokenizer& xml_reader, SVGLoadContext& context) {
+	float cx = 0.0f, cy = 0.0f, r = 0.0f;
+
+	get_size_attribute(xml_reader, context.lengths, "cx", cx, LengthAxis::Horizontal);
+	get_size_attribute(xml_reader, context.lengths, "cy", cy, LengthAxis::Vertical);
+	get_size_attribute(xml_reader, context.lengths, "r", r, LengthAxis::Diagonal);
+
+	auto circle_element = context.arena.create<SVGCircleElement>(context.arena);
+
+	circle_element->points.assign({ cx, cy, r });
+
+	return circle_element;
+}
+
+static SVGGraphicsElement* create_ellipse(const XmlTokenizer& xml_reader, SVGLoadContext& context) {
+	float cx, cy, rx, ry;
+
+	if (!get_size_attribute(xml_reader, context.lengths, "cx", cx, LengthAxis::Horizontal)) {
+		cx = 0.0f;
+	}
+
+	if (!get_size_attribute(xml_reader, context.lengths, "cy", cy, LengthAxis::Vertical)) {
+		cy = 0.0f;
+	}
+
+	if (!get_size_attribute(xml_reader, context.lengths, "rx", rx, LengthAxis::Horizontal) ||
+		!get_size_attribute(xml_reader, context.lengths, "ry", ry, LengthAxis::Vertical)) {
+		return nullptr;
+	}
+
+	auto ellipse_element = context.arena.create<SVGEllipseElement>(context.arena);
+
+	ellipse_element->points.assign({ cx, cy, rx, ry });
+
+	return ellipse_element;
+}
+
+static SVGGraphicsElement* create_line(const XmlTokenizer& xml_reader, SVGLoadContext& context) {
+	float x1, y1, x2, y2;
+
+	if (!get_size_attribute(xml_reader, context.lengths, "x1", x1, LengthAxis::Horizontal) ||
+		!get_size_attribute(xml_reader, context.lengths, "y1", y1, LengthAxis::Vertical) ||
+		!get_size_attribute(xml_reader, context.lengths, "x2", x2, LengthAxis::Horizontal) ||
+		!get_size_attribute(xml_reader, context.lengths, "y2", y2, LengthAxis::Vertical)) {
+		return nullptr;
+	}
+
+	auto line_element = context.arena.create<SVGLineElement>(context.arena);
+
+	line_element->points.assign({ x1, y1, x2, y2 });
+
+	return line_element;
+}
+
+//Creates a path element from the data that has been parsed into the scratch path
+static SVGGraphicsElement* create_path_from_scratch(SVGLoadContext& context) {
+	auto path_element = context.arena.create<SVGPathElement>(context.arena);
+
+	path_element->path_data = context.path_scratch;
+
+	return path_element;
+}
+
+static SVGGraphicsElement* create_path(const XmlTokenizer& xml_reader, SVGLoadContext& context) {
+	std::string_view attr_value;
+
+	if (!get_attribute(xml_reader, "d", attr_value)) {
+		return nullptr;
+	}
+
+	//Per the SVG spec a path is rendered up to the first error in its data
+	parse_path_data(attr_value, context.path_scratch);
+
+	return create_path_from_scratch(context);
+}
+
+static SVGGraphicsElement* create_polyline(const XmlTokenizer& xml_reader, SVGLoadContext& context) {
+	std::string_view attr_value;
+
+	if (!get_attribute(xml_reader, "points", attr_value)) {
+		return nullptr;
+	}
+
+	parse_points(attr_value, false, context.path_scratch);
+
+	return create_path_from_scratch(context);
+}
+
+static SVGGraphicsElement* create_polygon(const XmlTokenizer& xml_reader, SVGLoadContext& context) {
+	std::string_view attr_value;
+
+	if (!get_attribute(xml_reader, "points", attr_value)) {
+		return nullptr;
+	}
+
+	parse_points(attr_value, true, context.path_scratch);
+
+	return create_path_from_scratch(context);
+}
+
+static SVGGraphicsElement* create_g(const XmlTokenizer& xml_reader, SVGLoadContext& context) {
+	return context.arena.create<SVGGElement>(context.arena);
+}
+
+static SVGGraphicsElement* create_defs(const XmlTokenizer& xml_reader, SVGLoadContext& context) {
+	return context.arena.create<SVGDefsElement>(context.arena);
+}
+
+static SVGGraphicsElement* create_use(const XmlTokenizer& xml_reader, SVGLoadContext& context) {
+	std::string_view attr_value;
+
+	if (!get_href_id(xml_reader, attr_value)) {
+		return nullptr;
+	}
+
+	auto use_element = context.arena.create<SVGUseElement>(context.arena);
+	float x = 0.0f, y = 0.0f, width = 0.0f, height = 0.0f;
+
+	use_element->href_id = context.arena.copy_string(attr_value);
+
+	//x and y are an extra translation, applied before the transform attribute
+	get_size_attribute(xml_reader, context.lengths, "x", x, LengthAxis::Horizontal);
+	get_size_attribute(xml_reader, context.lengths, "y", y, LengthAxis::Vertical);
+
+	if (x != 0.0f || y != 0.0f) {
+		use_element->combined_transform = Matrix::translation(x, y);
+	}
+
+	if (get_size_attribute(xml_reader, context.lengths, "width", width, LengthAxis::Horizontal)) {
+		use_element->width = width;
+	}
+
+	if (get_size_attribute(xml_reader, context.lengths, "height", height, LengthAxis::Vertical)) {
+		use_element->height = height;
+	}
+
+	return use_element;
+}
+
+static SVGGraphicsElement* create_symbol(const XmlTokenizer& xml_reader, SVGLoadContext& context) {
+	auto symbol_element = context.arena.create<SVGSymbolElement>(context.arena);
+	std::string_view attr_value;
+
+	symbol_element->width = context.lengths.viewport_width;
+	symbol_element->height = context.lengths.viewport_height;
+
+	get_size_attribute(xml_reader, context.lengths, "width", symbol_element->width, LengthAxis::Horizontal);
+	get_size_attribute(xml_reader, context.lengths, "height", symbol_element->height, LengthAxis::Vertical);
+
+	if (get_attribute(xml_reader, "viewBox", attr_value)) {
+		parse_viewbox(attr_value, symbol_element->viewbox_x, symbol_element->viewbox_y, symbol_element->viewbox_width, symbol_element->viewbox_height);
+	}
+
+	if (get_attribute(xml_reader, "preserveAspectRatio", attr_value)) {
+		parse_aspect_ratio(attr_value, symbol_element->aspect_ratio);
+	}
+
+	return symbol_element;
+}
+
+#ifndef SVGLIB_NO_TEXT
+static SVGGraphicsElement* create_text(const XmlTokenizer& xml_reader, SVGLoadContext& context) {
+	auto text_element = context.arena.create<SVGTextElement>(context.arena);
+	float x = 0, y = 0;
+
+	get_size_attribute(xml_reader, context.lengths, "x", x, LengthAxis::Horizontal);
+	get_size_attribute(xml_reader, context.lengths, "y", y, LengthAxis::Vertical);
+
+	text_element->points.assign({ x, y });
+
+	return text_element;
+}
+#endif
+
+#ifndef SVGLIB_NO_GRADIENTS
+static SVGGraphicsElement* create_linear_gradient(const XmlTokenizer& xml_reader, SVGLoadContext& context) {
+	auto linear_gradient = context.arena.create<SVGLinearGradientElement>(context.arena);
+	
+	//Gradient attrubutes like x1, y1 are special since they could be inherited
+	//from a reference chain. We can't do that until we resolve the references, 
+	// so we save them as attributes for now and process them later in create_presentation_assets.
+	save_all_attributes(xml_reader, linear_gradient);
+
+	return linear_gradient;
+}
+
+static SVGGraphicsElement* create_radial_gradient(const XmlTokenizer& xml_reader, SVGLoadContext& context) {
+	auto radial_gradient = context.arena.create<SVGRadialGradientElement>(context.arena);
+	
+	//Gradient attrubutes like cx, cy are special since they could be inherited
+	//from a reference chain. We can't do that until we resolve the references, 
+	// so we save them as attributes for now and process them later in create_presentation_assets.
+	save_all_attributes(xml_reader, radial_gradient);
+
+	return radial_gradient;
+}
+
+static SVGGraphicsElement* create_stop(const XmlTokenizer& xml_reader, SVGLoadContext& context) {
+	std::string_view attr_value;
+	auto stop_element = context.arena.create<SVGStopElement>(context.arena);
+	float offset = 0;
+
+	if (get_attribute(xml_reader, "offset", attr_value)) {
+		parse_number_or_percentage(attr_value, offset);
+	}
+
+	stop_element->offset = offset;
+
+	return stop_element;
+}
+#endif
+
+//Element handlers indexed by the atom of the element name. Known names are found with
+//the perfect hash of the static atoms, so finding the factory of an element is one
+//hash and one array index. Handlers for other names sit after Atom::Count.
+//Define SVGLIB_NO_TEXT or SVGLIB_NO_GRADIENTS to build the library without those elements.
+static std::vector<SVGElementHandler>& element_handlers() {
+	static std::vector<SVGElementHandler> handlers = [] {
+		std::vector<SVGElementHandler> builtin(static_cast<size_t>(Atom::Count));
+		auto add = [&](Atom name, ElementKind kind, SVGElementFactory create) {
+			builtin[static_cast<size_t>(name)] = { kind, create };
+		};
+
+		add(Atom::Svg, ElementKind::Svg, create_svg);
+		add(Atom::G, ElementKind::G, create_g);
+		add(Atom::Defs, ElementKind::Defs, create_defs);
+		add(Atom::Use, ElementKind::Use, create_use);
+		add(Atom::Symbol, ElementKind::Symbol, create_symbol);
+		add(Atom::Rect, ElementKind::Rect, create_rect);
+		add(Atom::Circle, ElementKind::Circle, create_circle);
+		add(Atom::Ellipse, ElementKind::Ellipse, create_ellipse);
+		add(Atom::Line, ElementKind::Line, create_line);
+		add(Atom::Path, ElementKind::Path, create_path);
+		add(Atom::Polyline, ElementKind::Polyline, create_polyline);
+		add(Atom::Polygon, ElementKind::Polygon, create_polygon);
+#ifndef SVGLIB_NO_TEXT
+		add(Atom::Text, ElementKind::Text, create_text);
+#endif
+#ifndef SVGLIB_NO_GRADIENTS
+		add(Atom::LinearGradient, ElementKind::LinearGradient, create_linear_gradient);
+		add(Atom::RadialGradient, ElementKind::RadialGradient, create_radial_gradient);
+		add(Atom::Stop, ElementKind::Stop, create_stop);
+#endif
+
+		//Written by some old editors
+		Atom group = intern_atom("group");
+
+		builtin.resize(static_cast<size_t>(group) + 1);
+		builtin[static_cast<size_t>(group)] = { ElementKind::G, create_g };
+
+		return builtin;
+	}();
+
+	return handlers;
+}
+
+const SVGElementHandler* find_element_handler(Atom name) {
+	const std::vector<SVGElementHandler>& handlers = element_handlers();
+	size_t index = static_cast<size_t>(name);
+
+	if (index >= handlers.size() || handlers[index].create == nullptr) {
+		return nullptr;
+	}
+
+	return &handlers[index];
+}
+
+void SVG::register_element(std::string_view name, ElementKind kind, SVGElementFactory factory) {
+	std::vector<SVGElementHandler>& handlers = element_handlers();
+	Atom atom = intern_atom(name);
+
+	//The atom table is full. Atom::Unknown stands for every unknown element, so it can't
+	//get a handler.
+	if (atom == Atom::Unknown) {
+		return;
+	}
+
+	size_t index = static_cast<size_t>(atom);
+
+	if (index >= handlers.size()) {
+		handlers.resize(index + 1);
+	}
+
+	handlers[index] = { kind, factory };
+}
+
+static SVGLimits& limits() {
+	static SVGLimits current;
+
+	return current;
+}
+
+void SVG::set_limits(const SVGLimits& new_limits) {
+	limits() = new_limits;
+}
+
+const SVGLimits& SVG::get_limits() {
+	return limits();
+}
+
+
+DocumentReader::DocumentReader(const char* data, size_t size, const LengthContext& lengths, SVGDocument& document, SVGDomBuilder* dom_builder) :
+	xml_reader(data, size),
+	document(document),
+	dom_builder(dom_builder),
+	load_context{ document.arena, style_context.lengths, path_scratch, true } {
+	style_context.arena = &document.arena;
+	style_context.lengths = lengths;
+	max_element_depth = SVG::get_limits().max_element_depth;
+	document.dom.max_instance_depth = SVG::get_limits().max_instance_depth;
+}
+
+XmlToken DocumentReader::next() {
+	XmlToken token = xml_reader.next();
+
+	switch (token) {
+	case XmlToken::StartElement:
+		if (parent_stack.size() >= max_element_depth) {
+			return XmlToken::Error;
+		}
+
+		read_start_element();
+
+		break;
+	case XmlToken::Text:
+		if (!read_text()) {
+			return XmlToken::Error;
+		}
+
+		break;
+	case XmlToken::EndElement:
+		read_end_element();
+
+		break;
+	default:
+		break;
+	}
+
+	return token;
+}
+
+void DocumentReader::read_start_element() {
+	bool is_self_closing = xml_reader.is_empty_element();
+	std::string_view element_name = xml_reader.local_name(), attr_value;
+	//Names that no handler was registered for stay Atom::Unknown, so that documents
+	//can't fill the atom table
+	Atom element = find_interned_atom(element_name);
+	Arena& arena = document.arena;
+	//Ids are copied into the arena
+	std::map<std::string_view, SVGGraphicsElement*>& id_map = document.id_map;
+
+	SVGGraphicsElement* parent_element = nullptr;
+	SVGGraphicsElement* new_element = nullptr;
+	bool in_dom = false;
+
+	++elements_read;
+
+	if (!parent_stack.empty()) {
+		parent_element = parent_stack.back().element;
+	}
+
+	//em units in attributes are relative to the inherited font size
+	style_context.lengths.font_size = parent_element ? parent_element->computed_style->font_size : LengthContext().font_size;
+
+	const SVGElementHandler* handler = find_element_handler(element);
+	ElementKind kind = ElementKind::Unknown;
+
+	if (handler) {
+		kind = handler->kind;
+		load_context.is_root = !document.root_element;
+		new_element = handler->create(xml_reader, load_context);
+	}
+	else {
+		//Unknown element
+		new_element = arena.create<SVGGraphicsElement>(arena);
+	}
+
+	if (new_element) {
+		new_element->tag = element;
+		new_element->kind = kind;
+
+		if (kind == ElementKind::Svg && !document.root_element) {
+			//This is the root <svg> element
+			document.root_element = new_element;
+		}
+
+		if (get_attribute(xml_reader, "id", attr_value)) {
+			std::string_view id = arena.copy_string(attr_value);
+
+			id_map[id] = new_element;
+		}
+
+		//Transform is not inherited
+		if (get_attribute(xml_reader, "transform", attr_value)) {
+			Matrix trans;
+
+			//If the element already has a transform (like inner <svg>), combine them
+			if (new_element->combined_transform)
+			{
+				trans = new_element->combined_transform.value();
+			}
+
+			if (build_transform_matrix(attr_value, trans)) {
+				new_element->combined_transform = trans;
+			}
+		}
+
+		if (get_attribute(xml_reader, "gradientTransform", attr_value)) {
+			Matrix trans;
+
+			//If the element already has a transform (like inner <svg>), combine them
+			if (new_element->combined_transform)
+			{
+				trans = new_element->combined_transform.value();
+			}
+
+			if (build_transform_matrix(attr_value, trans)) {
+				new_element->combined_transform = trans;
+			}
+		}
+
+		save_presentation_attributes(xml_reader, new_element);
+
+		//Styles are computed top down as the document is read. The parent style is final by now.
+		new_element->compute_style(parent_element ? parent_element->computed_style : nullptr, style_context);
+
+		if (parent_element) {
+			//Add the new element to its parent
+			DEBUG_OUT("Parent::Child: " << atom_name(parent_element->tag) << "::" << element_name);
+
+			parent_element->children.push_back(new_element);
+		}
+
+		if (dom_builder && (new_element == document.root_element || (!parent_stack.empty() && parent_stack.back().in_dom))) {
+			NodeIndex node = dom_builder->open(new_element);
+
+			in_dom = true;
+
+			if (kind == ElementKind::Use) {
+				add_instance(node);
+			}
+		}
+	}
+
+	if (!is_self_closing) {
+		//Push the new element onto the stack
+		//This may be null if the element is not supported
+		parent_stack.push_back({ new_element, in_dom });
+	}
+	else if (in_dom) {
+		dom_builder->close();
+	}
+}
+
+//Makes a <use> node draw the element it references, if that was read completely
+void DocumentReader::add_instance(NodeIndex node) {
+	auto id_it = document.id_map.find(static_cast<const SVGUseElement*>(document.dom.element[node])->href_id);
+
+	if (id_it == document.id_map.end() || id_it->second->node == no_index || is_open(id_it->second)) {
+		//A forward reference. Left for finish().
+		++deferred_uses;
+
+		return;
+	}
+
+	if (dom_builder->add_instance(node, id_it->second->node)) {
+		dom_builder->add_instance_styles(node, style_context);
+	}
+}
+
+//True if the end tag of element was not read yet
+bool DocumentReader::is_open(const SVGGraphicsElement* element) const {
+	for (const OpenElement& open_element : parent_stack) {
+		if (open_element.element == element) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//Returns false if the text is outside of any element
+bool DocumentReader::read_text() {
+	if (xml_reader.text_is_whitespace()) {
+		return true; //Formatting white space between elements
+	}
+
+	if (parent_stack.empty()) {
+		return false;
+	}
+
+	SVGGraphicsElement* parent_element = parent_stack.back().element;
+
+	if (!parent_element || parent_element->kind != ElementKind::Text) {
+		return true; //Text nodes are only valid inside <text> elements
+	}
+
+#ifndef SVGLIB_NO_TEXT
+	auto text_element = static_cast<SVGTextElement*>(parent_element);
+
+	std::string_view source = xml_reader.text();
+
+	//Collapse white space if needed.
+	if (text_element->computed_style->collapse_white_space) {
+		std::string collapsed;
+
+		collapse_whitespace(source, collapsed);
+		utf8_to_wide(collapsed, text_element->text_content);
+	}
+	else {
+		utf8_to_wide(source, text_element->text_content);
+	}
+#endif
+
+	return true;
+}
+
+void DocumentReader::read_end_element() {
+	DEBUG_OUT("End Element: " << xml_reader.local_name());
+
+	if (parent_stack.empty()) {
+		return;
+	}
+
+	if (parent_stack.back().in_dom) {
+		dom_builder->close();
+	}
+
+	parent_stack.pop_back();
+}
+
+void DocumentReader::finish() {
+	if (dom_builder) {
+		//The nodes were added as they were read. Only the instances are made again,
+		//since the ones made so far may draw subtrees with deferred <use> nodes in them.
+		dom_builder->clear_instances();
+		resolve_instances(document, *dom_builder, style_context);
+	}
+	else {
+		//Flatten the final tree. This also computes the bounding boxes that
+		//gradients in objectBoundingBox units depend on.
+		build_dom(document.root_element, document.dom);
+
+		SVGDomBuilder builder(document.dom);
+
+		resolve_instances(document, builder, style_context);
+	}
+
+	document.lengths = style_context.lengths;
+}
+
+//Builds the element tree from a UTF-8 encoded document. The device is not used,
+//so this can run on any thread.
+static bool parse_utf8(const char* data, size_t size, const LengthContext& lengths, SVGDocument& document) {
+	//Clear previous document
+	document.clear();
+
+	DocumentReader reader(data, size, lengths, document);
+
+	while (true) {
+		XmlToken token = reader.next();
+
+		if (token == XmlToken::EndOfDocument) {
+			break;
+		}
+
+		if (token == XmlToken::Error) {
+			return false;
+		}
+	}
+
+	reader.finish();
+
+	return true;
+}
+
+size_t count_start_tags(std::string_view utf8) {
+	size_t count = 0;
+	const char* p = utf8.data();
+	const char* end = p + utf8.size();
+
+	while ((p = static_cast<const char*>(memchr(p, '<', end - p))) != nullptr) {
+		++p;
+
+		if (p < end && *p != '/' && *p != '!' && *p != '?') {
+			++count;
+		}
+	}
+
+	return count;
+}
+
+bool get_utf8(const void* data, size_t size, std::string& converted, std::string_view& utf8) {
+	if (data == nullptr || size == 0) {
+		return false;
+	}
+
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+	if (size >= 2 && ((bytes[0] == 0xFF && bytes[1] == 0xFE) || (bytes[0] == 0xFE && bytes[1] == 0xFF))) {
+		//UTF-16 documents are rare. They are converted to UTF-8 up front so 
+		//that the rest of the parser only deals with one encoding.
+		if (!utf16_to_utf8(bytes, size, converted)) {
+			return false;
+		}
+
+		utf8 = converted;
+
+		return true;
+	}
+
+	utf8 = std::string_view(static_cast<const char*>(data), size);
+
+	return true;
+}
+
+bool SVG::parse_from_memory(const void* data, size_t size, SVGDocument& document, const LengthContext& lengths) {
+	std::string converted;
+	std::string_view utf8;
+
+	if (!get_utf8(data, size, converted, utf8)) {
+		return false;
+	}
+
+	return parse_utf8(utf8.data(), utf8.size(), lengths, document);
+}
+
+#ifdef _WIN32
+bool SVG::parse(const wchar_t* file_name, SVGDocument& document, const LengthContext& lengths) {
+#else
+bool SVG::parse(const char* file_name, SVGDocument& document, const LengthContext& lengths) {
+#endif
+	MappedFile file;
+
+	if (!file.open(file_name)) {
+		return false;
+	}
+
+	return parse_from_memory(file.data, file.size, document, lengths);
+}
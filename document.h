@@ -0,0 +1,252 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <string_view>
+#include <memory_resource>
+#include <optional>
+#include <map>
+#include <memory>
+#include "path_data.h"
+#include "style.h"
+#include "atoms.h"
+#include "arena.h"
+#include "transform.h"
+#include "dom.h"
+#include "renderer.h"
+
+//The device-free part of the library: elements, documents and their parsing, and
+//rendering through an SVGRenderer. Nothing here needs Windows, so this builds on any
+//platform. svglib.h adds the Direct2D device and the images bound to it.
+
+struct SVGDevice;
+struct SVGElementAssets;
+struct SVGImage;
+struct SVGMemoryReport;
+
+//Represents an XML element in the SVG file such as <g>, <rect>, <circle>, etc.
+//Names and values are kept as UTF-8 strings, the same encoding as the source document.
+//Elements are created in the arena of their document together with their children lists,
+//points, styles and attributes. They are never deleted one by one.
+//Elements hold no device resources and don't change once the document is parsed.
+struct SVGGraphicsElement {
+	Atom tag = Atom::Unknown;
+	//Says which SVGGraphicsElement subclass the element is
+	ElementKind kind = ElementKind::Unknown;
+	std::pmr::vector<SVGGraphicsElement*> children;
+	std::optional<Matrix> combined_transform;
+	std::pmr::vector<float> points;
+	//Presentation properties specified on the element itself
+	AtomMap styles;
+	//Styles after inheritance. Shared with the parent when the element specifies none.
+	const ComputedStyle* computed_style = nullptr;
+	AtomMap attributes;
+	Bounds bbox;
+	//Node of the element in the dom of its document
+	NodeIndex node = no_index;
+
+	//The containers above are made with the arena of the document, so elements are not
+	//destroyed one by one when it is cleared
+	using ArenaOwned = SVGGraphicsElement;
+
+	explicit SVGGraphicsElement(Arena& arena);
+
+	//Defaults for elements that draw nothing and have no geometry. Element types that
+	//need something else declare a member with the same name. Call these through the
+	//functions below, which pick the member of the actual type of the element.
+	void render(SVGRenderer& renderer, const SVGPaint& paint) const {}
+	//Creates the brushes and stroke style of a shape drawn with the given style. That is the
+	//computed style of the element, unless it is drawn by a <use> element that passes on others.
+	//Defined with the Direct2D backend, see svglib.h.
+	void create_presentation_assets(const ComputedStyle& style, const std::map<std::string_view, SVGGraphicsElement*>& id_map, const LengthContext& lengths, const SVGDevice& device, SVGElementAssets& assets) const;
+	//Computes the bbox of a shape in its local coordinates. The bbox of a container
+	//is the union of the boxes of its children and is set by build_dom().
+	void compute_bbox() {}
+	//Appends the outline of a shape element to path in its local coordinates.
+	//Returns false for elements that have no outline of their own, like <g>.
+	bool to_path_data(PathData& path) const { return false; }
+
+	//Computes the style of the element from the style of its parent.
+	void compute_style(const ComputedStyle* parent_style, StyleContext& context);
+	bool get_attribute_in_references(const std::vector<SVGGraphicsElement*>& chain, Atom attr_name, std::string_view& attr_value) const;
+};
+
+//Element operations dispatched on the kind of the element. Each one is a switch that
+//calls the member of the element type, so elements need neither a vtable nor RTTI.
+//render_element() is given the kind from SVGDom::kind, so drawing a path whose geometry
+//is built doesn't have to read the element at all.
+void render_element(const SVGGraphicsElement& element, ElementKind kind, SVGRenderer& renderer, const SVGPaint& paint);
+void compute_element_bbox(SVGGraphicsElement& element);
+bool element_to_path_data(const SVGGraphicsElement& element, PathData& path);
+
+class XmlTokenizer;
+
+//What an element factory is given to build an element from its start tag.
+//Elements are built without a device. Device assets are created when the
+//document is bound to a device.
+struct SVGLoadContext {
+	Arena& arena;
+	//Resolves lengths against the viewport and the inherited font size
+	LengthContext& lengths;
+	//Reusable buffer for parsing path data
+	PathData& path_scratch;
+	//True for the outermost <svg> element
+	bool is_root;
+};
+
+//Creates an element in context.arena from a start tag. Attributes are read from xml,
+//which is positioned on the tag. Style, id and transform are handled by the loader.
+//Returns null to drop the element together with its content.
+typedef SVGGraphicsElement* (*SVGElementFactory)(const XmlTokenizer& xml, SVGLoadContext& context);
+
+struct SVGElementHandler {
+	//Type of the elements that the factory creates. Decides how they are rendered.
+	ElementKind kind = ElementKind::Unknown;
+	SVGElementFactory create = nullptr;
+};
+
+//Returns the handler for an element name, or null if elements of that name are not supported.
+const SVGElementHandler* find_element_handler(Atom name);
+
+//A parsed SVG document. It holds the element tree and nothing that depends on a device,
+//so documents can be parsed on any thread, or on a machine without a display.
+//All elements live in the arena of the document and are freed in one step.
+//The tree is also stored flattened in dom, which is what rendering walks.
+//A document doesn't change once it is parsed, so one document can be shared by
+//any number of images, on any threads.
+struct SVGDocument
+{
+	Arena arena;
+	SVGGraphicsElement* root_element = nullptr;
+	SVGDom dom{ arena };
+	//Elements by id, for resolving references like fill="url(#gradient1)"
+	std::map<std::string_view, SVGGraphicsElement*> id_map;
+	//Units that lengths were resolved against
+	LengthContext lengths;
+
+	void clear();
+};
+
+//The part of an image that doesn't depend on a device: a share of the document and
+//what it draws. SVGImage adds the assets of the device the image is bound to.
+struct SVGImageBase
+{
+	std::shared_ptr<const SVGDocument> document;
+	//What the image draws, compiled when the image is bound. An image that is rendered
+	//without being bound, or while it is streamed in, is drawn by walking the dom instead.
+	//Call compile_display_list() to draw such an image from a list.
+	SVGDisplayList display_list;
+
+	//Releases the display list and the image's share of the document
+	void clear();
+};
+
+//What a render drew and what it skipped
+struct SVGRenderStats {
+	//Shapes sent to the renderer
+	size_t drawn = 0;
+	//Shapes that were not sent because they are outside the clip rect
+	size_t culled = 0;
+	//Groups of shapes that were skipped with a single test. Their shapes are counted in culled.
+	//Renders that look shapes up in the index of a large display list don't skip groups.
+	size_t culled_groups = 0;
+};
+
+//Bounds on the structure of the documents that are loaded. All traversals of a document
+//keep stacks of their own, so these bound the work and memory that a malicious or broken
+//file can cause, not the depth of the C++ stack.
+struct SVGLimits {
+	//A document with elements nested deeper than this fails to load
+	size_t max_element_depth = 1024;
+	//<use> elements nested deeper than this inside the subtrees drawn by other <use> elements are not drawn
+	uint32_t max_instance_depth = 64;
+	//A gradient only inherits attributes from this many gradients along its href chain
+	size_t max_reference_chain = 64;
+};
+
+//The entry points of the library. The members that take an SVGDevice or an SVGImage
+//are defined with the Direct2D backend and are only available on Windows.
+struct SVG
+{
+	//Loads an SVG file and populates the SVGImage structure. Returns true on success, false on failure.
+	//The must later be rendered using the same device that was used to load it. This is because some presentation assets 
+	//like brushes are created for that device during loading and are stored in the SVGImage structure.
+	//The device must be initialized before calling this function.
+	//If an image was already loaded in the SVGImage structure, it will be cleared before loading the new one.
+	//The file is memory mapped and parsed straight out of the mapping.
+	static bool load(const wchar_t* file_name, const SVGDevice& device, SVGImage& image);
+
+	//Loads an SVG document that is already held in memory, such as an embedded resource or 
+	//a buffer received over the network. The data is parsed in place and is not retained, so the
+	//caller may release it as soon as this function returns. Otherwise works the same as load().
+	static bool load_from_memory(const void* data, size_t size, const SVGDevice& device, SVGImage& image);
+
+	//Parses an SVG file into a document without using a device. Lengths in the document
+	//are resolved against lengths. The default is 96 DPI, and percentages are taken of the
+	//viewBox or size of the root <svg>. Pass SVGDevice::get_lengths() to parse exactly like
+	//load() does for that device. Safe to call from any thread.
+	//Returns true on success, false on failure.
+	//File names are UTF-16 on Windows, and byte strings elsewhere.
+#ifdef _WIN32
+	static bool parse(const wchar_t* file_name, SVGDocument& document, const LengthContext& lengths = LengthContext());
+#else
+	static bool parse(const char* file_name, SVGDocument& document, const LengthContext& lengths = LengthContext());
+#endif
+
+	//Parses an SVG document held in memory. Otherwise works the same as parse().
+	static bool parse_from_memory(const void* data, size_t size, SVGDocument& document, const LengthContext& lengths = LengthContext());
+
+	//Creates the presentation assets of a parsed document for a device and stores them,
+	//together with a share of the document, in image. Any previous content of the image
+	//is released. Call again to bind to another device, or after the device was lost.
+	static void bind(std::shared_ptr<const SVGDocument> document, const SVGDevice& device, SVGImage& image);
+
+	//Loads many SVG files. The files are read and parsed in parallel on up to max_threads
+	//threads, the calling thread included. 0 means one thread per processor core.
+	//The device assets are then created on the calling thread, one image after another.
+	//images and results must have count entries. results[i] is set to true if file_names[i]
+	//was loaded into images[i]. Images that fail to load are left empty.
+	//Returns the number of files that were loaded.
+	static size_t load_batch(const wchar_t* const file_names[], size_t count, const SVGDevice& device, SVGImage images[], bool results[], unsigned max_threads = 0);
+
+	//Sets the factory for elements with the given local name, replacing any built-in one.
+	//The factory must create elements of the type that kind stands for, such as an
+	//SVGPathElement for ElementKind::Path. A null factory makes the loader treat
+	//such elements as unknown. Register handlers before loading images. The registry
+	//is shared by all threads and is not locked.
+	static void register_element(std::string_view name, ElementKind kind, SVGElementFactory factory);
+
+	//Sets the limits for documents parsed from now on. The gradient href limit also applies
+	//when images are bound. Like register_element(), call this before loading images.
+	static void set_limits(const SVGLimits& limits);
+	static const SVGLimits& get_limits();
+
+	//Reports how much memory the element tree of an image holds.
+	static void get_memory_report(const SVGImage& image, SVGMemoryReport& report);
+
+	//Clears the display surface by filling it with the specified color. The default color is white.
+	//This is optional and can be called before rendering an SVGImage to clear any previous content. 
+	//It is not necessary to call this function before every render, only when you want to clear the previous content.
+	static void clear(const SVGDevice& device, float red=1.0f, float green=1.0f, float blue=1.0f, float alpha=1.0f);
+
+	//Renders the SVGImage on the given device. The image must have been loaded using the same device.
+	//The first render of a shape builds its geometry into the image, so an image must not be
+	//rendered on two threads at once.
+	//Shapes that can't reach the render target are skipped. If stats is given, it is set
+	//to the number of shapes drawn and skipped.
+	static void render(const SVGDevice& device, const SVGImage& image, SVGRenderStats* stats = nullptr);
+
+	//Renders the SVGImage on the given device with the specified position and scale. The image must be loaded using the same device.
+	static void render(const SVGDevice& device, const SVGImage& image, float x, float y, float scale, SVGRenderStats* stats = nullptr);
+
+	//Sends the drawing operations of the image to renderer, in the coordinates of the image.
+	//The image doesn't have to be bound to a device. If stats is given, it is set to the
+	//number of shapes drawn.
+	static void render(SVGRenderer& renderer, const SVGImageBase& image, SVGRenderStats* stats = nullptr);
+
+	//Sends the drawing operations of the shapes that reach clip, in the coordinates of the
+	//image, with their stroke. The bounds of shapes are mapped through their transforms and
+	//tested against clip, and groups of shapes that are all outside are skipped at once.
+	static void render(SVGRenderer& renderer, const SVGImageBase& image, const Bounds& clip, SVGRenderStats* stats = nullptr);
+};
+
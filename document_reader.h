@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include "xml_tokenizer.h"
+#include "document.h"
+
+//Reads the elements of a UTF-8 encoded document into an SVGDocument, one token at
+//a time. parse_utf8() reads a whole document at once and SVGStreamLoader reads it in
+//steps. The device is not used, so this can run on any thread.
+class DocumentReader {
+public:
+	//When a dom builder is set, elements are also added to the dom of the document as
+	//soon as their start tag is read, and <use> elements get their instance right away
+	//if the element they reference has been read completely.
+	DocumentReader(const char* data, size_t size, const LengthContext& lengths, SVGDocument& document, SVGDomBuilder* dom_builder = nullptr);
+
+	//Reads the next token. Returns Error if the document is malformed or nests elements
+	//deeper than SVGLimits::max_element_depth.
+	XmlToken next();
+
+	//Flattens the final tree into the dom of the document, resolves the <use> elements
+	//and stores the length context. With a dom builder the dom is already complete and
+	//only the <use> elements are resolved again.
+	void finish();
+
+	//Number of start tags read so far
+	size_t element_count() const { return elements_read; }
+	//<use> elements that referenced an element that was not read completely yet.
+	//These are left for finish() to resolve.
+	size_t deferred_use_count() const { return deferred_uses; }
+	const LengthContext& lengths() const { return style_context.lengths; }
+
+private:
+	struct OpenElement {
+		//Null if the element is not supported
+		SVGGraphicsElement* element;
+		//True if the element has an open node in the dom
+		bool in_dom;
+	};
+
+	XmlTokenizer xml_reader;
+	SVGDocument& document;
+	SVGDomBuilder* dom_builder;
+	std::vector<OpenElement> parent_stack;
+	//Paths are parsed here first so that the arena gets a copy of the exact size
+	PathData path_scratch;
+	StyleContext style_context;
+	SVGLoadContext load_context;
+	size_t elements_read = 0;
+	size_t deferred_uses = 0;
+	size_t max_element_depth;
+
+	void read_start_element();
+	bool read_text();
+	void read_end_element();
+	void add_instance(NodeIndex node);
+	bool is_open(const SVGGraphicsElement* element) const;
+};
+
+//Counts the start tags of a document, to size the dom before it is built. Comments and
+//processing instructions are not counted. Elements outside of the root <svg> and tags
+//inside comments are, so the count may be a little high but is never too low.
+size_t count_start_tags(std::string_view utf8);
+
+//Gets the UTF-8 text of a document. Returns false if the document is empty or can not be converted.
+bool get_utf8(const void* data, size_t size, std::string& converted, std::string_view& utf8);
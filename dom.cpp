@@ -0,0 +1,737 @@
+#include "document.h"
+#include "dom.h"
+#include "use.h"
+#include "symbol.h"
+#include <algorithm>
+#include <cmath>
+
+//True for elements that render themselves
+bool is_shape(ElementKind kind) {
+	switch (kind) {
+	case ElementKind::Rect:
+	case ElementKind::Circle:
+	case ElementKind::Ellipse:
+	case ElementKind::Line:
+	case ElementKind::Path:
+	case ElementKind::Polyline:
+	case ElementKind::Polygon:
+	case ElementKind::Text:
+		return true;
+	default:
+		return false;
+	}
+}
+
+//Lets go of the memory of an array without touching it
+template <typename T>
+static void release(std::pmr::vector<T>& array) {
+	std::pmr::vector<T>(array.get_allocator()).swap(array);
+}
+
+SVGDom::SVGDom(Arena& arena) :
+	kind(&arena),
+	parent(&arena),
+	first_child(&arena),
+	next_sibling(&arena),
+	subtree_end(&arena),
+	transform_index(&arena),
+	style_index(&arena),
+	geometry_index(&arena),
+	element(&arena),
+	instance_index(&arena),
+	transforms(&arena),
+	styles(&arena),
+	geometries(&arena),
+	geometry_style(&arena),
+	instances(&arena),
+	style_sets(&arena),
+	style_set_slots(&arena) {
+}
+
+void SVGDom::clear() {
+	release(kind);
+	release(parent);
+	release(first_child);
+	release(next_sibling);
+	release(subtree_end);
+	release(transform_index);
+	release(style_index);
+	release(geometry_index);
+	release(element);
+	release(instance_index);
+	release(transforms);
+	release(styles);
+	release(geometries);
+	release(geometry_style);
+	release(instances);
+	release(style_sets);
+	release(style_set_slots);
+}
+
+void SVGDom::reserve(size_t node_count) {
+	kind.reserve(node_count);
+	parent.reserve(node_count);
+	first_child.reserve(node_count);
+	next_sibling.reserve(node_count);
+	subtree_end.reserve(node_count);
+	transform_index.reserve(node_count);
+	style_index.reserve(node_count);
+	geometry_index.reserve(node_count);
+	element.reserve(node_count);
+	instance_index.reserve(node_count);
+	geometries.reserve(node_count);
+	geometry_style.reserve(node_count);
+}
+
+const uint32_t* SVGDom::get_style_set_slots(uint32_t style_set, NodeIndex first) const {
+	if (style_set == no_index) {
+		return nullptr;
+	}
+
+	const SVGStyleSet& set = style_sets[style_set];
+
+	return style_set_slots.data() + set.first_slot + (first - set.target);
+}
+
+NodeIndex SVGDomBuilder::open(SVGGraphicsElement* element) {
+	NodeIndex node = static_cast<NodeIndex>(dom.kind.size());
+	NodeIndex parent = open_nodes.empty() ? no_index : open_nodes.back().node;
+
+	dom.kind.push_back(element->kind);
+	dom.parent.push_back(parent);
+	dom.first_child.push_back(no_index);
+	dom.next_sibling.push_back(no_index);
+	dom.subtree_end.push_back(node + 1);
+	dom.element.push_back(element);
+	dom.instance_index.push_back(no_index);
+	element->node = node;
+
+	if (parent != no_index) {
+		OpenNode& p = open_nodes.back();
+
+		if (p.last_child == no_index) {
+			dom.first_child[parent] = node;
+		}
+		else {
+			dom.next_sibling[p.last_child] = node;
+		}
+
+		p.last_child = node;
+	}
+
+	//Transforms are combined with the ones of the ancestors up front
+	uint32_t parent_transform = parent == no_index ? no_index : dom.transform_index[parent];
+
+	if (element->combined_transform) {
+		const Matrix& local = element->combined_transform.value();
+
+		dom.transform_index.push_back(static_cast<uint32_t>(dom.transforms.size()));
+		dom.transforms.push_back(parent_transform == no_index ? local : local.then(dom.transforms[parent_transform]));
+	}
+	else {
+		dom.transform_index.push_back(parent_transform);
+	}
+
+	//Most elements share the style of their parent
+	uint32_t parent_style = parent == no_index ? no_index : dom.style_index[parent];
+
+	if (parent_style != no_index && dom.styles[parent_style] == element->computed_style) {
+		dom.style_index.push_back(parent_style);
+	}
+	else {
+		dom.style_index.push_back(static_cast<uint32_t>(dom.styles.size()));
+		dom.styles.push_back(element->computed_style);
+	}
+
+	if (is_shape(element->kind)) {
+		dom.geometry_index.push_back(static_cast<uint32_t>(dom.geometries.size()));
+		dom.geometries.push_back(element);
+		dom.geometry_style.push_back(dom.style_index.back());
+	}
+	else {
+		dom.geometry_index.push_back(no_index);
+	}
+
+	open_nodes.push_back({ node, no_index });
+
+	return node;
+}
+
+void SVGDomBuilder::close() {
+	NodeIndex node = open_nodes.back().node;
+	SVGGraphicsElement* element = dom.element[node];
+	NodeIndex child = dom.first_child[node];
+
+	open_nodes.pop_back();
+
+	dom.subtree_end[node] = static_cast<NodeIndex>(dom.size());
+
+	if (child == no_index) {
+		compute_element_bbox(*element);
+
+		return;
+	}
+
+	//A container is the union of its children
+	Bounds bbox = dom.element[child]->bbox;
+
+	for (; child != no_index; child = dom.next_sibling[child]) {
+		const Bounds& r = dom.element[child]->bbox;
+
+		bbox.left = r.left < bbox.left ? r.left : bbox.left;
+		bbox.top = r.top < bbox.top ? r.top : bbox.top;
+		bbox.right = r.right > bbox.right ? r.right : bbox.right;
+		bbox.bottom = r.bottom > bbox.bottom ? r.bottom : bbox.bottom;
+	}
+
+	element->bbox = bbox;
+}
+
+NodeIndex SVGDomBuilder::add_subtree(SVGGraphicsElement* element) {
+	struct Pending {
+		SVGGraphicsElement* element;
+		//Next child to add
+		size_t child;
+	};
+
+	std::vector<Pending> pending;
+	NodeIndex node = open(element);
+
+	pending.push_back({ element, 0 });
+
+	while (!pending.empty()) {
+		Pending& p = pending.back();
+
+		if (p.child == p.element->children.size()) {
+			close();
+			pending.pop_back();
+
+			continue;
+		}
+
+		SVGGraphicsElement* child = p.element->children[p.child++];
+
+		open(child);
+		pending.push_back({ child, 0 });
+	}
+
+	return node;
+}
+
+void SVGDomBuilder::extend_open_nodes() {
+	for (const OpenNode& open_node : open_nodes) {
+		dom.subtree_end[open_node.node] = static_cast<NodeIndex>(dom.size());
+	}
+}
+
+bool SVGDomBuilder::has_open_shape() const {
+	for (const OpenNode& open_node : open_nodes) {
+		if (is_shape(dom.kind[open_node.node])) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool SVGDomBuilder::add_instance(NodeIndex node, NodeIndex target) {
+	if (node >= target && node < dom.subtree_end[target]) {
+		//A <use> element inside the subtree it references
+		return false;
+	}
+
+	const SVGUseElement& use = *static_cast<const SVGUseElement*>(dom.element[node]);
+	bool is_symbol = dom.kind[target] == ElementKind::Symbol;
+	//The transforms of the subtree include the ones of the ancestors of target,
+	//and those of a <symbol> itself. They are undone first.
+	NodeIndex outer = is_symbol ? target : dom.parent[target];
+	uint32_t outer_transform = outer == no_index ? no_index : dom.transform_index[outer];
+	Matrix transform;
+
+	if (outer_transform != no_index && !dom.transforms[outer_transform].invert(transform)) {
+		return false;
+	}
+
+	if (is_symbol) {
+		Matrix viewport;
+
+		if (!static_cast<const SVGSymbolElement*>(dom.element[target])->get_viewport_transform(use, viewport)) {
+			return false;
+		}
+
+		transform = transform.then(viewport);
+	}
+
+	//The transform of the <use> node includes its x and y
+	uint32_t use_transform = dom.transform_index[node];
+
+	if (use_transform != no_index) {
+		transform = transform.then(dom.transforms[use_transform]);
+	}
+
+	dom.instance_index[node] = static_cast<uint32_t>(dom.instances.size());
+	dom.instances.push_back({ target, transform, no_index });
+
+	return true;
+}
+
+void SVGDomBuilder::add_instance_styles(NodeIndex node, StyleContext& style_context) {
+	uint32_t instance = dom.instance_index[node];
+
+	if (instance != no_index) {
+		uint32_t style_set = get_style_set(dom.instances[instance].target, dom.element[node]->computed_style, style_context);
+
+		dom.instances[instance].style_set = style_set;
+	}
+}
+
+void SVGDomBuilder::clear_instances() {
+	std::fill(dom.instance_index.begin(), dom.instance_index.end(), no_index);
+	//The capacity is kept for the instances added next
+	dom.instances.clear();
+	dom.style_sets.clear();
+	dom.style_set_slots.clear();
+	target_style_sets.clear();
+}
+
+//Finds the style set of target for the inherited style. If there is none and may_add is
+//set, one is added, with slots left for the caller to fill in. Returns no_index if the
+//subtree can be drawn with its own styles, or if no set was found or added.
+uint32_t SVGDomBuilder::find_style_set(NodeIndex target, const ComputedStyle* inherited, bool may_add, bool& added) {
+	NodeIndex parent = dom.parent[target];
+
+	added = false;
+
+	if (parent == no_index || *dom.styles[dom.style_index[parent]] == *inherited) {
+		return no_index;
+	}
+
+	std::vector<uint32_t>& sets = target_style_sets[target];
+
+	for (uint32_t set : sets) {
+		if (*dom.style_sets[set].inherited == *inherited) {
+			return set;
+		}
+	}
+
+	if (!may_add) {
+		return no_index;
+	}
+
+	uint32_t set = static_cast<uint32_t>(dom.style_sets.size());
+	uint32_t first_slot = static_cast<uint32_t>(dom.style_set_slots.size());
+
+	dom.style_sets.push_back({ target, inherited, first_slot });
+	dom.style_set_slots.resize(first_slot + (dom.subtree_end[target] - target), no_index);
+	sets.push_back(set);
+	added = true;
+
+	return set;
+}
+
+//Finds or creates the style set of target when it inherits the given style, together
+//with the sets of the <use> nodes inside the subtree. Nested sets are filled in from a
+//work list rather than by recursion. Returns no_index if the subtree can be drawn with
+//its own styles.
+uint32_t SVGDomBuilder::get_style_set(NodeIndex target, const ComputedStyle* inherited, StyleContext& style_context) {
+	struct PendingSet {
+		uint32_t set;
+		//Entry of the pending set this one is nested in. no_index for the first one.
+		uint32_t outer;
+		//Number of instances nested to get here
+		uint32_t depth;
+	};
+
+	bool added;
+	uint32_t first_set = find_style_set(target, inherited, true, added);
+
+	if (!added) {
+		return first_set;
+	}
+
+	std::vector<PendingSet> pending;
+	//Styles of the nodes of a subtree as inherited from the instance
+	std::vector<const ComputedStyle*> styles;
+
+	pending.push_back({ first_set, no_index, 1 });
+
+	for (size_t p = 0; p < pending.size(); ++p) {
+		const SVGStyleSet set = dom.style_sets[pending[p].set];
+		NodeIndex end = dom.subtree_end[set.target];
+
+		styles.assign(end - set.target, nullptr);
+
+		for (NodeIndex i = set.target; i < end; ++i) {
+			const ComputedStyle* parent_style = i == set.target ? set.inherited : styles[dom.parent[i] - set.target];
+			const ComputedStyle* style = compute_style(parent_style, dom.element[i]->styles, style_context);
+
+			styles[i - set.target] = style;
+
+			if (dom.geometry_index[i] != no_index) {
+				uint32_t style_index = dom.style_index[i];
+
+				if (dom.styles[style_index] != style) {
+					style_index = static_cast<uint32_t>(dom.styles.size());
+					dom.styles.push_back(style);
+				}
+
+				dom.style_set_slots[set.first_slot + (i - set.target)] = static_cast<uint32_t>(dom.geometries.size());
+				dom.geometries.push_back(dom.element[i]);
+				dom.geometry_style.push_back(style_index);
+			}
+			else if (dom.instance_index[i] != no_index) {
+				//A nested <use> passes the styles of this set on. No set is made past a
+				//reference cycle or the depth limit, rendering stops there anyway.
+				NodeIndex nested_target = dom.instances[dom.instance_index[i]].target;
+				bool may_add = pending[p].depth < dom.max_instance_depth;
+
+				for (uint32_t q = static_cast<uint32_t>(p); may_add && q != no_index; q = pending[q].outer) {
+					may_add = dom.style_sets[pending[q].set].target != nested_target;
+				}
+
+				uint32_t nested = find_style_set(nested_target, style, may_add, added);
+
+				if (added) {
+					pending.push_back({ nested, static_cast<uint32_t>(p), pending[p].depth + 1 });
+				}
+
+				dom.style_set_slots[set.first_slot + (i - set.target)] = nested;
+			}
+		}
+	}
+
+	return first_set;
+}
+
+void build_dom(SVGGraphicsElement* root, SVGDom& dom) {
+	dom.clear();
+
+	if (!root) {
+		return;
+	}
+
+	std::vector<SVGGraphicsElement*> stack;
+	size_t count = 0, shape_count = 0, transform_count = 0;
+
+	//Count the nodes first so that every array is allocated once
+	stack.push_back(root);
+
+	while (!stack.empty()) {
+		SVGGraphicsElement* element = stack.back();
+
+		stack.pop_back();
+
+		++count;
+		shape_count += is_shape(element->kind) ? 1 : 0;
+		transform_count += element->combined_transform ? 1 : 0;
+
+		stack.insert(stack.end(), element->children.begin(), element->children.end());
+	}
+
+	dom.kind.reserve(count);
+	dom.parent.reserve(count);
+	dom.first_child.reserve(count);
+	dom.next_sibling.reserve(count);
+	dom.subtree_end.reserve(count);
+	dom.transform_index.reserve(count);
+	dom.style_index.reserve(count);
+	dom.geometry_index.reserve(count);
+	dom.element.reserve(count);
+	dom.instance_index.reserve(count);
+	dom.transforms.reserve(transform_count);
+	dom.geometries.reserve(shape_count);
+	dom.geometry_style.reserve(shape_count);
+
+	SVGDomBuilder builder(dom);
+
+	builder.add_subtree(root);
+}
+
+//Collects the shapes that a walk over the dom visits
+struct DrawnGeometrySearch {
+	std::vector<bool>& drawn;
+	std::vector<uint32_t>& found;
+
+	void enter(NodeIndex node, const SVGInstance& instance) {}
+	void leave() {}
+
+	void shape(NodeIndex node, uint32_t geometry) {
+		if (!drawn[geometry]) {
+			drawn[geometry] = true;
+			found.push_back(geometry);
+		}
+	}
+};
+
+void find_drawn_geometries(const SVGDom& dom, NodeIndex first, NodeIndex end, uint32_t style_set, std::vector<bool>& drawn, std::vector<uint32_t>& found) {
+	DrawnGeometrySearch search{ drawn, found };
+
+	walk_drawn_nodes(dom, first, end, style_set, search);
+}
+
+void SVGDisplayList::clear() {
+	ops.clear();
+	transforms.clear();
+	groups.clear();
+	index.clear();
+	node_count = 0;
+}
+
+Bounds get_drawn_bounds(const SVGGraphicsElement& element, ElementKind kind, const ComputedStyle& style, const Matrix& transform) {
+	if (kind == ElementKind::Text) {
+		return infinite_bounds();
+	}
+
+	return transform_bounds(element.bbox, style.get_stroke_extent(), transform);
+}
+
+//Appends the shapes that a walk over the dom visits to a display list. The container
+//nodes above each shape are opened as groups, and closed at the first node after their
+//subtree, so the ops of a group are the ones added while it was open.
+struct DisplayListCompiler {
+	//The nodes walked for the document or for an instance
+	struct Frame {
+		//Combined with the transforms of the instances around this one
+		Matrix transform;
+		//Nodes before this are outside of the subtree walked
+		NodeIndex first;
+		//Frames are numbered in the order they are entered
+		uint32_t id;
+	};
+
+	struct OpenGroup {
+		//Container node. no_index for the group of a whole instance.
+		NodeIndex node;
+		NodeIndex end;
+		uint32_t group;
+		//Size of frames when the group was opened
+		size_t depth;
+	};
+
+	const SVGDom& dom;
+	SVGDisplayList& list;
+	std::vector<Frame> frames;
+	std::vector<OpenGroup> open_groups;
+	//Containers to open for a node, innermost first
+	std::vector<NodeIndex> containers;
+	uint32_t frame_count = 0;
+	//Node transform of the last op and the frame it was drawn in
+	uint32_t last_transform = no_index;
+	uint32_t last_frame = no_index;
+
+	void open_group(NodeIndex node, NodeIndex end) {
+		//Bounds start out empty, so that the first op added replaces them
+		list.groups.push_back({ Bounds{ INFINITY, INFINITY, -INFINITY, -INFINITY }, static_cast<uint32_t>(list.ops.size()), 0, 0 });
+		open_groups.push_back({ node, end, static_cast<uint32_t>(list.groups.size() - 1), frames.size() });
+	}
+
+	void close_group() {
+		uint32_t index = open_groups.back().group;
+
+		open_groups.pop_back();
+
+		SVGDisplayGroup& group = list.groups[index];
+
+		if (group.first_op == list.ops.size()) {
+			//No ops, and no groups with ops inside. It is the last group.
+			list.groups.pop_back();
+
+			return;
+		}
+
+		group.end_op = static_cast<uint32_t>(list.ops.size());
+		group.end_group = static_cast<uint32_t>(list.groups.size());
+
+		if (!open_groups.empty()) {
+			add_bounds(list.groups[open_groups.back().group].bounds, group.bounds);
+		}
+	}
+
+	//Closes the groups of the current frame that node is past, and opens the ones it is in
+	void move_to(NodeIndex node) {
+		while (!open_groups.empty() && open_groups.back().depth == frames.size() && node >= open_groups.back().end) {
+			close_group();
+		}
+
+		//The innermost open group of the frame, if any, contains node
+		NodeIndex open = !open_groups.empty() && open_groups.back().depth == frames.size() ? open_groups.back().node : no_index;
+
+		containers.clear();
+
+		for (NodeIndex parent = dom.parent[node]; parent != no_index && parent >= frames.back().first && parent != open; parent = dom.parent[parent]) {
+			containers.push_back(parent);
+		}
+
+		for (auto it = containers.rbegin(); it != containers.rend(); ++it) {
+			open_group(*it, dom.subtree_end[*it]);
+		}
+	}
+
+	void enter(NodeIndex node, const SVGInstance& use) {
+		move_to(node);
+
+		NodeIndex first = dom.kind[use.target] == ElementKind::Symbol ? use.target + 1 : use.target;
+
+		frames.push_back({ use.transform.then(frames.back().transform), first, ++frame_count });
+		open_group(no_index, no_index);
+	}
+
+	void leave() {
+		while (!open_groups.empty() && open_groups.back().depth == frames.size()) {
+			close_group();
+		}
+
+		frames.pop_back();
+	}
+
+	void shape(NodeIndex node, uint32_t geometry) {
+		move_to(node);
+
+		const Frame& frame = frames.back();
+		uint32_t transform = dom.transform_index[node];
+
+		if (list.transforms.empty() || transform != last_transform || frame.id != last_frame) {
+			Matrix node_transform = transform == no_index ? Matrix() : dom.transforms[transform];
+
+			list.transforms.push_back(node_transform.then(frame.transform));
+			last_transform = transform;
+			last_frame = frame.id;
+		}
+
+		const SVGGraphicsElement* element = dom.geometries[geometry];
+		const ComputedStyle* style = dom.styles[dom.geometry_style[geometry]];
+		ElementKind kind = dom.kind[node];
+		Bounds bounds = get_drawn_bounds(*element, kind, *style, list.transforms.back());
+
+		list.ops.push_back({ element, style, static_cast<uint32_t>(list.transforms.size() - 1), geometry, kind, bounds });
+
+		if (!open_groups.empty()) {
+			add_bounds(list.groups[open_groups.back().group].bounds, bounds);
+		}
+	}
+};
+
+void compile_display_list(const SVGDom& dom, SVGDisplayList& list) {
+	list.clear();
+
+	DisplayListCompiler compiler{ dom, list };
+
+	compiler.frames.push_back({ Matrix(), 0, 0 });
+	walk_drawn_nodes(dom, 0, static_cast<NodeIndex>(dom.size()), no_index, compiler);
+
+	while (!compiler.open_groups.empty()) {
+		compiler.close_group();
+	}
+
+	//The list is kept for as long as the image
+	list.ops.shrink_to_fit();
+	list.transforms.shrink_to_fit();
+	list.groups.shrink_to_fit();
+	list.node_count = dom.size();
+
+	if (list.ops.size() >= min_indexed_ops) {
+		std::vector<Bounds> bounds(list.ops.size());
+
+		for (size_t i = 0; i < list.ops.size(); ++i) {
+			bounds[i] = list.ops[i].bounds;
+		}
+
+		list.index.build(bounds.data(), bounds.size());
+	}
+}
+
+void set_display_transform(SVGDisplayList& list, uint32_t transform, const Matrix& matrix) {
+	list.transforms[transform] = matrix;
+
+	//Entries are added in the order of the ops, so the ops of an entry are next to each other
+	auto first_op = std::lower_bound(list.ops.begin(), list.ops.end(), transform, [](const SVGDrawOp& op, uint32_t t) {
+		return op.transform < t;
+	});
+	uint32_t first = static_cast<uint32_t>(first_op - list.ops.begin());
+	uint32_t end = first;
+
+	for (; end < list.ops.size() && list.ops[end].transform == transform; ++end) {
+		SVGDrawOp& op = list.ops[end];
+
+		op.bounds = get_drawn_bounds(*op.element, op.kind, *op.style, matrix);
+	}
+
+	//Each update() refits the nodes above one op. Once more than one op in node_size has
+	//moved, refitting every node once is cheaper.
+	if (!list.index.empty()) {
+		if (end - first > list.index.size() / BoundsTree::node_size) {
+			std::vector<Bounds> bounds(list.ops.size());
+
+			for (size_t i = 0; i < list.ops.size(); ++i) {
+				bounds[i] = list.ops[i].bounds;
+			}
+
+			list.index.refit(bounds.data());
+		}
+		else {
+			for (uint32_t op = first; op < end; ++op) {
+				list.index.update(op, list.ops[op].bounds);
+			}
+		}
+	}
+
+	//Groups that start after the ops don't hold any of them
+	auto end_group = std::lower_bound(list.groups.begin(), list.groups.end(), end, [](const SVGDisplayGroup& group, uint32_t op) {
+		return group.first_op < op;
+	});
+
+	//Groups come after the groups they are in, so going backwards refits the groups inside
+	//a group before it. A group is the union of its groups and of its ops outside of them.
+	for (size_t g = end_group - list.groups.begin(); g-- > 0;) {
+		SVGDisplayGroup& group = list.groups[g];
+
+		if (group.end_op <= first) {
+			continue;
+		}
+
+		Bounds bounds{ INFINITY, INFINITY, -INFINITY, -INFINITY };
+		uint32_t op = group.first_op;
+		uint32_t inner = static_cast<uint32_t>(g + 1);
+
+		while (op < group.end_op) {
+			if (inner < group.end_group && list.groups[inner].first_op == op) {
+				add_bounds(bounds, list.groups[inner].bounds);
+				op = list.groups[inner].end_op;
+				inner = list.groups[inner].end_group;
+			}
+			else {
+				add_bounds(bounds, list.ops[op++].bounds);
+			}
+		}
+
+		group.bounds = bounds;
+	}
+}
+
+uint32_t pick_display_op(const SVGDisplayList& list, float x, float y) {
+	//Text has infinite bounds, so it is left out, or it would hide everything below it
+	if (!list.index.empty()) {
+		std::vector<uint32_t> found;
+		uint32_t top = no_index;
+
+		list.index.query_point(x, y, found);
+
+		for (uint32_t op : found) {
+			if (list.ops[op].kind != ElementKind::Text && (top == no_index || op > top)) {
+				top = op;
+			}
+		}
+
+		return top;
+	}
+
+	Bounds point{ x, y, x, y };
+
+	for (size_t op = list.ops.size(); op-- > 0;) {
+		if (list.ops[op].kind != ElementKind::Text && bounds_intersect(list.ops[op].bounds, point)) {
+			return static_cast<uint32_t>(op);
+		}
+	}
+
+	return no_index;
+}
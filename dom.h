@@ -0,0 +1,347 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory_resource>
+#include <vector>
+#include "atoms.h"
+#include "arena.h"
+#include "bounds_tree.h"
+#include "style.h"
+#include "transform.h"
+
+struct SVGGraphicsElement;
+
+//The type of an element. Loading, asset creation and rendering switch on the kind
+//instead of using virtual calls or RTTI. Elements without an implementation of
+//their own, like <svg> or unsupported elements, are Unknown or Svg and behave
+//like a plain SVGGraphicsElement.
+enum class ElementKind : uint8_t {
+	Unknown,
+	Svg,
+	G,
+	Defs,
+	Use,
+	Symbol,
+	Rect,
+	Circle,
+	Ellipse,
+	Line,
+	Path,
+	Polyline,
+	Polygon,
+	Text,
+	LinearGradient,
+	RadialGradient,
+	Stop,
+};
+
+//True for elements that render themselves
+bool is_shape(ElementKind kind);
+
+//Index of a node in an SVGDom.
+typedef uint32_t NodeIndex;
+
+//Marks a missing node or table entry.
+const uint32_t no_index = UINT32_MAX;
+
+//A <use> element. It draws the subtree it references at its own place, with the
+//styles it passes on, without copying the elements of the subtree.
+struct SVGInstance {
+	//Root of the referenced subtree
+	NodeIndex target;
+	//Moves the nodes of the subtree from where they are defined to the instance.
+	//Applied after the transform of each node.
+	Matrix transform;
+	//Index into style_sets. no_index if the subtree is drawn with its own styles.
+	uint32_t style_set;
+};
+
+//A subtree drawn with styles inherited from a <use> element that differ from the ones
+//it inherits where it is defined. All instances of the subtree that inherit equal
+//styles share the set.
+struct SVGStyleSet {
+	NodeIndex target;
+	//Style the root of the subtree inherits
+	const ComputedStyle* inherited;
+	//Index into style_set_slots of the entry of node target. Node target + k has entry first_slot + k.
+	uint32_t first_slot;
+};
+
+//The element tree of an image flattened into parallel arrays. Node i is described by
+//entry i of every per-node array. Nodes are stored in depth-first document order, so
+//the root is node 0, the subtree of node i is the range [i, subtree_end[i]) and a full
+//traversal is a linear scan instead of a walk over scattered heap nodes.
+//The arrays are in the arena of the document. build_dom() allocates them once, at their final size.
+//A dom that is built while the document is streamed in is reserved up front from an
+//estimate of the node count, since every time an array outgrows it the old block is
+//left behind in the arena.
+struct SVGDom {
+	//Per-node arrays
+	std::pmr::vector<ElementKind> kind;
+	std::pmr::vector<NodeIndex> parent;
+	std::pmr::vector<NodeIndex> first_child;
+	std::pmr::vector<NodeIndex> next_sibling;
+	//One past the last node of the subtree
+	std::pmr::vector<NodeIndex> subtree_end;
+	//Index into transforms. Nodes without a transform of their own share the
+	//entry of their parent. no_index means the node is drawn untransformed.
+	std::pmr::vector<uint32_t> transform_index;
+	//Index into styles
+	std::pmr::vector<uint32_t> style_index;
+	//Index into geometries for nodes that draw something. no_index for containers.
+	std::pmr::vector<uint32_t> geometry_index;
+	//Element with the attributes of the node
+	std::pmr::vector<SVGGraphicsElement*> element;
+	//Index into instances for <use> nodes that reference a subtree. no_index otherwise.
+	std::pmr::vector<uint32_t> instance_index;
+
+	//Tables shared by the nodes
+	//Transforms from node space to the space of the root
+	std::pmr::vector<Matrix> transforms;
+	//Computed styles. A node that inherits everything shares the entry of its parent.
+	std::pmr::vector<const ComputedStyle*> styles;
+	//Shape elements that render themselves. A shape drawn by a style set has one more entry per set.
+	std::pmr::vector<SVGGraphicsElement*> geometries;
+	//Index into styles of the style of each entry of geometries
+	std::pmr::vector<uint32_t> geometry_style;
+	std::pmr::vector<SVGInstance> instances;
+	std::pmr::vector<SVGStyleSet> style_sets;
+	//For the nodes of a style set: the entry in geometries of a shape, or the style set of a
+	//nested <use> node (no_index for its own styles). no_index for other nodes.
+	std::pmr::vector<uint32_t> style_set_slots;
+	//Instances nested deeper than this inside other instances are not drawn. Set from
+	//SVGLimits when the document is parsed.
+	uint32_t max_instance_depth = 64;
+
+	explicit SVGDom(Arena& arena);
+
+	size_t size() const { return kind.size(); }
+	bool empty() const { return kind.empty(); }
+
+	//Makes room for node_count nodes, of which any may be a shape
+	void reserve(size_t node_count);
+
+	//Releases the arrays. Must be called before the arena is cleared.
+	void clear();
+
+	//Entries of style_set_slots for the nodes from first on, when drawn by style_set.
+	//Null if style_set is no_index.
+	const uint32_t* get_style_set_slots(uint32_t style_set, NodeIndex first) const;
+};
+
+//Appends nodes to an SVGDom in document order. A node is opened when the start tag of
+//its element is read and closed after its end tag, so a dom can be built while the
+//document is still being parsed. Closing a node computes its bounding box from the
+//boxes of its children, which are closed by then.
+class SVGDomBuilder {
+public:
+	explicit SVGDomBuilder(SVGDom& dom) : dom(dom) {}
+
+	//Adds element as the last child of the innermost open node, or as the root if
+	//no node is open. The node stays open until close() is called.
+	NodeIndex open(SVGGraphicsElement* element);
+	//Closes the innermost open node.
+	void close();
+	//Adds element together with the element tree below it. The nodes are closed.
+	NodeIndex add_subtree(SVGGraphicsElement* element);
+
+	//Lets the subtrees of the open nodes cover all nodes added so far, so that the
+	//dom can be rendered before the open nodes are closed.
+	void extend_open_nodes();
+	//True if an open node is a shape. Shapes are only complete once closed.
+	bool has_open_shape() const;
+
+	//Makes the <use> node draw the subtree at target, which must be closed. Returns
+	//false if the <use> node is inside the subtree. The subtree is drawn with its own
+	//styles until add_instance_styles() is called.
+	bool add_instance(NodeIndex node, NodeIndex target);
+	//Computes the styles an instance passes on to its subtree. The instances of nested
+	//<use> nodes must have been added.
+	void add_instance_styles(NodeIndex node, StyleContext& style_context);
+	//Removes all instances and style sets, to add them again once every <use> node can
+	//be resolved. The nodes are kept. Shapes that the style sets added to geometries
+	//stay in the array, but no node refers to them any more.
+	void clear_instances();
+
+private:
+	struct OpenNode {
+		NodeIndex node;
+		//Last child added, to link the next one
+		NodeIndex last_child;
+	};
+
+	SVGDom& dom;
+	std::vector<OpenNode> open_nodes;
+	//Style sets of each target, to find one with equal inherited styles
+	std::map<NodeIndex, std::vector<uint32_t>> target_style_sets;
+
+	uint32_t get_style_set(NodeIndex target, const ComputedStyle* inherited, StyleContext& style_context);
+	uint32_t find_style_set(NodeIndex target, const ComputedStyle* inherited, bool may_add, bool& added);
+};
+
+//Flattens the element tree below root into dom and computes the bounding boxes of
+//the elements, children first. Any previous content of dom is released.
+void build_dom(SVGGraphicsElement* root, SVGDom& dom);
+
+//Walks the nodes in [first, end) in the order they are drawn, with style_set like an
+//instance. <defs> and <symbol> subtrees are skipped, and a <use> node is followed by
+//the nodes of the subtree it draws. The walk keeps a stack of its own instead of
+//recursing, so deeply nested <use> elements can't overflow the C++ stack. An instance
+//is skipped if its target is being walked already, which is a reference cycle, or if
+//dom.max_instance_depth instances are.
+//visitor.shape(node, geometry) is called for each node that draws a shape, with its
+//entry in dom.geometries. visitor.enter(node, instance) and visitor.leave() are called
+//before and after the nodes of the instance of <use> node.
+template <typename Visitor>
+void walk_drawn_nodes(const SVGDom& dom, NodeIndex first, NodeIndex end, uint32_t style_set, Visitor& visitor) {
+	struct Frame {
+		//Target of the instance, no_index for the nodes the walk started with
+		NodeIndex target;
+		NodeIndex next;
+		NodeIndex end;
+		//Node that entry 0 of slots is for
+		NodeIndex first;
+		//Null if the nodes are drawn with their own styles
+		const uint32_t* slots;
+	};
+
+	std::vector<Frame> frames;
+
+	frames.push_back({ no_index, first, end, first, dom.get_style_set_slots(style_set, first) });
+
+	while (!frames.empty()) {
+		Frame& frame = frames.back();
+
+		if (frame.next >= frame.end) {
+			frames.pop_back();
+
+			if (!frames.empty()) {
+				visitor.leave();
+			}
+
+			continue;
+		}
+
+		NodeIndex i = frame.next;
+		ElementKind kind = dom.kind[i];
+
+		if (kind == ElementKind::Defs || kind == ElementKind::Symbol) {
+			//Defs tree doesn't render. Symbols are only drawn by <use> elements.
+			frame.next = dom.subtree_end[i];
+
+			continue;
+		}
+
+		frame.next = i + 1;
+
+		uint32_t slot = frame.slots ? frame.slots[i - frame.first] : no_index;
+		uint32_t instance = dom.instance_index[i];
+
+		if (instance != no_index) {
+			const SVGInstance& use = dom.instances[instance];
+			bool is_cycle = false;
+
+			for (const Frame& f : frames) {
+				is_cycle = is_cycle || f.target == use.target;
+			}
+
+			if (!is_cycle && frames.size() <= dom.max_instance_depth) {
+				//The content of a <symbol> is drawn, not the symbol itself
+				NodeIndex nested_first = dom.kind[use.target] == ElementKind::Symbol ? use.target + 1 : use.target;
+				const uint32_t* nested_slots = dom.get_style_set_slots(frame.slots ? slot : use.style_set, nested_first);
+
+				visitor.enter(i, use);
+				frames.push_back({ use.target, nested_first, dom.subtree_end[use.target], nested_first, nested_slots });
+			}
+
+			continue;
+		}
+
+		uint32_t geometry = frame.slots ? slot : dom.geometry_index[i];
+
+		if (geometry != no_index) {
+			visitor.shape(i, geometry);
+		}
+	}
+}
+
+//Finds the entries of dom.geometries that are drawn when the nodes in [first, end) are
+//rendered with style_set, the way SVG::render() walks the dom. Shapes inside <defs> and
+//<symbol> are only drawn through the <use> elements that reference them. Sets drawn[k]
+//for every entry k found, and appends k to found if it was not set before.
+void find_drawn_geometries(const SVGDom& dom, NodeIndex first, NodeIndex end, uint32_t style_set, std::vector<bool>& drawn, std::vector<uint32_t>& found);
+
+//A shape of a display list, with everything needed to draw it looked up in advance
+struct SVGDrawOp {
+	const SVGGraphicsElement* element;
+	//Style the shape is drawn with, which depends on the <use> elements it is drawn by
+	const ComputedStyle* style;
+	//Index into SVGDisplayList::transforms
+	uint32_t transform;
+	//Entry of the shape in dom.geometries. Its assets are the same entry of SVGImage::assets.
+	uint32_t geometry;
+	ElementKind kind;
+	//What the shape covers in the space of the image, stroke included
+	Bounds bounds;
+};
+
+//Ops that come from one subtree of the dom, or from one <use> instance. Groups nest
+//like the subtrees, and are stored in the order they start, so a group is followed by
+//the groups inside it. Rendering skips a group that is outside the clip rect with a
+//single test.
+struct SVGDisplayGroup {
+	//Union of the bounds of the ops
+	Bounds bounds;
+	//The ops are [first_op, end_op)
+	uint32_t first_op;
+	uint32_t end_op;
+	//Index of the first group after the ones inside this group
+	uint32_t end_group;
+};
+
+//The shapes of a document in the order they are drawn, with the <use> instances
+//expanded. Drawing a frame from it is a loop over ops, without walking the dom, so
+//there is no instance stack to keep and no transform to combine.
+struct SVGDisplayList {
+	std::vector<SVGDrawOp> ops;
+	//From the space of a shape to the space of the image. Shapes drawn one after the
+	//other with the same transform share an entry.
+	std::vector<Matrix> transforms;
+	//Groups of ops with at least one op
+	std::vector<SVGDisplayGroup> groups;
+	//Finds the ops that reach a rect or a point by their bounds. Entry i is ops[i]. Only
+	//built for lists of at least min_indexed_ops ops, and empty for smaller ones, where
+	//testing the groups in order is as fast.
+	BoundsTree index;
+	//Size of the dom the list was compiled from. The list is out of date if the dom
+	//has grown since, as it does while a document is streamed in.
+	size_t node_count = 0;
+
+	void clear();
+};
+
+//Display lists with at least this many ops get an index
+const size_t min_indexed_ops = 16384;
+
+//Compiles what SVG::render() draws for dom into list, replacing its content.
+void compile_display_list(const SVGDom& dom, SVGDisplayList& list);
+
+//Replaces entry transform of list.transforms with matrix, to move the shapes drawn with
+//it without compiling the list again. The bounds of those ops, of the groups around them
+//and of the index are refitted. Ops that share an entry are drawn one after the other,
+//so moving a shape found with pick_display_op() looks like this:
+//
+//	uint32_t op = pick_display_op(list, x, y);
+//	uint32_t transform = list.ops[op].transform;
+//	set_display_transform(list, transform, list.transforms[transform].then(Matrix::translation(dx, dy)));
+void set_display_transform(SVGDisplayList& list, uint32_t transform, const Matrix& matrix);
+
+//Returns the index of the topmost op whose bounds hold the point x, y in the space of the
+//image, or no_index if there is none. The bounds hold the whole shape with its stroke,
+//so the point may still be in a gap of the shape. Text is not picked.
+uint32_t pick_display_op(const SVGDisplayList& list, float x, float y);
+
+//What a shape drawn with style covers in the space that transform maps it to, stroke
+//included. Text has no known extent and gets infinite bounds.
+Bounds get_drawn_bounds(const SVGGraphicsElement& element, ElementKind kind, const ComputedStyle& style, const Matrix& transform);
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <type_traits>
+
+#include "defs.h"
+#include "ellipse.h"
+#include "g.h"
+#include "line.h"
+#include "path.h"
+#include "rect.h"
+#include "circle.h"
+#include "text.h"
+#include "use.h"
+#include "symbol.h"
+#include "gradient.h"
+
+//All element types, and the switch that calls the members of the actual type of an element.
+//Include document.h first.
+
+//Casts element to T, keeping it const if it was
+template <typename T, typename Element>
+auto& element_cast(Element& element) {
+	return static_cast<std::conditional_t<std::is_const_v<Element>, const T, T>&>(element);
+}
+
+//Calls visitor with the element cast to the type given by kind, which is the kind of the element.
+//Types that don't declare a member get the default of SVGGraphicsElement.
+template <typename Element, typename Visitor>
+decltype(auto) visit_element(Element& element, ElementKind kind, Visitor&& visitor) {
+	switch (kind) {
+	case ElementKind::G:
+		return visitor(element_cast<SVGGElement>(element));
+	case ElementKind::Defs:
+		return visitor(element_cast<SVGDefsElement>(element));
+	case ElementKind::Use:
+		return visitor(element_cast<SVGUseElement>(element));
+	case ElementKind::Rect:
+		return visitor(element_cast<SVGRectElement>(element));
+	case ElementKind::Circle:
+		return visitor(element_cast<SVGCircleElement>(element));
+	case ElementKind::Ellipse:
+		return visitor(element_cast<SVGEllipseElement>(element));
+	case ElementKind::Line:
+		return visitor(element_cast<SVGLineElement>(element));
+	case ElementKind::Path:
+	case ElementKind::Polyline:
+	case ElementKind::Polygon:
+		return visitor(element_cast<SVGPathElement>(element));
+#ifndef SVGLIB_NO_TEXT
+	case ElementKind::Text:
+		return visitor(element_cast<SVGTextElement>(element));
+#endif
+#ifndef SVGLIB_NO_GRADIENTS
+	case ElementKind::LinearGradient:
+		return visitor(element_cast<SVGLinearGradientElement>(element));
+	case ElementKind::RadialGradient:
+		return visitor(element_cast<SVGRadialGradientElement>(element));
+	case ElementKind::Stop:
+		return visitor(element_cast<SVGStopElement>(element));
+#endif
+	default:
+		return visitor(element);
+	}
+}
+
+template <typename Element, typename Visitor>
+decltype(auto) visit_element(Element& element, Visitor&& visitor) {
+	return visit_element(element, element.kind, visitor);
+}
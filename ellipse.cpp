@@ -1,26 +1,25 @@
-#include "svglib.h"
-#include "ellipse.h"
-
-void SVGEllipseElement::compute_bbox() {
-	bbox.left = points[0] - points[2];
-	bbox.top = points[1] - points[3];
-	bbox.right = points[0] + points[2];
-	bbox.bottom = points[1] + points[3];
-}
-
-//Render SVGEllipseElement
-void SVGEllipseElement::render(const SVGDevice& device) const {
-	if (fill_brush) {
-		device.device_context->FillEllipse(
-			D2D1::Ellipse(D2D1::Point2F(points[0], points[1]), points[2], points[3]),
-			fill_brush
-		);
-	}
-	if (stroke_brush) {
-		device.device_context->DrawEllipse(
-			D2D1::Ellipse(D2D1::Point2F(points[0], points[1]), points[2], points[3]),
-			stroke_brush,
-			stroke_width
-		);
-	}
+#include "document.h"
+#include "ellipse.h"
+
+void SVGEllipseElement::compute_bbox() {
+	bbox.left = points[0] - points[2];
+	bbox.top = points[1] - points[3];
+	bbox.right = points[0] + points[2];
+	bbox.bottom = points[1] + points[3];
+}
+
+bool SVGEllipseElement::to_path_data(PathData& path) const {
+	append_ellipse(path, points[0], points[1], points[2], points[3]);
+
+	return true;
+}
+
+//Render SVGEllipseElement
+void SVGEllipseElement::render(SVGRenderer& renderer, const SVGPaint& paint) const {
+	if (paint.style.fill.type != PaintType::None) {
+		renderer.fill_ellipse(points[0], points[1], points[2], points[3], paint);
+	}
+	if (paint.style.stroke.type != PaintType::None) {
+		renderer.stroke_ellipse(points[0], points[1], points[2], points[3], paint);
+	}
 }
\ No newline at end of file
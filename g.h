@@ -1,5 +1,6 @@
-#pragma once
-
-struct SVGGElement : public SVGGraphicsElement {
-	void create_presentation_assets(const std::vector<std::shared_ptr<SVGGraphicsElement>>& parent_stack, const std::map<std::wstring, std::shared_ptr<SVGGraphicsElement>>& id_map, const SVGDevice& device) override;
-};
+#pragma once
+
+struct SVGGElement : public SVGGraphicsElement {
+	using ArenaOwned = SVGGElement;
+	using SVGGraphicsElement::SVGGraphicsElement;
+};
@@ -1,18 +1,44 @@
-#pragma once
-struct SVGLinearGradientElement : public SVGGraphicsElement
-{
-};
-
-struct SVGRadialGradientElement : public SVGGraphicsElement
-{
-};
-
-struct SVGStopElement : public SVGGraphicsElement
-{
-	float offset = 0.0f;
-
-	void create_presentation_assets(const std::vector<std::shared_ptr<SVGGraphicsElement>>& parent_stack, const std::map<std::wstring, std::shared_ptr<SVGGraphicsElement>>& id_map, const SVGDevice& device) override;
-};
-
-CComPtr<ID2D1LinearGradientBrush> create_linear_gradient_brush(const SVGDevice& device, const std::vector<std::shared_ptr<SVGGraphicsElement>>& parent_stack, const std::map<std::wstring, std::shared_ptr<SVGGraphicsElement>>& id_map, const SVGLinearGradientElement& linear_gradient, const SVGGraphicsElement& element);
-CComPtr<ID2D1RadialGradientBrush> create_radial_gradient_brush(const SVGDevice& device, const std::vector<std::shared_ptr<SVGGraphicsElement>>& parent_stack, const std::map<std::wstring, std::shared_ptr<SVGGraphicsElement>>& id_map, const SVGRadialGradientElement& radial_gradient, const SVGGraphicsElement& element);
+#pragma once
+struct SVGLinearGradientElement : public SVGGraphicsElement
+{
+	using ArenaOwned = SVGLinearGradientElement;
+	using SVGGraphicsElement::SVGGraphicsElement;
+};
+
+struct SVGRadialGradientElement : public SVGGraphicsElement
+{
+	using ArenaOwned = SVGRadialGradientElement;
+	using SVGGraphicsElement::SVGGraphicsElement;
+};
+
+struct SVGStopElement : public SVGGraphicsElement
+{
+	float offset = 0.0f;
+
+	using ArenaOwned = SVGStopElement;
+	using SVGGraphicsElement::SVGGraphicsElement;
+};
+
+struct SVGGradientStop {
+	float offset;
+	//Not premultiplied. stop-opacity is applied to the alpha.
+	StyleColor color;
+};
+
+//A gradient with its attributes looked up through the href chain and mapped to the
+//user space of the element it paints. This is what a backend needs to draw one.
+struct SVGGradientPaint {
+	bool is_radial = false;
+	//Linear gradients run from (x1, y1) to (x2, y2)
+	float x1 = 0.0f, y1 = 0.0f, x2 = 0.0f, y2 = 0.0f;
+	//Radial gradients are an ellipse around (cx, cy). The focal point is at an offset
+	//of (focal_dx, focal_dy) from the center.
+	float cx = 0.0f, cy = 0.0f, rx = 0.0f, ry = 0.0f, focal_dx = 0.0f, focal_dy = 0.0f;
+	//Applied to the positions above. From gradientTransform.
+	Matrix transform;
+	std::vector<SVGGradientStop> stops;
+};
+
+//Resolve the gradient that paints element. Return false if it has no stops.
+bool resolve_linear_gradient(const std::map<std::string_view, SVGGraphicsElement*>& id_map, const LengthContext& lengths, const SVGLinearGradientElement& linear_gradient, const SVGGraphicsElement& element, SVGGradientPaint& paint);
+bool resolve_radial_gradient(const std::map<std::string_view, SVGGraphicsElement*>& id_map, const LengthContext& lengths, const SVGRadialGradientElement& radial_gradient, const SVGGraphicsElement& element, SVGGradientPaint& paint);
@@ -0,0 +1,100 @@
+#include "length.h"
+#include "number.h"
+#include <cmath>
+
+//Scans the number and the unit of a length, without the surrounding white space
+static bool scan_length(std::string_view source, float& number, std::string_view& unit) {
+	const char* p = skip_spaces(source.data(), source.data() + source.length());
+	const char* end = source.data() + source.length();
+
+	while (end > p && is_svg_space(end[-1])) {
+		--end;
+	}
+
+	if (!scan_number(p, end, number)) {
+		return false;
+	}
+
+	unit = std::string_view(p, end - p);
+
+	return true;
+}
+
+bool parse_length(std::string_view source, const LengthContext& context, LengthAxis axis, float& value) {
+	float number;
+	std::string_view unit;
+
+	if (!scan_length(source, number, unit)) {
+		return false;
+	}
+
+	if (unit.empty() || unit == "px") {
+		//User units, nothing to do
+	}
+	else if (unit == "%") {
+		switch (axis) {
+		case LengthAxis::None:
+			number /= 100.0f;
+			break;
+		case LengthAxis::Horizontal:
+			number = number * context.viewport_width / 100.0f;
+			break;
+		case LengthAxis::Vertical:
+			number = number * context.viewport_height / 100.0f;
+			break;
+		case LengthAxis::Diagonal:
+			number = number * std::sqrt((context.viewport_width * context.viewport_width +
+				context.viewport_height * context.viewport_height) / 2.0f) / 100.0f;
+			break;
+		}
+	}
+	else if (unit == "in") {
+		number *= context.dpi; //Inches to pixels
+	}
+	else if (unit == "cm") {
+		number *= context.dpi / 2.54f; //Centimeters to pixels
+	}
+	else if (unit == "mm") {
+		number *= context.dpi / 25.4f; //Millimeters to pixels
+	}
+	else if (unit == "pt") {
+		number *= context.dpi / 72.0f; //Points to pixels
+	}
+	else if (unit == "pc") {
+		number *= context.dpi / 6.0f; //Picas to pixels
+	}
+	else if (unit == "em") {
+		number *= context.font_size;
+	}
+	else if (unit == "ex") {
+		//Height of x is not known without the font. Half an em is the usual approximation.
+		number *= context.font_size / 2.0f;
+	}
+	else {
+		return false; //Unknown unit
+	}
+
+	value = number;
+
+	return true;
+}
+
+bool parse_number_or_percentage(std::string_view source, float& value) {
+	float number;
+	std::string_view unit;
+
+	if (!scan_length(source, number, unit)) {
+		return false;
+	}
+
+	if (unit == "%") {
+		number /= 100.0f;
+	}
+	else if (!unit.empty()) {
+		return false;
+	}
+
+	value = number;
+
+	return true;
+}
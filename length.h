@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+//Values needed to convert lengths to user units (pixels). They are looked up once
+//per document instead of once per length, so parsing a length needs no device.
+struct LengthContext {
+	//Dots per inch used for in, cm, mm, pt and pc
+	float dpi = 96.0f;
+	//Font size used for em and ex
+	float font_size = 12.0f;
+	//Size of the viewport used for percentages
+	float viewport_width = 0.0f;
+	float viewport_height = 0.0f;
+};
+
+//What a percentage is relative to.
+enum class LengthAxis : uint8_t {
+	//Percentages are returned as fractions, so 50% is 0.5.
+	//Used for gradient coordinates and other values that are not lengths.
+	None,
+	//Percentage of the viewport width. Used by x, width, cx, rx etc.
+	Horizontal,
+	//Percentage of the viewport height. Used by y, height, cy, ry etc.
+	Vertical,
+	//Percentage of the normalized diagonal of the viewport, sqrt(w*w + h*h) / sqrt(2).
+	//Used by r and other lengths that are not along an axis.
+	Diagonal
+};
+
+//Parses a length like "10", "2.5mm", "1.2em" or "50%" and converts it to user units.
+//Supported units are px, in, cm, mm, pt, pc, em, ex and %.
+//Surrounding white space is allowed. Returns false if source is not a valid length,
+//in which case value is not changed. Does not allocate or throw.
+bool parse_length(std::string_view source, const LengthContext& context, LengthAxis axis, float& value);
+
+//Parses a plain number or a percentage like "0.5" or "50%". Both give 0.5.
+//Used for opacities and gradient stop offsets.
+bool parse_number_or_percentage(std::string_view source, float& value);
@@ -1,21 +1,21 @@
-#include "svglib.h"
-#include "line.h"
-
-void SVGLineElement::compute_bbox() {
-	bbox.left = points[0] < points[2] ? points[0] : points[2];
-	bbox.top = points[1] < points[3] ? points[1] : points[3];
-	bbox.right = points[0] > points[2] ? points[0] : points[2];
-	bbox.bottom = points[1] > points[3] ? points[1] : points[3];
-}
-
-void SVGLineElement::render(const SVGDevice& device) const {
-	if (stroke_brush) {
-		device.device_context->DrawLine(
-			D2D1::Point2F(points[0], points[1]),
-			D2D1::Point2F(points[2], points[3]),
-			stroke_brush,
-			stroke_width,
-			stroke_style
-		);
-	}
+#include "document.h"
+#include "line.h"
+
+void SVGLineElement::compute_bbox() {
+	bbox.left = points[0] < points[2] ? points[0] : points[2];
+	bbox.top = points[1] < points[3] ? points[1] : points[3];
+	bbox.right = points[0] > points[2] ? points[0] : points[2];
+	bbox.bottom = points[1] > points[3] ? points[1] : points[3];
+}
+
+bool SVGLineElement::to_path_data(PathData& path) const {
+	append_line(path, points[0], points[1], points[2], points[3]);
+
+	return true;
+}
+
+void SVGLineElement::render(SVGRenderer& renderer, const SVGPaint& paint) const {
+	if (paint.style.stroke.type != PaintType::None) {
+		renderer.stroke_line(points[0], points[1], points[2], points[3], paint);
+	}
 }
\ No newline at end of file
@@ -1,6 +1,10 @@
-#pragma once
-
-struct SVGLineElement : public SVGGraphicsElement {
-	void compute_bbox() override;
-	void render(const SVGDevice& device) const override;
-};
+#pragma once
+
+struct SVGLineElement : public SVGGraphicsElement {
+	using ArenaOwned = SVGLineElement;
+	using SVGGraphicsElement::SVGGraphicsElement;
+
+	void compute_bbox();
+	bool to_path_data(PathData& path) const;
+	void render(SVGRenderer& renderer, const SVGPaint& paint) const;
+};
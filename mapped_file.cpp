@@ -0,0 +1,126 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const wchar_t* file_name) {
+	close();
+
+	HANDLE file = ::CreateFileW(file_name, GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	file_handle = file;
+
+	LARGE_INTEGER file_size;
+
+	if (!::GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0) {
+		//Empty files can not be mapped
+		close();
+
+		return false;
+	}
+
+	mapping_handle = ::CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+	if (mapping_handle == NULL) {
+		close();
+
+		return false;
+	}
+
+	data = ::MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+
+	if (data == nullptr) {
+		close();
+
+		return false;
+	}
+
+	size = static_cast<size_t>(file_size.QuadPart);
+
+	return true;
+}
+
+void MappedFile::close() {
+	if (data != nullptr) {
+		::UnmapViewOfFile(data);
+	}
+
+	if (mapping_handle != nullptr) {
+		::CloseHandle(mapping_handle);
+	}
+
+	if (file_handle != nullptr) {
+		::CloseHandle(file_handle);
+	}
+
+	data = nullptr;
+	size = 0;
+	mapping_handle = nullptr;
+	file_handle = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const char* file_name) {
+	close();
+
+	int fd = ::open(file_name, O_RDONLY);
+
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat st;
+
+	if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+		//Empty files can not be mapped
+		::close(fd);
+
+		return false;
+	}
+
+	void* mapping = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+	//The mapping stays valid after the descriptor is closed
+	::close(fd);
+
+	if (mapping == MAP_FAILED) {
+		return false;
+	}
+
+	//The whole file is parsed front to back exactly once
+	::madvise(mapping, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+	data = mapping;
+	size = static_cast<size_t>(st.st_size);
+
+	return true;
+}
+
+void MappedFile::close() {
+	if (data != nullptr) {
+		::munmap(const_cast<void*>(data), size);
+	}
+
+	data = nullptr;
+	size = 0;
+}
+
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+
+//A read-only memory mapping of an entire file. The contents can be parsed
+//straight out of the mapping without copying them into a buffer first.
+//The mapping is released when the object is closed or destroyed.
+struct MappedFile {
+	const void* data = nullptr;
+	size_t size = 0;
+
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile();
+
+	//Maps the file for reading. Returns false if the file can not be opened,
+	//is empty or can not be mapped.
+#ifdef _WIN32
+	bool open(const wchar_t* file_name);
+#else
+	bool open(const char* file_name);
+#endif
+
+	//Releases the mapping. Safe to call more than once.
+	void close();
+
+private:
+#ifdef _WIN32
+	void* file_handle = nullptr;
+	void* mapping_handle = nullptr;
+#endif
+};
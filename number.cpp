@@ -0,0 +1,211 @@
+#include "number.h"
+#include <cstdint>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SVG_USE_SSE2 1
+#endif
+
+//Powers of ten that are exactly representable as a double
+static const double powers_of_ten[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+//At most this many significant digits fit in the 64 bit mantissa
+static const int max_mantissa_digits = 19;
+
+static inline bool is_separator(char ch) {
+	return is_svg_space(ch) || ch == ',';
+}
+
+const char* skip_spaces(const char* p, const char* end) {
+	while (p < end && is_svg_space(*p)) {
+		++p;
+	}
+
+	return p;
+}
+
+const char* skip_separators(const char* p, const char* end) {
+	//Most numbers are separated by a single character. Check that before
+	//paying for a vector load.
+	if (p < end && !is_separator(*p)) {
+		return p;
+	}
+
+#ifdef SVG_USE_SSE2
+	//Pretty printed files often have long runs of indentation and line breaks.
+	//Classify 16 characters at a time.
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i tab = _mm_set1_epi8('\t');
+	const __m128i cr = _mm_set1_epi8('\r');
+	const __m128i lf = _mm_set1_epi8('\n');
+	const __m128i comma = _mm_set1_epi8(',');
+
+	while (end - p >= 16) {
+		__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		__m128i is_sep = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+			_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, cr), _mm_cmpeq_epi8(chunk, lf)),
+				_mm_cmpeq_epi8(chunk, comma)));
+		unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(is_sep));
+
+		if (mask != 0xFFFF) {
+			//Position of the first character that is not a separator
+			unsigned not_sep = ~mask & 0xFFFF;
+			int offset = 0;
+
+			while ((not_sep & 1) == 0) {
+				not_sep >>= 1;
+				++offset;
+			}
+
+			return p + offset;
+		}
+
+		p += 16;
+	}
+#endif
+
+	while (p < end && is_separator(*p)) {
+		++p;
+	}
+
+	return p;
+}
+
+bool scan_number(const char*& p, const char* end, float& value) {
+	const char* s = p;
+	bool negative = false;
+
+	if (s < end && (*s == '+' || *s == '-')) {
+		negative = *s == '-';
+		++s;
+	}
+
+	uint64_t mantissa = 0;
+	int digits = 0;
+	int exponent = 0;
+	bool has_digits = false;
+
+	//Integer part
+	while (s < end && is_digit(*s)) {
+		if (digits < max_mantissa_digits) {
+			mantissa = mantissa * 10 + (*s - '0');
+
+			//Leading zeros are not significant
+			if (mantissa != 0) {
+				++digits;
+			}
+		}
+		else {
+			//Digits that do not fit only scale the value
+			++exponent;
+		}
+
+		has_digits = true;
+		++s;
+	}
+
+	//Fraction part
+	if (s < end && *s == '.') {
+		const char* fraction = s + 1;
+
+		while (fraction < end && is_digit(*fraction)) {
+			if (digits < max_mantissa_digits) {
+				mantissa = mantissa * 10 + (*fraction - '0');
+				--exponent;
+
+				if (mantissa != 0) {
+					++digits;
+				}
+			}
+
+			has_digits = true;
+			++fraction;
+		}
+
+		//A lone "." after digits like "5." is allowed. A second "." starts a new number.
+		if (has_digits) {
+			s = fraction;
+		}
+	}
+
+	if (!has_digits) {
+		return false;
+	}
+
+	//Exponent part. Only taken if at least one digit follows.
+	if (s < end && (*s == 'e' || *s == 'E')) {
+		const char* e = s + 1;
+		bool exp_negative = false;
+
+		if (e < end && (*e == '+' || *e == '-')) {
+			exp_negative = *e == '-';
+			++e;
+		}
+
+		if (e < end && is_digit(*e)) {
+			int exp_value = 0;
+
+			while (e < end && is_digit(*e)) {
+				//Clamp to avoid overflow. Such values are out of range anyway.
+				if (exp_value < 10000) {
+					exp_value = exp_value * 10 + (*e - '0');
+				}
+
+				++e;
+			}
+
+			exponent += exp_negative ? -exp_value : exp_value;
+			s = e;
+		}
+	}
+
+	double result = static_cast<double>(mantissa);
+
+	if (mantissa != 0 && exponent != 0) {
+		if (exponent > 0 && exponent <= 22) {
+			result *= powers_of_ten[exponent];
+		}
+		else if (exponent < 0 && exponent >= -22) {
+			result /= powers_of_ten[-exponent];
+		}
+		else {
+			result *= std::pow(10.0, exponent);
+		}
+	}
+
+	float f = static_cast<float>(negative ? -result : result);
+
+	if (std::isinf(f)) {
+		//Overflow
+		return false;
+	}
+
+	value = f;
+	p = s;
+
+	return true;
+}
+
+bool scan_next_number(const char*& p, const char* end, float& value) {
+	p = skip_separators(p, end);
+
+	return scan_number(p, end, value);
+}
+
+bool scan_next_flag(const char*& p, const char* end, bool& flag) {
+	p = skip_separators(p, end);
+
+	if (p < end && (*p == '0' || *p == '1')) {
+		flag = *p == '1';
+		++p;
+
+		return true;
+	}
+
+	return false;
+}
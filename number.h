@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+
+//Scanners for the number grammar used by SVG path data, point lists and
+//other attribute values. They work on a [p, end) range, never read past end
+//and do not allocate, throw or depend on the C locale.
+
+inline bool is_svg_space(char ch) {
+	return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+}
+
+inline bool is_digit(char ch) {
+	return ch >= '0' && ch <= '9';
+}
+
+//Skips white spaces only. Returns the first non white space position.
+const char* skip_spaces(const char* p, const char* end);
+
+//Skips any run of white spaces and commas that separate numbers.
+//Returns the first position that is neither.
+const char* skip_separators(const char* p, const char* end);
+
+//Scans a number like "10", "-1.5", ".5" or "2e-3" at p. No leading separators
+//are skipped. Numbers may directly follow each other without a separator, so
+//"-1-2" is scanned as -1 and then -2, and ".5.5" as 0.5 and then 0.5.
+//An "e" is only treated as an exponent if digits follow, so "1em" stops before "em".
+//Returns false if there is no number at p or if it overflows a float.
+//On success advances p past the number.
+bool scan_number(const char*& p, const char* end, float& value);
+
+//Skips separators and then scans a number.
+bool scan_next_number(const char*& p, const char* end, float& value);
+
+//Skips separators and then scans a single "0" or "1" flag as used by arc
+//commands. Flags need no separator, so "a1 1 0 00 10 10" has both flags as 0.
+bool scan_next_flag(const char*& p, const char* end, bool& flag);
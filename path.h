@@ -1,13 +1,13 @@
-#pragma once
-
-struct SVGPathElement : public SVGGraphicsElement {
-	CComPtr<ID2D1PathGeometry> path_geometry;
-
-	SVGPathElement() = default;
-	SVGPathElement(const SVGPathElement& that);
-
-	void build_path(ID2D1Factory* d2d_factory, const std::wstring_view& pathData);
-	void compute_bbox() override;
-	void render(const SVGDevice& device) const override;
-	std::shared_ptr<SVGGraphicsElement> clone() const override;
-};
+#pragma once
+
+//Represents <path>, <polyline> and <polygon> elements.
+struct SVGPathElement : public SVGGraphicsElement {
+	PathData path_data;
+
+	using ArenaOwned = SVGPathElement;
+	explicit SVGPathElement(Arena& arena);
+
+	bool to_path_data(PathData& path) const;
+	void compute_bbox();
+	void render(SVGRenderer& renderer, const SVGPaint& paint) const;
+};
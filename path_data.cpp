@@ -0,0 +1,603 @@
+#include "path_data.h"
+#include "number.h"
+#include <cmath>
+
+//Distance of the control points from the end points when a quarter
+//ellipse is approximated with a cubic Bezier: 4/3 * (sqrt(2) - 1)
+static const float arc_kappa = 0.5522847498f;
+
+void PathData::clear() {
+	verbs.clear();
+	coords.clear();
+}
+
+void PathData::move_to(float x, float y) {
+	verbs.push_back(PathVerb::MoveTo);
+	coords.insert(coords.end(), { x, y });
+}
+
+void PathData::line_to(float x, float y) {
+	verbs.push_back(PathVerb::LineTo);
+	coords.insert(coords.end(), { x, y });
+}
+
+void PathData::quad_to(float x1, float y1, float x, float y) {
+	verbs.push_back(PathVerb::QuadTo);
+	coords.insert(coords.end(), { x1, y1, x, y });
+}
+
+void PathData::cubic_to(float x1, float y1, float x2, float y2, float x, float y) {
+	verbs.push_back(PathVerb::CubicTo);
+	coords.insert(coords.end(), { x1, y1, x2, y2, x, y });
+}
+
+void PathData::arc_to(float rx, float ry, float x_axis_rotation, bool large_arc, bool sweep, float x, float y) {
+	verbs.push_back(PathVerb::ArcTo);
+	coords.insert(coords.end(), { rx, ry, x_axis_rotation, large_arc ? 1.0f : 0.0f, sweep ? 1.0f : 0.0f, x, y });
+}
+
+void PathData::close() {
+	verbs.push_back(PathVerb::Close);
+}
+
+static bool is_path_command(char ch) {
+	switch (ch) {
+	case 'M': case 'm': case 'L': case 'l': case 'H': case 'h': case 'V': case 'v':
+	case 'Q': case 'q': case 'T': case 't': case 'C': case 'c': case 'S': case 's':
+	case 'A': case 'a': case 'Z': case 'z':
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool parse_path_data(std::string_view d, PathData& path) {
+	path.clear();
+
+	//SVG spec is very leinent on path syntax. White spaces are
+	//entirely optional. Numbers can either be separated by comma or spaces.
+	const char* p = d.data();
+	const char* end = p + d.length();
+	char cmd = 0, last_cmd = 0;
+	bool is_in_figure = false;
+	float current_x = 0.0f, current_y = 0.0f;
+	float start_x = 0.0f, start_y = 0.0f;
+	float last_ctrl_x = 0.0f, last_ctrl_y = 0.0f;
+
+	while (true) {
+		p = skip_spaces(p, end);
+
+		if (p == end) {
+			return true;
+		}
+
+		if (is_path_command(*p)) {
+			cmd = *p++;
+
+			if (last_cmd == 0 && cmd != 'M' && cmd != 'm') {
+				//Path data must start with a moveto. There is nothing to render otherwise.
+				return false;
+			}
+		}
+		else if (last_cmd == 0 || last_cmd == 'Z' || last_cmd == 'z') {
+			//Numbers must follow a command that takes them
+			return false;
+		}
+		else if (last_cmd == 'M') {
+			//As per the SVG spec subsequent moveto pairs are treated as lineto commands
+			cmd = 'L';
+		}
+		else if (last_cmd == 'm') {
+			cmd = 'l';
+		}
+		else {
+			//Continue with the last command
+			cmd = last_cmd;
+		}
+
+		bool relative = cmd >= 'a' && cmd <= 'z';
+		float base_x = relative ? current_x : 0.0f;
+		float base_y = relative ? current_y : 0.0f;
+
+		if (cmd != 'M' && cmd != 'm' && cmd != 'Z' && cmd != 'z' && !is_in_figure) {
+			//Drawing after a closepath starts a new figure at the current point
+			path.move_to(current_x, current_y);
+			start_x = current_x;
+			start_y = current_y;
+			is_in_figure = true;
+		}
+
+		switch (cmd) {
+		case 'M':
+		case 'm': {
+			float x, y;
+
+			if (!scan_next_number(p, end, x) || !scan_next_number(p, end, y)) {
+				return false;
+			}
+
+			current_x = start_x = base_x + x;
+			current_y = start_y = base_y + y;
+
+			path.move_to(current_x, current_y);
+			is_in_figure = true;
+
+			break;
+		}
+		case 'L':
+		case 'l': {
+			float x, y;
+
+			if (!scan_next_number(p, end, x) || !scan_next_number(p, end, y)) {
+				return false;
+			}
+
+			current_x = base_x + x;
+			current_y = base_y + y;
+
+			path.line_to(current_x, current_y);
+
+			break;
+		}
+		case 'H':
+		case 'h': {
+			float x;
+
+			if (!scan_next_number(p, end, x)) {
+				return false;
+			}
+
+			current_x = base_x + x;
+
+			path.line_to(current_x, current_y);
+
+			break;
+		}
+		case 'V':
+		case 'v': {
+			float y;
+
+			if (!scan_next_number(p, end, y)) {
+				return false;
+			}
+
+			current_y = base_y + y;
+
+			path.line_to(current_x, current_y);
+
+			break;
+		}
+		case 'Q':
+		case 'q': {
+			float x1, y1, x, y;
+
+			if (!scan_next_number(p, end, x1) || !scan_next_number(p, end, y1) ||
+				!scan_next_number(p, end, x) || !scan_next_number(p, end, y)) {
+				return false;
+			}
+
+			last_ctrl_x = base_x + x1;
+			last_ctrl_y = base_y + y1;
+			current_x = base_x + x;
+			current_y = base_y + y;
+
+			path.quad_to(last_ctrl_x, last_ctrl_y, current_x, current_y);
+
+			break;
+		}
+		case 'T':
+		case 't': {
+			float x, y;
+
+			if (!scan_next_number(p, end, x) || !scan_next_number(p, end, y)) {
+				return false;
+			}
+
+			//Calculate the control point by reflecting the last control point
+			if (last_cmd == 'Q' || last_cmd == 'T' || last_cmd == 'q' || last_cmd == 't') {
+				last_ctrl_x = 2 * current_x - last_ctrl_x;
+				last_ctrl_y = 2 * current_y - last_ctrl_y;
+			}
+			else {
+				last_ctrl_x = current_x;
+				last_ctrl_y = current_y;
+			}
+
+			current_x = base_x + x;
+			current_y = base_y + y;
+
+			path.quad_to(last_ctrl_x, last_ctrl_y, current_x, current_y);
+
+			break;
+		}
+		case 'C':
+		case 'c': {
+			float x1, y1, x2, y2, x, y;
+
+			if (!scan_next_number(p, end, x1) || !scan_next_number(p, end, y1) ||
+				!scan_next_number(p, end, x2) || !scan_next_number(p, end, y2) ||
+				!scan_next_number(p, end, x) || !scan_next_number(p, end, y)) {
+				return false;
+			}
+
+			last_ctrl_x = base_x + x2;
+			last_ctrl_y = base_y + y2;
+			current_x = base_x + x;
+			current_y = base_y + y;
+
+			path.cubic_to(base_x + x1, base_y + y1, last_ctrl_x, last_ctrl_y, current_x, current_y);
+
+			break;
+		}
+		case 'S':
+		case 's': {
+			float x2, y2, x, y;
+			float x1 = current_x, y1 = current_y;
+
+			if (!scan_next_number(p, end, x2) || !scan_next_number(p, end, y2) ||
+				!scan_next_number(p, end, x) || !scan_next_number(p, end, y)) {
+				return false;
+			}
+
+			//Calculate the first control point by reflecting the last control point
+			if (last_cmd == 'C' || last_cmd == 'S' || last_cmd == 'c' || last_cmd == 's') {
+				x1 = 2 * current_x - last_ctrl_x;
+				y1 = 2 * current_y - last_ctrl_y;
+			}
+
+			last_ctrl_x = base_x + x2;
+			last_ctrl_y = base_y + y2;
+			current_x = base_x + x;
+			current_y = base_y + y;
+
+			path.cubic_to(x1, y1, last_ctrl_x, last_ctrl_y, current_x, current_y);
+
+			break;
+		}
+		case 'A':
+		case 'a': {
+			float rx, ry, x_axis_rotation, x, y;
+			bool large_arc = false, sweep = false;
+
+			if (!scan_next_number(p, end, rx) || !scan_next_number(p, end, ry) ||
+				!scan_next_number(p, end, x_axis_rotation) ||
+				!scan_next_flag(p, end, large_arc) || !scan_next_flag(p, end, sweep) ||
+				!scan_next_number(p, end, x) || !scan_next_number(p, end, y)) {
+				return false;
+			}
+
+			current_x = base_x + x;
+			current_y = base_y + y;
+
+			path.arc_to(rx, ry, x_axis_rotation, large_arc, sweep, current_x, current_y);
+
+			break;
+		}
+		case 'Z':
+		case 'z':
+			//Close the current figure. The current point goes back to its start.
+			if (is_in_figure) {
+				path.close();
+				is_in_figure = false;
+			}
+
+			current_x = start_x;
+			current_y = start_y;
+
+			break;
+		}
+
+		last_cmd = cmd;
+	}
+}
+
+bool parse_points(std::string_view points, bool closed, PathData& path) {
+	path.clear();
+
+	const char* p = points.data();
+	const char* end = p + points.length();
+	bool valid = true;
+	float x, y;
+
+	while (true) {
+		if (!scan_next_number(p, end, x)) {
+			//Anything other than trailing separators is an error
+			valid = skip_separators(p, end) == end;
+
+			break;
+		}
+
+		if (!scan_next_number(p, end, y)) {
+			//Odd number of coordinates
+			valid = false;
+
+			break;
+		}
+
+		if (path.empty()) {
+			path.move_to(x, y);
+		}
+		else {
+			path.line_to(x, y);
+		}
+	}
+
+	if (closed && !path.empty()) {
+		path.close();
+	}
+
+	return valid;
+}
+
+//Appends a quarter of an ellipse from (x0, y0) to (x1, y1). The tangent at the
+//start is along dx0, dy0 and the one at the end is along dx1, dy1.
+static void append_quarter_arc(PathData& path, float x0, float y0, float dx0, float dy0, float x1, float y1, float dx1, float dy1) {
+	path.cubic_to(
+		x0 + dx0 * arc_kappa, y0 + dy0 * arc_kappa,
+		x1 - dx1 * arc_kappa, y1 - dy1 * arc_kappa,
+		x1, y1);
+}
+
+void append_rect(PathData& path, float x, float y, float width, float height, float rx, float ry) {
+	//Radii are clamped to half the size as per the SVG spec
+	rx = rx < 0.0f ? 0.0f : (rx > width / 2 ? width / 2 : rx);
+	ry = ry < 0.0f ? 0.0f : (ry > height / 2 ? height / 2 : ry);
+
+	if (rx == 0.0f || ry == 0.0f) {
+		path.move_to(x, y);
+		path.line_to(x + width, y);
+		path.line_to(x + width, y + height);
+		path.line_to(x, y + height);
+		path.close();
+
+		return;
+	}
+
+	float right = x + width, bottom = y + height;
+
+	path.move_to(x + rx, y);
+	path.line_to(right - rx, y);
+	append_quarter_arc(path, right - rx, y, rx, 0.0f, right, y + ry, 0.0f, ry);
+	path.line_to(right, bottom - ry);
+	append_quarter_arc(path, right, bottom - ry, 0.0f, ry, right - rx, bottom, -rx, 0.0f);
+	path.line_to(x + rx, bottom);
+	append_quarter_arc(path, x + rx, bottom, -rx, 0.0f, x, bottom - ry, 0.0f, -ry);
+	path.line_to(x, y + ry);
+	append_quarter_arc(path, x, y + ry, 0.0f, -ry, x + rx, y, rx, 0.0f);
+	path.close();
+}
+
+void append_ellipse(PathData& path, float cx, float cy, float rx, float ry) {
+	path.move_to(cx + rx, cy);
+	append_quarter_arc(path, cx + rx, cy, 0.0f, ry, cx, cy + ry, -rx, 0.0f);
+	append_quarter_arc(path, cx, cy + ry, -rx, 0.0f, cx - rx, cy, 0.0f, -ry);
+	append_quarter_arc(path, cx - rx, cy, 0.0f, -ry, cx, cy - ry, rx, 0.0f);
+	append_quarter_arc(path, cx, cy - ry, rx, 0.0f, cx + rx, cy, 0.0f, ry);
+	path.close();
+}
+
+void append_line(PathData& path, float x1, float y1, float x2, float y2) {
+	path.move_to(x1, y1);
+	path.line_to(x2, y2);
+}
+
+//Grows bounds to include a point
+static void add_point(PathBounds& bounds, float x, float y) {
+	bounds.left = x < bounds.left ? x : bounds.left;
+	bounds.top = y < bounds.top ? y : bounds.top;
+	bounds.right = x > bounds.right ? x : bounds.right;
+	bounds.bottom = y > bounds.bottom ? y : bounds.bottom;
+}
+
+//Finds the roots in (0, 1) of a*t^2 + b*t + c. Returns how many were found.
+static int solve_unit_quadratic(float a, float b, float c, float roots[2]) {
+	int count = 0;
+
+	if (std::fabs(a) < 1e-12f) {
+		if (b != 0.0f) {
+			roots[count++] = -c / b;
+		}
+	}
+	else {
+		float d = b * b - 4.0f * a * c;
+
+		if (d >= 0.0f) {
+			float s = std::sqrt(d);
+
+			roots[count++] = (-b + s) / (2.0f * a);
+			roots[count++] = (-b - s) / (2.0f * a);
+		}
+	}
+
+	int kept = 0;
+
+	for (int i = 0; i < count; ++i) {
+		if (roots[i] > 0.0f && roots[i] < 1.0f) {
+			roots[kept++] = roots[i];
+		}
+	}
+
+	return kept;
+}
+
+static void add_quad(PathBounds& bounds, float x0, float y0, const float* c) {
+	float p0[2] = { x0, y0 };
+
+	for (int axis = 0; axis < 2; ++axis) {
+		float a = p0[axis], b = c[axis], e = c[2 + axis];
+		float denominator = a - 2.0f * b + e;
+
+		if (denominator != 0.0f) {
+			float t = (a - b) / denominator;
+
+			if (t > 0.0f && t < 1.0f) {
+				float u = 1.0f - t;
+
+				add_point(bounds,
+					u * u * x0 + 2.0f * u * t * c[0] + t * t * c[2],
+					u * u * y0 + 2.0f * u * t * c[1] + t * t * c[3]);
+			}
+		}
+	}
+
+	add_point(bounds, c[2], c[3]);
+}
+
+static void add_cubic(PathBounds& bounds, float x0, float y0, const float* c) {
+	float p0[2] = { x0, y0 };
+
+	for (int axis = 0; axis < 2; ++axis) {
+		float a = p0[axis], b = c[axis], d = c[2 + axis], e = c[4 + axis];
+		float roots[2];
+		//Derivative of the curve divided by 3
+		int count = solve_unit_quadratic(-a + 3.0f * b - 3.0f * d + e, 2.0f * (a - 2.0f * b + d), b - a, roots);
+
+		for (int i = 0; i < count; ++i) {
+			float t = roots[i], u = 1.0f - t;
+			float w0 = u * u * u, w1 = 3.0f * u * u * t, w2 = 3.0f * u * t * t, w3 = t * t * t;
+
+			add_point(bounds,
+				w0 * x0 + w1 * c[0] + w2 * c[2] + w3 * c[4],
+				w0 * y0 + w1 * c[1] + w2 * c[3] + w3 * c[5]);
+		}
+	}
+
+	add_point(bounds, c[4], c[5]);
+}
+
+bool get_arc_center(float x1, float y1, const float* c, ArcCenter& arc) {
+	const double pi = 3.14159265358979323846;
+	double rx = std::fabs(c[0]), ry = std::fabs(c[1]);
+	double phi = c[2] * pi / 180.0;
+	bool large_arc = c[3] != 0.0f, sweep = c[4] != 0.0f;
+	double x2 = c[5], y2 = c[6];
+
+	if (rx == 0.0 || ry == 0.0 || (x1 == x2 && y1 == y2)) {
+		//A straight line, or nothing at all
+		return false;
+	}
+
+	double cos_phi = std::cos(phi), sin_phi = std::sin(phi);
+	double dx = (x1 - x2) / 2.0, dy = (y1 - y2) / 2.0;
+	double x1p = cos_phi * dx + sin_phi * dy;
+	double y1p = -sin_phi * dx + cos_phi * dy;
+	double lambda = (x1p * x1p) / (rx * rx) + (y1p * y1p) / (ry * ry);
+
+	if (lambda > 1.0) {
+		//Radii too small to reach the end point are scaled up
+		rx *= std::sqrt(lambda);
+		ry *= std::sqrt(lambda);
+	}
+
+	double numerator = rx * rx * ry * ry - rx * rx * y1p * y1p - ry * ry * x1p * x1p;
+	double denominator = rx * rx * y1p * y1p + ry * ry * x1p * x1p;
+	double coefficient = std::sqrt(numerator > 0.0 ? numerator / denominator : 0.0);
+
+	if (large_arc == sweep) {
+		coefficient = -coefficient;
+	}
+
+	double cxp = coefficient * rx * y1p / ry;
+	double cyp = -coefficient * ry * x1p / rx;
+
+	arc.cx = cos_phi * cxp - sin_phi * cyp + (x1 + x2) / 2.0;
+	arc.cy = sin_phi * cxp + cos_phi * cyp + (y1 + y2) / 2.0;
+	arc.rx = rx;
+	arc.ry = ry;
+	arc.phi = phi;
+	arc.start = std::atan2((y1p - cyp) / ry, (x1p - cxp) / rx);
+
+	double end = std::atan2((-y1p - cyp) / ry, (-x1p - cxp) / rx);
+
+	arc.delta = end - arc.start;
+
+	if (sweep && arc.delta < 0.0) {
+		arc.delta += 2.0 * pi;
+	}
+	else if (!sweep && arc.delta > 0.0) {
+		arc.delta -= 2.0 * pi;
+	}
+
+	return true;
+}
+
+//Adds an elliptical arc. The arc is converted to center form, then the angles where
+//it is furthest along x and y are checked against its sweep.
+static void add_arc(PathBounds& bounds, float x1, float y1, const float* c) {
+	const double pi = 3.14159265358979323846;
+	ArcCenter arc;
+
+	add_point(bounds, c[5], c[6]);
+
+	if (!get_arc_center(x1, y1, c, arc)) {
+		return;
+	}
+
+	double cos_phi = std::cos(arc.phi), sin_phi = std::sin(arc.phi);
+	//Angles where the ellipse reaches its extremes along x and along y
+	double theta_x = std::atan2(-arc.ry * sin_phi, arc.rx * cos_phi);
+	double theta_y = std::atan2(arc.ry * cos_phi, arc.rx * sin_phi);
+	double candidates[4] = { theta_x, theta_x + pi, theta_y, theta_y + pi };
+
+	for (double theta : candidates) {
+		//Distance from the start angle in the direction of the sweep
+		double distance = std::fmod(arc.delta > 0.0 ? theta - arc.start : arc.start - theta, 2.0 * pi);
+
+		if (distance < 0.0) {
+			distance += 2.0 * pi;
+		}
+
+		if (distance <= std::fabs(arc.delta)) {
+			add_point(bounds,
+				static_cast<float>(arc.cx + arc.rx * cos_phi * std::cos(theta) - arc.ry * sin_phi * std::sin(theta)),
+				static_cast<float>(arc.cy + arc.rx * sin_phi * std::cos(theta) + arc.ry * cos_phi * std::sin(theta)));
+		}
+	}
+}
+
+bool get_path_bounds(const PathData& path, PathBounds& bounds) {
+	if (path.verbs.empty()) {
+		return false;
+	}
+
+	const float* c = path.coords.data();
+	float x = 0.0f, y = 0.0f;
+
+	//Paths always start with a MoveTo
+	bounds = { c[0], c[1], c[0], c[1] };
+
+	for (PathVerb verb : path.verbs) {
+		int size = path_verb_size(verb);
+
+		switch (verb) {
+		case PathVerb::MoveTo:
+		case PathVerb::LineTo:
+			add_point(bounds, c[0], c[1]);
+
+			break;
+		case PathVerb::QuadTo:
+			add_quad(bounds, x, y, c);
+
+			break;
+		case PathVerb::CubicTo:
+			add_cubic(bounds, x, y, c);
+
+			break;
+		case PathVerb::ArcTo:
+			add_arc(bounds, x, y, c);
+
+			break;
+		case PathVerb::Close:
+			break;
+		}
+
+		if (size > 0) {
+			x = c[size - 2];
+			y = c[size - 1];
+		}
+
+		c += size;
+	}
+
+	return true;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+//Drawing commands of a PathData. Every command is in absolute coordinates.
+//Relative commands are resolved, H and V become LineTo and the smooth
+//S and T commands become CubicTo and QuadTo with explicit control points.
+enum class PathVerb : uint8_t {
+	MoveTo,		//x, y
+	LineTo,		//x, y
+	QuadTo,		//x1, y1, x, y
+	CubicTo,	//x1, y1, x2, y2, x, y
+	ArcTo,		//rx, ry, x_axis_rotation, large_arc_flag, sweep_flag, x, y
+	Close		//No coordinates
+};
+
+//Number of coordinates stored for a verb.
+inline int path_verb_size(PathVerb verb) {
+	static const int sizes[] = { 2, 2, 4, 6, 7, 0 };
+
+	return sizes[static_cast<int>(verb)];
+}
+
+//A compact, device independent representation of a path. The verbs and their
+//coordinates are kept in two separate arrays. Every figure starts with a MoveTo.
+//The path of an element lives in the arena of its document. Paths used as
+//scratch space are created with the default constructor and use the heap.
+struct PathData {
+	std::pmr::vector<PathVerb> verbs;
+	std::pmr::vector<float> coords;
+
+	PathData() = default;
+	explicit PathData(std::pmr::memory_resource* resource) : verbs(resource), coords(resource) {}
+	PathData(const PathData& that, std::pmr::memory_resource* resource) : verbs(that.verbs, resource), coords(that.coords, resource) {}
+
+	bool empty() const { return verbs.empty(); }
+	void clear();
+
+	void move_to(float x, float y);
+	void line_to(float x, float y);
+	void quad_to(float x1, float y1, float x, float y);
+	void cubic_to(float x1, float y1, float x2, float y2, float x, float y);
+	void arc_to(float rx, float ry, float x_axis_rotation, bool large_arc, bool sweep, float x, float y);
+	void close();
+};
+
+//Parses the "d" attribute of a <path>. Parsing stops at the first error as
+//required by the SVG spec. Everything before the error is kept in path and
+//false is returned.
+bool parse_path_data(std::string_view d, PathData& path);
+
+//Parses the "points" attribute of <polyline> and <polygon>. A polygon is closed.
+//Returns false if the list was malformed, in which case the valid points
+//before the error are kept.
+bool parse_points(std::string_view points, bool closed, PathData& path);
+
+//Basic shapes as paths, for consumers that only understand paths.
+//Curves are approximated by cubic Bezier segments.
+void append_rect(PathData& path, float x, float y, float width, float height, float rx = 0.0f, float ry = 0.0f);
+void append_ellipse(PathData& path, float cx, float cy, float rx, float ry);
+void append_line(PathData& path, float x1, float y1, float x2, float y2);
+
+//An elliptical arc in center form.
+struct ArcCenter {
+	double cx, cy, rx, ry;
+	//Rotation of the x axis of the ellipse, in radians
+	double phi;
+	//Angle of the start point and the signed sweep to the end point, in radians.
+	//Point t of the arc is the point on the ellipse at angle start + t * delta.
+	double start, delta;
+};
+
+//Converts the arc of an ArcTo command starting at (x1, y1) to center form, as described
+//in the implementation notes of the SVG spec. c points to the coordinates of the command.
+//Radii too small to reach the end point are scaled up. Returns false if the arc is a
+//straight line to its end point, or empty.
+bool get_arc_center(float x1, float y1, const float* c, ArcCenter& arc);
+
+//Axis aligned bounds of a path.
+struct PathBounds {
+	float left, top, right, bottom;
+};
+
+//Computes the tight bounds of a path. Curves and arcs are bounded by their
+//extreme points, not by their control points. Returns false for an empty path.
+bool get_path_bounds(const PathData& path, PathBounds& bounds);
@@ -0,0 +1,893 @@
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include "document.h"
+#include "path.h"
+#include "gradient.h"
+#include "raster_renderer.h"
+
+//Curves are replaced by lines that are at most this far from them, in pixels
+static const float flatness = 0.2f;
+//Curves and circles are split into at most this many lines
+static const int max_curve_lines = 512;
+//Rows of the target that are covered at once. Bounds the size of the cell buffer.
+static const int band_height = 64;
+
+static float clamp_unit(float value) {
+	return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+}
+
+//Largest factor by which matrix stretches a length
+static float get_scale(const Matrix& m) {
+	float p = (m.a * m.a + m.b * m.b + m.c * m.c + m.d * m.d) / 2.0f;
+	float q = (m.a * m.a + m.b * m.b - m.c * m.c - m.d * m.d) / 2.0f;
+	float r = m.a * m.c + m.b * m.d;
+
+	return std::sqrt(p + std::sqrt(q * q + r * r));
+}
+
+//Number of lines a curve is split into, from the bound on the distance between the
+//curve and its lines when the parameter is split evenly: bound / n^2
+static int get_curve_lines(float bound, float tolerance) {
+	float n = std::ceil(std::sqrt(bound / tolerance));
+
+	return n < 1.0f ? 1 : (n > max_curve_lines ? max_curve_lines : static_cast<int>(n));
+}
+
+//Number of lines an arc of a circle is split into
+static int get_arc_lines(double sweep, double radius, float tolerance) {
+	if (radius <= tolerance) {
+		return 4;
+	}
+
+	double n = std::ceil(std::fabs(sweep) / (2.0 * std::acos(1.0 - tolerance / radius)));
+
+	return n < 1.0 ? 1 : (n > max_curve_lines ? max_curve_lines : static_cast<int>(n));
+}
+
+static uint32_t div255(uint32_t x) {
+	x += 128;
+
+	return (x + (x >> 8)) >> 8;
+}
+
+//Draws color, premultiplied, over a pixel with coverage from 1 to 255
+static void blend_pixel(uint8_t* pixel, const uint8_t* color, uint32_t coverage) {
+	if (coverage == 255 && color[3] == 255) {
+		std::memcpy(pixel, color, 4);
+
+		return;
+	}
+
+	uint32_t alpha = div255(color[3] * coverage);
+	uint32_t rest = 255 - alpha;
+
+	pixel[0] = static_cast<uint8_t>(div255(color[0] * coverage) + div255(pixel[0] * rest));
+	pixel[1] = static_cast<uint8_t>(div255(color[1] * coverage) + div255(pixel[1] * rest));
+	pixel[2] = static_cast<uint8_t>(div255(color[2] * coverage) + div255(pixel[2] * rest));
+	pixel[3] = static_cast<uint8_t>(alpha + div255(pixel[3] * rest));
+}
+
+static void premultiply(float red, float green, float blue, float alpha, uint8_t* color) {
+	alpha = clamp_unit(alpha);
+	color[0] = static_cast<uint8_t>(clamp_unit(red) * alpha * 255.0f + 0.5f);
+	color[1] = static_cast<uint8_t>(clamp_unit(green) * alpha * 255.0f + 0.5f);
+	color[2] = static_cast<uint8_t>(clamp_unit(blue) * alpha * 255.0f + 0.5f);
+	color[3] = static_cast<uint8_t>(alpha * 255.0f + 0.5f);
+}
+
+//Coverage from 0 to 255 of a pixel with the accumulated winding
+static uint32_t get_coverage(float winding, FillRule fill_rule) {
+	float coverage = std::fabs(winding);
+
+	if (fill_rule == FillRule::EvenOdd) {
+		coverage -= 2.0f * std::floor(coverage / 2.0f);
+		coverage = coverage > 1.0f ? 2.0f - coverage : coverage;
+	}
+	else if (coverage > 1.0f) {
+		coverage = 1.0f;
+	}
+
+	return static_cast<uint32_t>(coverage * 255.0f + 0.5f);
+}
+
+//Adds the area an edge covers in the rows [top, top + rows) of the pixels from left
+//on to cells, which has width + 2 entries per row. Entry x of a row is how much the
+//winding changes from pixel x - 1 to pixel x, so the winding of a pixel is the sum of
+//the entries up to it. An edge left of the cells covers all pixels to its right, so it
+//is moved onto the left side. Edges right of the cells go to the two extra entries.
+static void add_edge_area(float x0, float y0, float x1, float y1, float winding, int left, int top, int width, int rows, float* cells) {
+	x0 -= left;
+	x1 -= left;
+	y0 -= top;
+	y1 -= top;
+
+	if (y0 == y1) {
+		return;
+	}
+
+	if (y0 > y1) {
+		std::swap(x0, x1);
+		std::swap(y0, y1);
+		winding = -winding;
+	}
+
+	if (y1 <= 0.0f || y0 >= rows) {
+		return;
+	}
+
+	float dxdy = (x1 - x0) / (y1 - y0);
+	float right = static_cast<float>(width);
+	int first_row = y0 > 0.0f ? static_cast<int>(y0) : 0;
+	int end_row = y1 < rows ? static_cast<int>(std::ceil(y1)) : rows;
+	size_t stride = width + 2;
+
+	for (int row = first_row; row < end_row; ++row) {
+		float ya = row > y0 ? row : y0;
+		float yb = row + 1 < y1 ? row + 1 : y1;
+		float xa = x0 + (ya - y0) * dxdy;
+		float xb = x0 + (yb - y0) * dxdy;
+
+		//Written so that a NaN from an edge too long for floats goes to 0
+		xa = xa > 0.0f ? (xa < right ? xa : right) : 0.0f;
+		xb = xb > 0.0f ? (xb < right ? xb : right) : 0.0f;
+
+		float d = (yb - ya) * winding;
+		float* line = cells + row * stride;
+		float xl = xa < xb ? xa : xb;
+		float xr = xa < xb ? xb : xa;
+		//xl and xr are within [0, width], but the entries are clamped as well so that
+		//rounding can never index outside the row
+		int il = static_cast<int>(xl);
+		int ir = static_cast<int>(std::ceil(xr));
+
+		il = il < 0 ? 0 : (il > width ? width : il);
+		ir = ir < il ? il : (ir > width + 1 ? width + 1 : ir);
+
+		if (ir <= il + 1) {
+			//Within one pixel. The area right of the edge goes to the next pixel.
+			float xm = (xa + xb) / 2.0f - il;
+
+			line[il] += d * (1.0f - xm);
+			line[il + 1] += d * xm;
+		}
+		else {
+			//Across pixels il to ir - 1. The area is split by where the edge crosses them.
+			float s = 1.0f / (xr - xl);
+			float fl = xl - il;
+			float first = s * (1.0f - fl) * (1.0f - fl) / 2.0f;
+			float fr = xr - ir + 1.0f;
+			float last = s * fr * fr / 2.0f;
+
+			line[il] += d * first;
+
+			if (ir == il + 2) {
+				line[il + 1] += d * (1.0f - first - last);
+			}
+			else {
+				float second = s * (1.5f - fl);
+
+				line[il + 1] += d * (second - first);
+
+				for (int i = il + 2; i < ir - 1; ++i) {
+					line[i] += d * s;
+				}
+
+				line[ir - 1] += d * (1.0f - second - (ir - il - 3) * s - last);
+			}
+
+			line[ir] += d * last;
+		}
+	}
+}
+
+#ifndef SVGLIB_NO_GRADIENTS
+//Fills ramp with the colors of the stops at 256 steps. Offsets are clamped to
+//[0, 1] and to the offsets before them, as the SVG spec requires.
+static void build_ramp(const std::vector<SVGGradientStop>& stops, uint8_t ramp[256][4]) {
+	std::vector<float> offsets;
+	std::vector<StyleColor> colors;
+
+	for (const auto& stop : stops) {
+		float offset = clamp_unit(stop.offset);
+		StyleColor color = stop.color;
+
+		offsets.push_back(offsets.empty() || offset > offsets.back() ? offset : offsets.back());
+		color.r *= color.a;
+		color.g *= color.a;
+		color.b *= color.a;
+		colors.push_back(color);
+	}
+
+	size_t next = 0;
+
+	for (int i = 0; i < 256; ++i) {
+		float t = i / 255.0f;
+
+		while (next < offsets.size() && offsets[next] < t) {
+			++next;
+		}
+
+		StyleColor color;
+
+		if (next == 0) {
+			color = colors.front();
+		}
+		else if (next == offsets.size()) {
+			color = colors.back();
+		}
+		else {
+			const StyleColor& a = colors[next - 1];
+			const StyleColor& b = colors[next];
+			float f = (t - offsets[next - 1]) / (offsets[next] - offsets[next - 1]);
+
+			color.r = a.r + (b.r - a.r) * f;
+			color.g = a.g + (b.g - a.g) * f;
+			color.b = a.b + (b.b - a.b) * f;
+			color.a = a.a + (b.a - a.a) * f;
+		}
+
+		ramp[i][0] = static_cast<uint8_t>(clamp_unit(color.r) * 255.0f + 0.5f);
+		ramp[i][1] = static_cast<uint8_t>(clamp_unit(color.g) * 255.0f + 0.5f);
+		ramp[i][2] = static_cast<uint8_t>(clamp_unit(color.b) * 255.0f + 0.5f);
+		ramp[i][3] = static_cast<uint8_t>(clamp_unit(color.a) * 255.0f + 0.5f);
+	}
+}
+#endif
+
+SVGRasterRenderer::SVGRasterRenderer(const SVGBitmap& target, const SVGDocument& document, const Matrix& base) :
+	target(target),
+	document(document),
+	transform(base) {
+	base_transforms.push_back(base);
+}
+
+void SVGRasterRenderer::push_transform(const Matrix& transform) {
+	base_transforms.push_back(transform.then(base_transforms.back()));
+}
+
+void SVGRasterRenderer::pop_transform() {
+	base_transforms.pop_back();
+}
+
+void SVGRasterRenderer::set_transform(const Matrix& transform) {
+	this->transform = transform.then(base_transforms.back());
+}
+
+void SVGRasterRenderer::fill_rect(float x, float y, float width, float height, float rx, float ry, const SVGPaint& paint) {
+	shape.clear();
+	append_rect(shape, x, y, width, height, rx, ry);
+	fill(shape, FillRule::NonZero, paint);
+}
+
+void SVGRasterRenderer::stroke_rect(float x, float y, float width, float height, float rx, float ry, const SVGPaint& paint) {
+	shape.clear();
+	append_rect(shape, x, y, width, height, rx, ry);
+	stroke(shape, paint);
+}
+
+void SVGRasterRenderer::fill_ellipse(float cx, float cy, float rx, float ry, const SVGPaint& paint) {
+	shape.clear();
+	append_ellipse(shape, cx, cy, rx, ry);
+	fill(shape, FillRule::NonZero, paint);
+}
+
+void SVGRasterRenderer::stroke_ellipse(float cx, float cy, float rx, float ry, const SVGPaint& paint) {
+	shape.clear();
+	append_ellipse(shape, cx, cy, rx, ry);
+	stroke(shape, paint);
+}
+
+void SVGRasterRenderer::stroke_line(float x1, float y1, float x2, float y2, const SVGPaint& paint) {
+	shape.clear();
+	append_line(shape, x1, y1, x2, y2);
+	stroke(shape, paint);
+}
+
+void SVGRasterRenderer::fill_path(const SVGPathElement& path, const SVGPaint& paint) {
+	fill(path.path_data, paint.style.fill_rule, paint);
+}
+
+void SVGRasterRenderer::stroke_path(const SVGPathElement& path, const SVGPaint& paint) {
+	stroke(path.path_data, paint);
+}
+
+void SVGRasterRenderer::clear(float red, float green, float blue, float alpha) {
+	uint8_t color[4];
+
+	premultiply(red, green, blue, alpha, color);
+
+	for (uint32_t y = 0; y < target.height; ++y) {
+		uint8_t* pixel = target.pixels + y * target.stride;
+
+		for (uint32_t x = 0; x < target.width; ++x, pixel += 4) {
+			std::memcpy(pixel, color, 4);
+		}
+	}
+}
+
+Bounds SVGRasterRenderer::get_clip() const {
+	Matrix inverse;
+
+	if (!base_transforms.front().invert(inverse)) {
+		return infinite_bounds();
+	}
+
+	//A pixel more, for the anti-aliased edges of shapes
+	return transform_bounds(Bounds{ 0.0f, 0.0f, static_cast<float>(target.width), static_cast<float>(target.height) }, 1.0f, inverse);
+}
+
+//Replaces the curves of path by lines and maps the points with matrix. The lines are at
+//most tolerance away from the curves, after the mapping.
+void SVGRasterRenderer::flatten(const PathData& path, const Matrix& matrix, float tolerance) {
+	points.clear();
+	figures.clear();
+
+	const float* c = path.coords.data();
+	//Current point and start of the figure, before the mapping
+	float x = 0.0f, y = 0.0f, start_x = 0.0f, start_y = 0.0f;
+	bool is_in_figure = false;
+	float scale = get_scale(matrix);
+
+	auto add_point = [&](float px, float py) {
+		matrix.transform_point(px, py);
+		points.push_back({ px, py });
+		++figures.back().count;
+	};
+
+	for (PathVerb verb : path.verbs) {
+		if (verb != PathVerb::MoveTo && verb != PathVerb::Close && !is_in_figure) {
+			//A figure that follows a close starts where the closed one did
+			figures.push_back({ points.size(), 0, false });
+			add_point(x, y);
+			is_in_figure = true;
+		}
+
+		switch (verb) {
+		case PathVerb::MoveTo:
+			figures.push_back({ points.size(), 0, false });
+			x = start_x = c[0];
+			y = start_y = c[1];
+			add_point(x, y);
+			is_in_figure = true;
+
+			break;
+		case PathVerb::LineTo:
+			x = c[0];
+			y = c[1];
+			add_point(x, y);
+
+			break;
+		case PathVerb::QuadTo: {
+			Point p0 = points.back(), p1{ c[0], c[1] }, p2{ c[2], c[3] };
+
+			matrix.transform_point(p1.x, p1.y);
+			matrix.transform_point(p2.x, p2.y);
+
+			float ddx = p0.x - 2.0f * p1.x + p2.x, ddy = p0.y - 2.0f * p1.y + p2.y;
+			int n = get_curve_lines(std::sqrt(ddx * ddx + ddy * ddy) / 4.0f, tolerance);
+
+			for (int i = 1; i <= n; ++i) {
+				float t = static_cast<float>(i) / n, u = 1.0f - t;
+
+				points.push_back({
+					u * u * p0.x + 2.0f * u * t * p1.x + t * t * p2.x,
+					u * u * p0.y + 2.0f * u * t * p1.y + t * t * p2.y });
+			}
+
+			figures.back().count += n;
+			x = c[2];
+			y = c[3];
+
+			break;
+		}
+		case PathVerb::CubicTo: {
+			Point p0 = points.back(), p1{ c[0], c[1] }, p2{ c[2], c[3] }, p3{ c[4], c[5] };
+
+			matrix.transform_point(p1.x, p1.y);
+			matrix.transform_point(p2.x, p2.y);
+			matrix.transform_point(p3.x, p3.y);
+
+			float ddx0 = p0.x - 2.0f * p1.x + p2.x, ddy0 = p0.y - 2.0f * p1.y + p2.y;
+			float ddx1 = p1.x - 2.0f * p2.x + p3.x, ddy1 = p1.y - 2.0f * p2.y + p3.y;
+			float dd = std::sqrt(std::fmax(ddx0 * ddx0 + ddy0 * ddy0, ddx1 * ddx1 + ddy1 * ddy1));
+			int n = get_curve_lines(dd * 3.0f / 4.0f, tolerance);
+
+			for (int i = 1; i <= n; ++i) {
+				float t = static_cast<float>(i) / n, u = 1.0f - t;
+				float b0 = u * u * u, b1 = 3.0f * u * u * t, b2 = 3.0f * u * t * t, b3 = t * t * t;
+
+				points.push_back({
+					b0 * p0.x + b1 * p1.x + b2 * p2.x + b3 * p3.x,
+					b0 * p0.y + b1 * p1.y + b2 * p2.y + b3 * p3.y });
+			}
+
+			figures.back().count += n;
+			x = c[4];
+			y = c[5];
+
+			break;
+		}
+		case PathVerb::ArcTo: {
+			ArcCenter arc;
+
+			if (get_arc_center(x, y, c, arc)) {
+				double cos_phi = std::cos(arc.phi), sin_phi = std::sin(arc.phi);
+				double radius = (arc.rx > arc.ry ? arc.rx : arc.ry) * scale;
+				int n = get_arc_lines(arc.delta, radius, tolerance);
+
+				for (int i = 1; i < n; ++i) {
+					double theta = arc.start + arc.delta * i / n;
+					double cos_theta = std::cos(theta), sin_theta = std::sin(theta);
+
+					add_point(
+						static_cast<float>(arc.cx + arc.rx * cos_phi * cos_theta - arc.ry * sin_phi * sin_theta),
+						static_cast<float>(arc.cy + arc.rx * sin_phi * cos_theta + arc.ry * cos_phi * sin_theta));
+				}
+			}
+
+			x = c[5];
+			y = c[6];
+			add_point(x, y);
+
+			break;
+		}
+		case PathVerb::Close:
+			if (is_in_figure) {
+				figures.back().closed = true;
+				is_in_figure = false;
+			}
+
+			x = start_x;
+			y = start_y;
+
+			break;
+		}
+
+		c += path_verb_size(verb);
+	}
+}
+
+void SVGRasterRenderer::fill(const PathData& path, FillRule fill_rule, const SVGPaint& paint) {
+	flatten(path, transform, flatness);
+	edges.clear();
+
+	//Every figure is filled as if it was closed
+	for (const Figure& figure : figures) {
+		const Point* p = points.data() + figure.first;
+
+		for (size_t i = 0; i < figure.count; ++i) {
+			const Point& next = p[i + 1 < figure.count ? i + 1 : 0];
+
+			add_edge(p[i], next, 1.0f);
+		}
+	}
+
+	draw_edges(fill_rule, paint.style.fill, paint.style.get_fill_opacity(), paint);
+}
+
+//Adds an edge in pixels. Edges with a coordinate that is not finite, like one that
+//overflowed in the transform, are dropped, since the area they cover can't be computed.
+void SVGRasterRenderer::add_edge(const Point& from, const Point& to, float winding) {
+	if (std::isfinite(from.x) && std::isfinite(from.y) && std::isfinite(to.x) && std::isfinite(to.y)) {
+		edges.push_back({ from.x, from.y, to.x, to.y, winding });
+	}
+}
+
+//Adds the outline of a polygon in the space of the shape. Polygons are added with the
+//same winding whichever way they go round, so overlapping ones merge under nonzero.
+void SVGRasterRenderer::add_polygon(const Point* polygon, size_t count) {
+	float area = 0.0f;
+
+	for (size_t i = 0; i < count; ++i) {
+		const Point& next = polygon[i + 1 < count ? i + 1 : 0];
+
+		area += polygon[i].x * next.y - next.x * polygon[i].y;
+	}
+
+	if (area == 0.0f) {
+		return;
+	}
+
+	float winding = area > 0.0f ? 1.0f : -1.0f;
+	Point first = polygon[0];
+	Point previous = first;
+
+	transform.transform_point(first.x, first.y);
+	previous = first;
+
+	for (size_t i = 1; i <= count; ++i) {
+		Point p = first;
+
+		if (i < count) {
+			p = polygon[i];
+			transform.transform_point(p.x, p.y);
+		}
+
+		add_edge(previous, p, winding);
+		previous = p;
+	}
+}
+
+void SVGRasterRenderer::add_circle(float cx, float cy, float radius) {
+	const double pi = 3.14159265358979323846;
+	int n = get_arc_lines(2.0 * pi, radius * get_scale(transform), flatness);
+
+	n = n < 8 ? 8 : n;
+	polygon.clear();
+
+	for (int i = 0; i < n; ++i) {
+		double theta = 2.0 * pi * i / n;
+
+		polygon.push_back({ cx + radius * static_cast<float>(std::cos(theta)), cy + radius * static_cast<float>(std::sin(theta)) });
+	}
+
+	add_polygon(polygon.data(), polygon.size());
+}
+
+//Adds the join at p of a line going along (dx0, dy0) with one going along (dx1, dy1).
+//The directions are unit vectors.
+void SVGRasterRenderer::add_join(const Point& p, float dx0, float dy0, float dx1, float dy1, float half_width, const ComputedStyle& style) {
+	float cross = dx0 * dy1 - dy0 * dx1;
+	float dot = dx0 * dx1 + dy0 * dy1;
+
+	if (std::fabs(cross) < 1e-6f && dot > 0.0f) {
+		//Straight on, the lines already meet
+		return;
+	}
+
+	//The join fills the gap on the outside of the turn
+	float side = cross > 0.0f ? -half_width : half_width;
+	Point a{ p.x - dy0 * side, p.y + dx0 * side };
+	Point b{ p.x - dy1 * side, p.y + dx1 * side };
+
+	if (style.stroke_linejoin == LineJoin::Round) {
+		//A slice of the circle around p from a to b. A whole circle would stick out of
+		//a butt cap close to the join, as on a curve.
+		double angle = std::atan2(cross, dot);
+		int n = get_arc_lines(angle, half_width * get_scale(transform), flatness);
+		float ax = a.x - p.x, ay = a.y - p.y;
+
+		polygon.clear();
+		polygon.push_back(p);
+		polygon.push_back(a);
+
+		for (int i = 1; i < n; ++i) {
+			float cos_theta = static_cast<float>(std::cos(angle * i / n));
+			float sin_theta = static_cast<float>(std::sin(angle * i / n));
+
+			polygon.push_back({ p.x + ax * cos_theta - ay * sin_theta, p.y + ax * sin_theta + ay * cos_theta });
+		}
+
+		polygon.push_back(b);
+		add_polygon(polygon.data(), polygon.size());
+
+		return;
+	}
+
+	float limit = style.stroke_miterlimit < 1.0f ? 1.0f : style.stroke_miterlimit;
+
+	//The ratio of the miter length to the stroke width is 1 / sin(angle / 2) for the
+	//angle between the lines, which is sqrt(2 / (1 + dot))
+	if (style.stroke_linejoin == LineJoin::Miter && 1.0f + dot >= 2.0f / (limit * limit)) {
+		Point quad[4] = {
+			p,
+			a,
+			{ p.x + (a.x - p.x + b.x - p.x) / (1.0f + dot), p.y + (a.y - p.y + b.y - p.y) / (1.0f + dot) },
+			b
+		};
+
+		add_polygon(quad, 4);
+	}
+	else {
+		Point triangle[3] = { p, a, b };
+
+		add_polygon(triangle, 3);
+	}
+}
+
+//Adds the cap at the end p of a line. (dx, dy) is the unit vector pointing away from the line.
+void SVGRasterRenderer::add_cap(const Point& p, float dx, float dy, float half_width, const ComputedStyle& style) {
+	if (style.stroke_linecap == LineCap::Round) {
+		add_circle(p.x, p.y, half_width);
+	}
+	else if (style.stroke_linecap == LineCap::Square) {
+		float nx = -dy * half_width, ny = dx * half_width;
+		float ex = dx * half_width, ey = dy * half_width;
+		Point quad[4] = {
+			{ p.x + nx, p.y + ny },
+			{ p.x + nx + ex, p.y + ny + ey },
+			{ p.x - nx + ex, p.y - ny + ey },
+			{ p.x - nx, p.y - ny }
+		};
+
+		add_polygon(quad, 4);
+	}
+}
+
+//Strokes path by filling the union of a quad for each line, the joins between them and
+//the caps at the ends. The outline is built in the space of the shape, where the stroke
+//width is given, and mapped to pixels after.
+void SVGRasterRenderer::stroke(const PathData& path, const SVGPaint& paint) {
+	const ComputedStyle& style = paint.style;
+	float half_width = style.stroke_width / 2.0f;
+	float scale = get_scale(transform);
+
+	if (!(half_width > 0.0f) || !(scale > 0.0f)) {
+		return;
+	}
+
+	flatten(path, Matrix(), flatness / scale);
+	edges.clear();
+
+	for (const Figure& figure : figures) {
+		Point* p = points.data() + figure.first;
+		size_t n = 0;
+
+		//Repeated points have no direction
+		for (size_t i = 0; i < figure.count; ++i) {
+			if (n == 0 || p[i].x != p[n - 1].x || p[i].y != p[n - 1].y) {
+				p[n++] = p[i];
+			}
+		}
+
+		if (figure.closed && n > 1 && p[n - 1].x == p[0].x && p[n - 1].y == p[0].y) {
+			--n;
+		}
+
+		if (n == 1) {
+			//A figure of zero length only gets its caps. A lone move has none.
+			if (figure.count > 1 || figure.closed) {
+				add_cap(p[0], 1.0f, 0.0f, half_width, style);
+				add_cap(p[0], -1.0f, 0.0f, half_width, style);
+			}
+
+			continue;
+		}
+
+		size_t lines = figure.closed ? n : n - 1;
+		float first_dx = 0.0f, first_dy = 0.0f, dx = 0.0f, dy = 0.0f;
+
+		for (size_t i = 0; i < lines; ++i) {
+			const Point& a = p[i];
+			const Point& b = p[i + 1 < n ? i + 1 : 0];
+			float length = std::sqrt((b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y));
+			float next_dx = (b.x - a.x) / length, next_dy = (b.y - a.y) / length;
+			float nx = -next_dy * half_width, ny = next_dx * half_width;
+			Point quad[4] = {
+				{ a.x + nx, a.y + ny },
+				{ b.x + nx, b.y + ny },
+				{ b.x - nx, b.y - ny },
+				{ a.x - nx, a.y - ny }
+			};
+
+			add_polygon(quad, 4);
+
+			if (i == 0) {
+				first_dx = next_dx;
+				first_dy = next_dy;
+			}
+			else {
+				add_join(a, dx, dy, next_dx, next_dy, half_width, style);
+			}
+
+			dx = next_dx;
+			dy = next_dy;
+		}
+
+		if (figure.closed) {
+			add_join(p[0], dx, dy, first_dx, first_dy, half_width, style);
+		}
+		else {
+			add_cap(p[0], -first_dx, -first_dy, half_width, style);
+			add_cap(p[n - 1], dx, dy, half_width, style);
+		}
+	}
+
+	draw_edges(FillRule::NonZero, style.stroke, style.stroke_opacity, paint);
+}
+
+bool SVGRasterRenderer::get_gradient(const Paint& paint, const SVGPaint& shape_paint, Gradient& gradient) {
+#ifndef SVGLIB_NO_GRADIENTS
+	auto it = document.id_map.find(paint.url_id);
+
+	if (it == document.id_map.end()) {
+		return false;
+	}
+
+	const SVGGraphicsElement* paint_server = it->second;
+	SVGGradientPaint resolved;
+	bool found = false;
+
+	if (paint_server->kind == ElementKind::LinearGradient) {
+		found = resolve_linear_gradient(document.id_map, document.lengths, *static_cast<const SVGLinearGradientElement*>(paint_server), shape_paint.element, resolved);
+	}
+	else if (paint_server->kind == ElementKind::RadialGradient) {
+		found = resolve_radial_gradient(document.id_map, document.lengths, *static_cast<const SVGRadialGradientElement*>(paint_server), shape_paint.element, resolved);
+	}
+
+	if (!found) {
+		return false;
+	}
+
+	std::unique_ptr<GradientRamp>& ramp = ramps[paint_server];
+
+	if (!ramp) {
+		ramp.reset(new GradientRamp);
+		build_ramp(resolved.stops, ramp->colors);
+	}
+
+	gradient.is_radial = resolved.is_radial;
+	gradient.transform = resolved.transform;
+	gradient.x1 = resolved.x1;
+	gradient.y1 = resolved.y1;
+	gradient.x2 = resolved.x2;
+	gradient.y2 = resolved.y2;
+	gradient.cx = resolved.cx;
+	gradient.cy = resolved.cy;
+	gradient.rx = resolved.rx;
+	gradient.ry = resolved.ry;
+	gradient.focal_dx = resolved.focal_dx;
+	gradient.focal_dy = resolved.focal_dy;
+	gradient.ramp = ramp->colors;
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+//Covers the pixels inside edges with paint
+void SVGRasterRenderer::draw_edges(FillRule fill_rule, const Paint& paint, float opacity, const SVGPaint& shape_paint) {
+	if (edges.empty() || paint.type == PaintType::None) {
+		return;
+	}
+
+	uint8_t color[4];
+	Gradient gradient;
+
+	if (paint.type == PaintType::Color) {
+		premultiply(paint.color.r, paint.color.g, paint.color.b, paint.color.a * opacity, color);
+
+		if (color[3] == 0) {
+			return;
+		}
+	}
+	else {
+		//Like the Direct2D gradient brushes, gradients ignore the opacity
+		if (!get_gradient(paint, shape_paint, gradient)) {
+			return;
+		}
+	}
+
+	//Edges are finite, see add_edge()
+	float min_x = edges[0].x0, max_x = min_x, min_y = edges[0].y0, max_y = min_y;
+
+	for (const Edge& edge : edges) {
+		min_x = edge.x0 < min_x ? edge.x0 : min_x;
+		min_x = edge.x1 < min_x ? edge.x1 : min_x;
+		max_x = edge.x0 > max_x ? edge.x0 : max_x;
+		max_x = edge.x1 > max_x ? edge.x1 : max_x;
+		min_y = edge.y0 < min_y ? edge.y0 : min_y;
+		min_y = edge.y1 < min_y ? edge.y1 : min_y;
+		max_y = edge.y0 > max_y ? edge.y0 : max_y;
+		max_y = edge.y1 > max_y ? edge.y1 : max_y;
+	}
+
+	//Pixels that may be covered
+	if (!(max_x > 0.0f && max_y > 0.0f && min_x < target.width && min_y < target.height)) {
+		return;
+	}
+
+	int left = min_x > 0.0f ? static_cast<int>(min_x) : 0;
+	int top = min_y > 0.0f ? static_cast<int>(min_y) : 0;
+	int right = max_x < target.width ? static_cast<int>(std::ceil(max_x)) : target.width;
+	int bottom = max_y < target.height ? static_cast<int>(std::ceil(max_y)) : target.height;
+	int width = right - left;
+	size_t stride = width + 2;
+
+	//The gradient position of a pixel is a linear function of its center
+	float tx = 0.0f, ty = 0.0f, t0 = 1.0f;
+	float ux = 0.0f, uy = 0.0f, u0 = 0.0f, vx = 0.0f, vy = 0.0f, v0 = 0.0f, focal_x = 0.0f, focal_y = 0.0f;
+	bool is_radial = false;
+
+	if (gradient.ramp) {
+		Matrix inverse;
+
+		if (!gradient.transform.then(transform).invert(inverse)) {
+			return;
+		}
+
+		if (!gradient.is_radial) {
+			float dx = gradient.x2 - gradient.x1, dy = gradient.y2 - gradient.y1;
+			float length = dx * dx + dy * dy;
+
+			//Without a length the last stop is drawn, which is t0 = 1
+			if (length > 0.0f) {
+				tx = (inverse.a * dx + inverse.b * dy) / length;
+				ty = (inverse.c * dx + inverse.d * dy) / length;
+				t0 = ((inverse.e - gradient.x1) * dx + (inverse.f - gradient.y1) * dy) / length;
+			}
+		}
+		else if (gradient.rx > 0.0f && gradient.ry > 0.0f) {
+			//Positions are mapped to a circle of radius 1
+			is_radial = true;
+			ux = inverse.a / gradient.rx;
+			uy = inverse.c / gradient.rx;
+			u0 = (inverse.e - gradient.cx) / gradient.rx;
+			vx = inverse.b / gradient.ry;
+			vy = inverse.d / gradient.ry;
+			v0 = (inverse.f - gradient.cy) / gradient.ry;
+			focal_x = gradient.focal_dx / gradient.rx;
+			focal_y = gradient.focal_dy / gradient.ry;
+
+			//The focal point must be inside the circle
+			float focal_distance = std::sqrt(focal_x * focal_x + focal_y * focal_y);
+
+			if (focal_distance > 0.99f) {
+				focal_x *= 0.99f / focal_distance;
+				focal_y *= 0.99f / focal_distance;
+			}
+		}
+	}
+
+	for (int band = top; band < bottom; band += band_height) {
+		int rows = bottom - band < band_height ? bottom - band : band_height;
+
+		//Cells are left at 0 after each band
+		if (cells.size() < rows * stride) {
+			cells.resize(rows * stride, 0.0f);
+		}
+
+		for (const Edge& edge : edges) {
+			add_edge_area(edge.x0, edge.y0, edge.x1, edge.y1, edge.winding, left, band, width, rows, cells.data());
+		}
+
+		for (int row = 0; row < rows; ++row) {
+			float* line = cells.data() + row * stride;
+			uint8_t* pixel = target.pixels + (band + row) * target.stride + left * 4;
+			float winding = 0.0f;
+			float py = band + row + 0.5f;
+
+			for (int x = 0; x < width; ++x, pixel += 4) {
+				winding += line[x];
+				line[x] = 0.0f;
+
+				uint32_t coverage = get_coverage(winding, fill_rule);
+
+				if (coverage == 0) {
+					continue;
+				}
+
+				if (!gradient.ramp) {
+					blend_pixel(pixel, color, coverage);
+
+					continue;
+				}
+
+				float px = left + x + 0.5f;
+				float t;
+
+				if (is_radial) {
+					//Distance from the focal point relative to where the line from it
+					//through the pixel meets the circle
+					float dx = ux * px + uy * py + u0 - focal_x;
+					float dy = vx * px + vy * py + v0 - focal_y;
+					float a = dx * dx + dy * dy;
+					float b = focal_x * dx + focal_y * dy;
+					float c = focal_x * focal_x + focal_y * focal_y - 1.0f;
+
+					t = a > 0.0f ? a / (std::sqrt(b * b - a * c) - b) : 0.0f;
+				}
+				else {
+					t = tx * px + ty * py + t0;
+				}
+
+				blend_pixel(pixel, gradient.ramp[static_cast<int>(clamp_unit(t) * 255.0f + 0.5f)], coverage);
+			}
+
+			line[width] = 0.0f;
+			line[width + 1] = 0.0f;
+		}
+	}
+}
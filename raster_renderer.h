@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+#include "path_data.h"
+#include "renderer.h"
+
+struct SVGDocument;
+
+//An image owned by the caller that SVGRasterRenderer draws into. Pixels are 4 bytes,
+//red, green, blue and alpha, with the color premultiplied by alpha. Row y starts at
+//pixels + y * stride.
+struct SVGBitmap {
+	uint8_t* pixels = nullptr;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	size_t stride = 0;
+};
+
+//Draws an image into an SVGBitmap on the CPU, without Direct2D or a device. The image
+//doesn't have to be bound, so a document from SVG::parse() can be drawn on any thread:
+//
+//	SVGImageBase image;
+//	image.document = document;
+//	SVGRasterRenderer renderer(bitmap, *document);
+//	SVG::render(renderer, image);
+//
+//Shapes are anti-aliased with the exact area they cover in each pixel. Fills follow the
+//fill-rule of the shape. Strokes have the caps, joins and miter limit of the style.
+//Gradients are drawn like the Direct2D brushes of create_linear_gradient_brush() and
+//create_radial_gradient_brush(). Text is not drawn, since there is no font rasterizer.
+//A renderer keeps its buffers and the color ramps of gradients, so reuse one for frames
+//of the same document.
+class SVGRasterRenderer : public SVGRenderer {
+public:
+	//Gradients are looked up in document. base maps the image to the pixels of target.
+	SVGRasterRenderer(const SVGBitmap& target, const SVGDocument& document, const Matrix& base = Matrix());
+
+	void push_transform(const Matrix& transform) override;
+	void pop_transform() override;
+	void set_transform(const Matrix& transform) override;
+	void fill_rect(float x, float y, float width, float height, float rx, float ry, const SVGPaint& paint) override;
+	void stroke_rect(float x, float y, float width, float height, float rx, float ry, const SVGPaint& paint) override;
+	void fill_ellipse(float cx, float cy, float rx, float ry, const SVGPaint& paint) override;
+	void stroke_ellipse(float cx, float cy, float rx, float ry, const SVGPaint& paint) override;
+	void stroke_line(float x1, float y1, float x2, float y2, const SVGPaint& paint) override;
+	void fill_path(const SVGPathElement& path, const SVGPaint& paint) override;
+	void stroke_path(const SVGPathElement& path, const SVGPaint& paint) override;
+	void draw_text(const SVGTextElement&, const SVGPaint&) override {}
+
+	//Fills the target with a color, not premultiplied, like SVG::clear()
+	void clear(float red, float green, float blue, float alpha);
+	//The part of the image that can show in the target. Pass it to SVG::render() to skip
+	//the shapes that are off the target.
+	Bounds get_clip() const;
+
+private:
+	struct Point {
+		float x, y;
+	};
+
+	//A polyline of the flattened path in points
+	struct Figure {
+		size_t first;
+		size_t count;
+		bool closed;
+	};
+
+	//A line of an outline in pixels. winding is +1 or -1 and is flipped for lines going up.
+	struct Edge {
+		float x0, y0, x1, y1;
+		float winding;
+	};
+
+	//A gradient mapped to the shape it paints
+	struct Gradient {
+		bool is_radial = false;
+		//Maps the space of the positions to user space
+		Matrix transform;
+		float x1 = 0.0f, y1 = 0.0f, x2 = 0.0f, y2 = 0.0f;
+		float cx = 0.0f, cy = 0.0f, rx = 0.0f, ry = 0.0f, focal_dx = 0.0f, focal_dy = 0.0f;
+		//Premultiplied colors for 256 steps from offset 0 to 1
+		const uint8_t (*ramp)[4] = nullptr;
+	};
+
+	struct GradientRamp {
+		uint8_t colors[256][4];
+	};
+
+	SVGBitmap target;
+	const SVGDocument& document;
+	//Transform of the image, followed by the one of each instance being drawn
+	std::vector<Matrix> base_transforms;
+	//From the space of the shapes drawn next to pixels
+	Matrix transform;
+
+	//Buffers reused from shape to shape
+	PathData shape;
+	std::vector<Point> points;
+	std::vector<Figure> figures;
+	std::vector<Point> polygon;
+	std::vector<Edge> edges;
+	std::vector<float> cells;
+	//Color ramps by paint server. The stops don't depend on the shape, so shapes that share
+	//a gradient share the ramp. Null if the gradient has no stops.
+	std::map<const SVGGraphicsElement*, std::unique_ptr<GradientRamp>> ramps;
+
+	void fill(const PathData& path, FillRule fill_rule, const SVGPaint& paint);
+	void stroke(const PathData& path, const SVGPaint& paint);
+	void flatten(const PathData& path, const Matrix& matrix, float tolerance);
+	void add_edge(const Point& from, const Point& to, float winding);
+	void add_polygon(const Point* polygon, size_t count);
+	void add_circle(float cx, float cy, float radius);
+	void add_join(const Point& p, float dx0, float dy0, float dx1, float dy1, float half_width, const ComputedStyle& style);
+	void add_cap(const Point& p, float dx, float dy, float half_width, const ComputedStyle& style);
+	void draw_edges(FillRule fill_rule, const Paint& paint, float opacity, const SVGPaint& shape_paint);
+	bool get_gradient(const Paint& paint, const SVGPaint& shape_paint, Gradient& gradient);
+};
@@ -1,48 +1,32 @@
-#include "svglib.h"
-#include "rect.h"
-
-void SVGRectElement::compute_bbox() {
-	bbox.left = points[0];
-	bbox.top = points[1];
-	bbox.right = points[0] + points[2];
-	bbox.bottom = points[1] + points[3];
-}
-
-void SVGRectElement::render(const SVGDevice& device) const {
-	if (fill_brush) {
-		if (points.size() == 4) {
-			device.device_context->FillRectangle(
-				D2D1::RectF(points[0], points[1], points[0] + points[2], points[1] + points[3]),
-				fill_brush
-			);
-		}
-		else if (points.size() == 6) {
-			device.device_context->FillRoundedRectangle(
-				D2D1::RoundedRect(
-					D2D1::RectF(points[0], points[1], points[0] + points[2], points[1] + points[3]),
-					points[4], points[5]),
-				fill_brush
-			);
-		}
-	}
-	if (stroke_brush) {
-		if (points.size() == 4) {
-			device.device_context->DrawRectangle(
-				D2D1::RectF(points[0], points[1], points[0] + points[2], points[1] + points[3]),
-				stroke_brush,
-				stroke_width,
-				stroke_style
-			);
-		}
-		else if (points.size() == 6) {
-			device.device_context->DrawRoundedRectangle(
-				D2D1::RoundedRect(
-					D2D1::RectF(points[0], points[1], points[0] + points[2], points[1] + points[3]),
-					points[4], points[5]),
-				stroke_brush,
-				stroke_width,
-				stroke_style
-			);
-		}
-	}
-}
+#include "document.h"
+#include "rect.h"
+
+void SVGRectElement::compute_bbox() {
+	bbox.left = points[0];
+	bbox.top = points[1];
+	bbox.right = points[0] + points[2];
+	bbox.bottom = points[1] + points[3];
+}
+
+bool SVGRectElement::to_path_data(PathData& path) const {
+	if (points.size() == 6) {
+		append_rect(path, points[0], points[1], points[2], points[3], points[4], points[5]);
+	}
+	else {
+		append_rect(path, points[0], points[1], points[2], points[3]);
+	}
+
+	return true;
+}
+
+void SVGRectElement::render(SVGRenderer& renderer, const SVGPaint& paint) const {
+	float rx = points.size() == 6 ? points[4] : 0.0f;
+	float ry = points.size() == 6 ? points[5] : 0.0f;
+
+	if (paint.style.fill.type != PaintType::None) {
+		renderer.fill_rect(points[0], points[1], points[2], points[3], rx, ry, paint);
+	}
+	if (paint.style.stroke.type != PaintType::None) {
+		renderer.stroke_rect(points[0], points[1], points[2], points[3], rx, ry, paint);
+	}
+}
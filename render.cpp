@@ -0,0 +1,176 @@
+#include <vector>
+#include "document.h"
+
+//Stands for a transform that has to be set again before the next shape
+static const uint32_t unknown_transform = no_index - 1;
+
+//Draws the shapes of a dom as walk_drawn_nodes() visits them. The transforms of the nodes
+//were combined with the ones of their ancestors by build_dom(), so the only transform
+//stack is the one for instances. The transform is only set when a shape uses a
+//different one than the shape before it.
+struct DomRenderer {
+	SVGRenderer& renderer;
+	const SVGDom& dom;
+	//Shapes that don't reach it are skipped. Null to draw all shapes.
+	const Bounds* clip;
+	SVGRenderStats& stats;
+	//Index into dom.transforms of the current transform. no_index stands for identity.
+	uint32_t current_transform = unknown_transform;
+	//Combined transforms of the instances being drawn, to find the bounds of shapes
+	std::vector<Matrix> instance_transforms;
+
+	void enter(NodeIndex node, const SVGInstance& instance) {
+		renderer.push_transform(instance.transform);
+		instance_transforms.push_back(instance.transform.then(instance_transforms.back()));
+		current_transform = unknown_transform;
+	}
+
+	void leave() {
+		renderer.pop_transform();
+		instance_transforms.pop_back();
+		current_transform = unknown_transform;
+	}
+
+	void shape(NodeIndex node, uint32_t geometry) {
+		uint32_t transform = dom.transform_index[node];
+		const SVGGraphicsElement& element = *dom.geometries[geometry];
+		const ComputedStyle& style = *dom.styles[dom.geometry_style[geometry]];
+		ElementKind kind = dom.kind[node];
+
+		if (clip) {
+			Matrix world = (transform == no_index ? Matrix() : dom.transforms[transform]).then(instance_transforms.back());
+
+			if (!bounds_intersect(get_drawn_bounds(element, kind, style, world), *clip)) {
+				++stats.culled;
+
+				return;
+			}
+		}
+
+		if (transform != current_transform) {
+			renderer.set_transform(transform == no_index ? Matrix() : dom.transforms[transform]);
+			current_transform = transform;
+		}
+
+		SVGPaint paint{ element, style, geometry };
+
+		render_element(element, kind, renderer, paint);
+		++stats.drawn;
+	}
+};
+
+//Draws an op of a display list. A shape only needs a new transform when it has another
+//one than the shape before it.
+static void render_display_op(const SVGDisplayList& list, const SVGDrawOp& draw, uint32_t& current_transform, SVGRenderer& renderer) {
+	if (draw.transform != current_transform) {
+		renderer.set_transform(list.transforms[draw.transform]);
+		current_transform = draw.transform;
+	}
+
+	SVGPaint paint{ *draw.element, *draw.style, draw.geometry };
+
+	render_element(*draw.element, draw.kind, renderer, paint);
+}
+
+//Draws the ops of a display list. With a clip, a group that doesn't reach it is skipped
+//as a whole, and so is an op.
+static void render_display_list(const SVGDisplayList& list, const Bounds* clip, SVGRenderer& renderer, SVGRenderStats& stats) {
+	uint32_t current_transform = unknown_transform;
+	size_t op = 0;
+	size_t group = 0;
+
+	while (op < list.ops.size()) {
+		if (clip && group < list.groups.size() && list.groups[group].first_op == op) {
+			const SVGDisplayGroup& skipped = list.groups[group];
+
+			if (bounds_intersect(skipped.bounds, *clip)) {
+				++group;
+			}
+			else {
+				stats.culled += skipped.end_op - skipped.first_op;
+				++stats.culled_groups;
+				op = skipped.end_op;
+				group = skipped.end_group;
+			}
+
+			continue;
+		}
+
+		const SVGDrawOp& draw = list.ops[op++];
+
+		if (clip && !bounds_intersect(draw.bounds, *clip)) {
+			++stats.culled;
+
+			continue;
+		}
+
+		render_display_op(list, draw, current_transform, renderer);
+		++stats.drawn;
+	}
+}
+
+//Draws the ops of a display list that its index finds in clip. The index finds them out
+//of order, so they are marked with a bit each and drawn in the order of the list.
+static void render_indexed_display_list(const SVGDisplayList& list, const Bounds& clip, SVGRenderer& renderer, SVGRenderStats& stats) {
+	std::vector<uint32_t> found;
+
+	list.index.query(clip, found);
+
+	std::vector<uint64_t> marks((list.ops.size() + 63) / 64);
+
+	for (uint32_t op : found) {
+		marks[op / 64] |= uint64_t(1) << (op % 64);
+	}
+
+	uint32_t current_transform = unknown_transform;
+
+	for (size_t word = 0; word < marks.size(); ++word) {
+		size_t op = word * 64;
+
+		for (uint64_t bits = marks[word]; bits != 0; bits >>= 1, ++op) {
+			if (bits & 1) {
+				render_display_op(list, list.ops[op], current_transform, renderer);
+			}
+		}
+	}
+
+	stats.drawn += found.size();
+	stats.culled += list.ops.size() - found.size();
+}
+
+static void render_image(SVGRenderer& renderer, const SVGImageBase& image, const Bounds* clip, SVGRenderStats* stats) {
+	SVGRenderStats counts;
+
+	if (image.document && !image.document->dom.empty()) {
+		const SVGDom& dom = image.document->dom;
+		const SVGDisplayList& list = image.display_list;
+
+		if (list.node_count == dom.size()) {
+			//When all of the image is in the clip, the index wouldn't skip anything
+			if (clip && !list.index.empty() && !bounds_contain(*clip, list.index.get_bounds())) {
+				render_indexed_display_list(list, *clip, renderer, counts);
+			}
+			else {
+				render_display_list(list, clip, renderer, counts);
+			}
+		}
+		else {
+			DomRenderer dom_renderer{ renderer, dom, clip, counts };
+
+			dom_renderer.instance_transforms.push_back(Matrix());
+			walk_drawn_nodes(dom, 0, static_cast<NodeIndex>(dom.size()), no_index, dom_renderer);
+		}
+	}
+
+	if (stats) {
+		*stats = counts;
+	}
+}
+
+void SVG::render(SVGRenderer& renderer, const SVGImageBase& image, SVGRenderStats* stats) {
+	render_image(renderer, image, nullptr, stats);
+}
+
+void SVG::render(SVGRenderer& renderer, const SVGImageBase& image, const Bounds& clip, SVGRenderStats* stats) {
+	render_image(renderer, image, &clip, stats);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "transform.h"
+#include "style.h"
+
+struct SVGGraphicsElement;
+struct SVGPathElement;
+struct SVGTextElement;
+
+//What a shape is painted with. Backends take what they need: the Direct2D one looks up
+//the brushes and stroke style of geometry in the image, a backend without a device
+//works from the style.
+struct SVGPaint {
+	const SVGGraphicsElement& element;
+	//Style the shape is drawn with. Not always the computed style of the element, see SVGStyleSet.
+	const ComputedStyle& style;
+	//Entry of the shape in dom.geometries, which is also its entry in the assets of a bound image
+	uint32_t geometry;
+};
+
+//Receives the drawing operations of an image. SVG::render() walks the document and calls
+//these, so a backend only has to know how to draw a handful of shapes and doesn't see
+//the element tree. Coordinates are in the local space of the shape.
+//Shapes are mapped to the target by the transform set with set_transform(), followed by
+//the transforms on the stack. push_transform() is called for each <use> instance.
+//A fill or stroke operation is only called if the style of the paint has a fill or a
+//stroke. The paint may still be one that the backend can't draw, like a missing gradient.
+class SVGRenderer {
+public:
+	virtual ~SVGRenderer() = default;
+
+	//Pushes transform, applied before the one on top of the stack
+	virtual void push_transform(const Matrix& transform) = 0;
+	virtual void pop_transform() = 0;
+	//Sets the transform of the shapes drawn next, applied before the top of the stack
+	virtual void set_transform(const Matrix& transform) = 0;
+
+	//rx and ry are 0 for a rectangle without rounded corners
+	virtual void fill_rect(float x, float y, float width, float height, float rx, float ry, const SVGPaint& paint) = 0;
+	virtual void stroke_rect(float x, float y, float width, float height, float rx, float ry, const SVGPaint& paint) = 0;
+	virtual void fill_ellipse(float cx, float cy, float rx, float ry, const SVGPaint& paint) = 0;
+	virtual void stroke_ellipse(float cx, float cy, float rx, float ry, const SVGPaint& paint) = 0;
+	virtual void stroke_line(float x1, float y1, float x2, float y2, const SVGPaint& paint) = 0;
+	virtual void fill_path(const SVGPathElement& path, const SVGPaint& paint) = 0;
+	virtual void stroke_path(const SVGPathElement& path, const SVGPaint& paint) = 0;
+	//Text is filled only
+	virtual void draw_text(const SVGTextElement& text, const SVGPaint& paint) = 0;
+};
+
+//Drops every operation. Rendering an image with it measures the cost of walking the document.
+class SVGNullRenderer : public SVGRenderer {
+public:
+	void push_transform(const Matrix&) override {}
+	void pop_transform() override {}
+	void set_transform(const Matrix&) override {}
+	void fill_rect(float, float, float, float, float, float, const SVGPaint&) override {}
+	void stroke_rect(float, float, float, float, float, float, const SVGPaint&) override {}
+	void fill_ellipse(float, float, float, float, const SVGPaint&) override {}
+	void stroke_ellipse(float, float, float, float, const SVGPaint&) override {}
+	void stroke_line(float, float, float, float, const SVGPaint&) override {}
+	void fill_path(const SVGPathElement&, const SVGPaint&) override {}
+	void stroke_path(const SVGPathElement&, const SVGPaint&) override {}
+	void draw_text(const SVGTextElement&, const SVGPaint&) override {}
+};
+
+//Number of operations of each kind that an SVGCountingRenderer received
+struct SVGRenderCounts {
+	size_t transforms_pushed = 0;
+	size_t transforms_set = 0;
+	size_t fills = 0;
+	size_t strokes = 0;
+	//Fills and strokes of paths. These are included in fills and strokes as well.
+	size_t paths = 0;
+	size_t texts = 0;
+};
+
+//Counts the operations instead of drawing them. For checking what a document draws
+//without a device, and how often the transform changes.
+class SVGCountingRenderer : public SVGRenderer {
+public:
+	SVGRenderCounts counts;
+
+	void push_transform(const Matrix&) override { ++counts.transforms_pushed; }
+	void pop_transform() override {}
+	void set_transform(const Matrix&) override { ++counts.transforms_set; }
+	void fill_rect(float, float, float, float, float, float, const SVGPaint&) override { ++counts.fills; }
+	void stroke_rect(float, float, float, float, float, float, const SVGPaint&) override { ++counts.strokes; }
+	void fill_ellipse(float, float, float, float, const SVGPaint&) override { ++counts.fills; }
+	void stroke_ellipse(float, float, float, float, const SVGPaint&) override { ++counts.strokes; }
+	void stroke_line(float, float, float, float, const SVGPaint&) override { ++counts.strokes; }
+	void fill_path(const SVGPathElement&, const SVGPaint&) override { ++counts.fills; ++counts.paths; }
+	void stroke_path(const SVGPathElement&, const SVGPaint&) override { ++counts.strokes; ++counts.paths; }
+	void draw_text(const SVGTextElement&, const SVGPaint&) override { ++counts.texts; }
+};
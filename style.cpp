@@ -0,0 +1,237 @@
+#include "document.h"
+#include "style.h"
+#include "utils.h"
+#include "number.h"
+#include "color.h"
+#include "length.h"
+
+//Style of the root element
+static const ComputedStyle initial_style;
+
+static void parse_paint(std::string_view value, Paint& paint, ColorCache& colors) {
+	std::string_view ref_id;
+
+	paint.url_id = std::string_view();
+
+	if (value == "none") {
+		paint.type = PaintType::None;
+	}
+	else if (colors.get_css_color(value, paint.color.r, paint.color.g, paint.color.b, paint.color.a)) {
+		//href and color can both start with #.
+		//Try to parse as color first, and if it fails, try to parse as reference.
+		paint.type = PaintType::Color;
+	}
+	else if (get_href_id(value, ref_id)) {
+		paint.type = PaintType::Url;
+		paint.url_id = ref_id;
+	}
+	else {
+		paint.type = PaintType::None;
+	}
+}
+
+static void parse_font_weight(std::string_view value, int& weight) {
+	if (value == "bold") {
+		weight = 700;
+	}
+	else if (value == "normal") {
+		weight = 400;
+	}
+	else if (value == "light") {
+		weight = 300;
+	}
+	else if (value == "semibold") {
+		weight = 600;
+	}
+	else if (value == "medium") {
+		weight = 500;
+	}
+	else if (value == "black") {
+		weight = 900;
+	}
+	else if (value == "thin") {
+		weight = 100;
+	}
+	else {
+		const char* p = value.data();
+		const char* end = p + value.length();
+		float w = 0.0f;
+
+		if (scan_number(p, end, w) && p == end && w >= 1.0f && w <= 1000.0f) {
+			weight = static_cast<int>(w);
+		}
+	}
+}
+
+//Sets one property of style from its specified value
+static void apply_property(ComputedStyle& style, const ComputedStyle& parent_style, Atom name, std::string_view value, const LengthContext& lengths, ColorCache& colors) {
+	switch (name) {
+	case Atom::Fill:
+		parse_paint(value, style.fill, colors);
+
+		break;
+	case Atom::Stroke:
+		parse_paint(value, style.stroke, colors);
+
+		break;
+	case Atom::FillRule:
+		if (value == "evenodd") {
+			style.fill_rule = FillRule::EvenOdd;
+		}
+		else if (value == "nonzero") {
+			style.fill_rule = FillRule::NonZero;
+		}
+
+		break;
+	case Atom::FillOpacity:
+		if (parse_number_or_percentage(value, style.fill_opacity)) {
+			style.has_fill_opacity = true;
+		}
+
+		break;
+	case Atom::Opacity:
+		parse_number_or_percentage(value, style.opacity);
+
+		break;
+	case Atom::StrokeOpacity:
+		parse_number_or_percentage(value, style.stroke_opacity);
+
+		break;
+	case Atom::StrokeWidth:
+		parse_length(value, lengths, LengthAxis::Diagonal, style.stroke_width);
+
+		break;
+	case Atom::StrokeLinecap:
+		if (value == "round") {
+			style.stroke_linecap = LineCap::Round;
+		}
+		else if (value == "square") {
+			style.stroke_linecap = LineCap::Square;
+		}
+		else {
+			style.stroke_linecap = LineCap::Butt;
+		}
+
+		break;
+	case Atom::StrokeLinejoin:
+		if (value == "bevel") {
+			style.stroke_linejoin = LineJoin::Bevel;
+		}
+		else if (value == "round") {
+			style.stroke_linejoin = LineJoin::Round;
+		}
+		else {
+			style.stroke_linejoin = LineJoin::Miter;
+		}
+
+		break;
+	case Atom::StrokeMiterlimit:
+		parse_number_or_percentage(value, style.stroke_miterlimit);
+
+		break;
+	case Atom::StopColor: {
+		StyleColor color;
+
+		if (colors.get_css_color(value, color.r, color.g, color.b, color.a)) {
+			style.stop_color = color;
+		}
+
+		break;
+	}
+	case Atom::StopOpacity:
+		parse_number_or_percentage(value, style.stop_opacity);
+
+		break;
+	case Atom::FontFamily:
+		style.font_family = value;
+
+		break;
+	case Atom::FontWeight:
+		parse_font_weight(value, style.font_weight);
+
+		break;
+	case Atom::FontStyle:
+		if (value == "italic") {
+			style.font_style = FontStyle::Italic;
+		}
+		else if (value == "oblique") {
+			style.font_style = FontStyle::Oblique;
+		}
+		else if (value == "normal") {
+			style.font_style = FontStyle::Normal;
+		}
+
+		break;
+	case Atom::FontSize: {
+		float size;
+
+		//Both em and percentages are relative to the font size of the parent
+		if (parse_length(value, lengths, LengthAxis::None, size)) {
+			style.font_size = !value.empty() && value.back() == '%' ? size * parent_style.font_size : size;
+		}
+
+		break;
+	}
+	case Atom::WhiteSpace:
+		style.collapse_white_space = value == "normal";
+
+		break;
+	default:
+		break;
+	}
+}
+
+static bool same_color(const StyleColor& x, const StyleColor& y) {
+	return x.r == y.r && x.g == y.g && x.b == y.b && x.a == y.a;
+}
+
+static bool same_paint(const Paint& x, const Paint& y) {
+	return x.type == y.type &&
+		(x.type != PaintType::Color || same_color(x.color, y.color)) &&
+		(x.type != PaintType::Url || x.url_id == y.url_id);
+}
+
+bool ComputedStyle::operator==(const ComputedStyle& that) const {
+	return this == &that || (
+		same_paint(fill, that.fill) &&
+		same_paint(stroke, that.stroke) &&
+		fill_rule == that.fill_rule &&
+		fill_opacity == that.fill_opacity &&
+		has_fill_opacity == that.has_fill_opacity &&
+		opacity == that.opacity &&
+		stroke_opacity == that.stroke_opacity &&
+		stroke_width == that.stroke_width &&
+		stroke_linecap == that.stroke_linecap &&
+		stroke_linejoin == that.stroke_linejoin &&
+		stroke_miterlimit == that.stroke_miterlimit &&
+		same_color(stop_color, that.stop_color) &&
+		stop_opacity == that.stop_opacity &&
+		font_family == that.font_family &&
+		font_weight == that.font_weight &&
+		font_style == that.font_style &&
+		font_size == that.font_size &&
+		collapse_white_space == that.collapse_white_space);
+}
+
+const ComputedStyle* compute_style(
+	const ComputedStyle* parent_style,
+	const AtomMap& specified,
+	StyleContext& context) {
+	const ComputedStyle* inherited = parent_style ? parent_style : &initial_style;
+
+	if (specified.empty()) {
+		//Most elements don't set any presentation property. They share the parent style.
+		return inherited;
+	}
+
+	ComputedStyle* style = context.arena->create<ComputedStyle>(*inherited);
+	LengthContext lengths = context.lengths;
+
+	lengths.font_size = inherited->font_size;
+
+	for (const auto& property : specified.entries) {
+		apply_property(*style, *inherited, property.first, property.second, lengths, context.colors);
+	}
+
+	return style;
+}
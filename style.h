@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include "atoms.h"
+#include "color.h"
+#include "length.h"
+
+//An RGBA color with components in the 0 to 1 range.
+struct StyleColor {
+	float r = 0.0f, g = 0.0f, b = 0.0f, a = 1.0f;
+};
+
+enum class PaintType : uint8_t {
+	None,
+	Color,
+	Url
+};
+
+//Value of the fill and stroke properties.
+struct Paint {
+	PaintType type = PaintType::None;
+	StyleColor color;
+	//Id of the referenced paint server, like a gradient, when type is Url.
+	//Points into the specified value, which is kept in the arena of the document.
+	std::string_view url_id;
+};
+
+enum class LineCap : uint8_t {
+	Butt,
+	Round,
+	Square
+};
+
+enum class LineJoin : uint8_t {
+	Miter,
+	Round,
+	Bevel
+};
+
+enum class FillRule : uint8_t {
+	NonZero,
+	EvenOdd
+};
+
+enum class FontStyle : uint8_t {
+	Normal,
+	Italic,
+	Oblique
+};
+
+//The computed values of the presentation properties of an element. Values are
+//parsed once when the style is computed and not looked up again while
+//presentation assets are created. Initial values follow the SVG spec.
+//Strings point into the arena of the document, so a style has no destructor and
+//copying one never allocates.
+struct ComputedStyle {
+	Paint fill{ PaintType::Color };
+	Paint stroke;
+	FillRule fill_rule = FillRule::NonZero;
+	float fill_opacity = 1.0f;
+	//fill-opacity falls back to opacity when it is not specified anywhere up the tree
+	bool has_fill_opacity = false;
+	float opacity = 1.0f;
+	float stroke_opacity = 1.0f;
+	float stroke_width = 1.0f;
+	LineCap stroke_linecap = LineCap::Butt;
+	LineJoin stroke_linejoin = LineJoin::Miter;
+	float stroke_miterlimit = 4.0f;
+	StyleColor stop_color;
+	float stop_opacity = 1.0f;
+	std::string_view font_family = "Arial, sans-serif, Verdana";
+	int font_weight = 400;
+	FontStyle font_style = FontStyle::Normal;
+	float font_size = 12.0f;
+	bool collapse_white_space = true;
+
+	float get_fill_opacity() const { return has_fill_opacity ? fill_opacity : opacity; }
+
+	//How far the stroke reaches out of the outline of a shape, at most. Miter joins reach
+	//up to the miter limit and square caps to the corners of the square. 0 without a stroke.
+	float get_stroke_extent() const {
+		if (stroke.type == PaintType::None) {
+			return 0.0f;
+		}
+
+		float reach = stroke_linecap == LineCap::Square ? 1.41421356f : 1.0f;
+
+		if (stroke_linejoin == LineJoin::Miter && stroke_miterlimit > reach) {
+			reach = stroke_miterlimit;
+		}
+
+		return stroke_width / 2.0f * reach;
+	}
+
+	//True if all computed values are the same
+	bool operator==(const ComputedStyle& that) const;
+	bool operator!=(const ComputedStyle& that) const { return !(*this == that); }
+};
+
+//State shared by all style computations of a document.
+struct StyleContext {
+	//Computed styles are created here
+	Arena* arena = nullptr;
+	//Used to convert units like mm or pt to pixels
+	LengthContext lengths;
+	ColorCache colors;
+};
+
+//Computes the style of an element from the computed style of its parent and the
+//properties specified on the element itself. If the element specifies nothing the
+//parent style is returned as is and shared. A copy is only made in the arena of
+//the context when the element overrides something. A null parent means the element is the root.
+const ComputedStyle* compute_style(
+	const ComputedStyle* parent_style,
+	const AtomMap& specified,
+	StyleContext& context);
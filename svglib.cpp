@@ -1,993 +1,484 @@
-#include <sstream>
-#include <string_view>
-#include <stack>
-#include <xmllite.h>
-#include "svglib.h"
-#include "defs.h"
-#include "ellipse.h"
-#include "g.h"
-#include "line.h"
-#include "path.h"
-#include "rect.h"
-#include "circle.h"
-#include "text.h"
-#include "use.h"
-#include "gradient.h"
-#include "utils.h"
-
-void SVGImage::clear() {
-	root_element = nullptr;
-}
-
-SVGGraphicsElement::SVGGraphicsElement(const SVGGraphicsElement& that) 
-    : tag_name(that.tag_name),
-	points(that.points),
-	children(that.children),
-	stroke_width(that.stroke_width),
-	fill_brush(that.fill_brush),
-	stroke_brush(that.stroke_brush),
-	stroke_style(that.stroke_style),
-	combined_transform(that.combined_transform),
-	styles(that.styles),
-	bbox(that.bbox) {
-
-}
-
-std::shared_ptr<SVGGraphicsElement> SVGGraphicsElement::clone() const { 
-	return std::make_shared<SVGGraphicsElement>(*this); 
-}
-
-void SVGGraphicsElement::render_tree(const SVGDevice& device) const {
-	DEBUG_OUT(L"Rendering element: " << tag_name);
-
-	//Save the old transform
-	D2D1_MATRIX_3X2_F old_transform;
-
-	if (combined_transform) {
-		DEBUG_OUT(L"Applying transform");
-		device.device_context->GetTransform(&old_transform);
-
-		auto total_transform = combined_transform.value() * old_transform;
-
-		device.device_context->SetTransform(total_transform);
-	}
-
-	render(device);
-
-	//Render all child elements
-	for (const auto& child : children) {
-		child->render_tree(device);
-	}
-
-	if (combined_transform) {
-		DEBUG_OUT(L"Restoring transform");
-		device.device_context->SetTransform(old_transform);
-	}
-}
-
-void SVGGraphicsElement::compute_bbox() {
-	if (children.empty()) {
-		return;
-	}
-
-	bbox = children[0]->bbox;
-
-	for (const auto& child : children) {
-		bbox.left = child->bbox.left < bbox.left ? child->bbox.left : bbox.left;
-		bbox.top = child->bbox.top < bbox.top ? child->bbox.top : bbox.top;
-		bbox.right = child->bbox.right > bbox.right ? child->bbox.right : bbox.right;
-		bbox.bottom = child->bbox.bottom > bbox.bottom ? child->bbox.bottom : bbox.bottom;
-	}
-}
-
-bool get_element_name(IXmlReader *pReader, std::wstring_view& name) {
-	const wchar_t* local_name = nullptr;
-	UINT len;
-
-	HRESULT hr = pReader->GetLocalName(&local_name, &len);
-
-	if (!SUCCEEDED(hr) || local_name == nullptr) {
-		return false;
-	}
-
-	name = std::wstring_view(local_name, len);
-
-	return true;
-}
-
-
-//A simple parser for inline CSS styles.
-void parse_css_style_string(std::wstring_view styleStr, std::map<std::wstring, std::wstring>& styles) {
-	std::vector<std::wstring_view> declarations = split_string(styleStr, L";");
-
-	for (const auto& decl : declarations) {
-		size_t colonPos = decl.find(L':');
-		if (colonPos != std::wstring_view::npos) {
-			std::wstring_view property = decl.substr(0, colonPos);
-			std::wstring_view value = decl.substr(colonPos + 1);
-			
-			ltrim_str(property);
-			ltrim_str(value);
-
-			if (!property.empty() && !value.empty()) {
-				styles[std::wstring(property)] = std::wstring(value);
-			}
-		}
-	}
-}
-
-//Presentation attributes like fill and stroke are special. They could be inherited from the parents.
-//They may also be supplied as CSS styles in the style attribute. 
-//This function saves a handful of presentation attributes by collecting them from XML tag attributes as well
-//as from the CSS style.
-void save_presentation_attributes(IXmlReader* pReader, std::shared_ptr<SVGGraphicsElement>& new_element) {
-	std::wstring_view style_str;
-
-	if (get_attribute(pReader, L"style", style_str)) {
-		parse_css_style_string(style_str, new_element->styles);
-	}
-
-	//Attribute values override styles in the "style" attribute.
-	const wchar_t* presentation_attributes[] = {
-		L"fill", 
-		L"fill-opacity", 
-		L"opacity",
-		L"stroke-opacity",
-		L"stroke-linecap",
-		L"stroke-linejoin",
-		L"stroke-miterlimit",
-		L"stroke", 
-		L"stop-color",
-		L"stop-opacity",
-		L"stroke-width", 
-		L"font-family", 
-		L"font-size", 
-		L"font-weight", 
-		L"font-style"
-	};
-
-	for (const wchar_t* attr_name : presentation_attributes) {
-		std::wstring_view attr_value;
-
-		if (get_attribute(pReader, attr_name, attr_value)) {
-			new_element->styles[std::wstring(attr_name)] = std::wstring(attr_value);
-		}
-	}
-}
-
-//Save all attributes for later processing
-void save_all_attributes(IXmlReader* pReader, std::shared_ptr<SVGGraphicsElement> element) {
-	const wchar_t* local_name = nullptr;
-	const wchar_t* attr_value = nullptr;
-	UINT len;
-	HRESULT hr = pReader->MoveToFirstAttribute();
-	
-	while (hr == S_OK) {
-		hr = pReader->GetLocalName(&local_name, &len);
-
-		if (!SUCCEEDED(hr) || local_name == nullptr) {
-			break;
-		}
-
-		std::wstring attr_name(local_name, len);
-
-		hr = pReader->GetValue(&attr_value, NULL);
-
-		if (!SUCCEEDED(hr) || attr_value == nullptr) {
-			break;
-		}
-
-		element->attributes[attr_name] = std::wstring(attr_value);
-
-		hr = pReader->MoveToNextAttribute();
-	}
-}
-
-bool SVGGraphicsElement::get_style_computed(const std::vector<std::shared_ptr<SVGGraphicsElement>>& parent_stack, const std::wstring& style_name, std::wstring& style_value) {
-	auto it = styles.find(style_name);
-
-	if (it != styles.end()) {
-		style_value = it->second;
-
-		return true;
-	}
-
-	//If the style is not defined on the current element, check the parent elements
-	//Loop through parent stack from top to bottom (for a vector: back to front)
-	for (auto it = parent_stack.rbegin(); it != parent_stack.rend(); ++it) {
-		const auto& parent = *it;
-		auto styleIt = parent->styles.find(style_name);
-
-		if (styleIt != parent->styles.end()) {
-			style_value = styleIt->second;
-
-			return true;
-		}
-	}
-
-	return false;
-}
-
-void SVGGraphicsElement::get_style_computed(const std::vector<std::shared_ptr<SVGGraphicsElement>>& parent_stack, const std::wstring& style_name, std::wstring& style_value, const std::wstring& default_value) {
-	if (!get_style_computed(parent_stack, style_name, style_value)) {
-		style_value = default_value;
-	}
-}
-
-bool SVGGraphicsElement::get_attribute_in_references(const std::vector<std::shared_ptr<SVGGraphicsElement>>& chain, const std::wstring& attr_name, std::wstring& attr_value) const {
-	auto it = attributes.find(attr_name);
-
-	if (it != attributes.end()) {
-		attr_value = it->second;
-
-		return true;
-	}
-
-	for (auto& element : chain) {
-		auto it = element->attributes.find(attr_name);
-
-		if (it != element->attributes.end()) {
-			attr_value = it->second;
-
-			return true;
-		}
-	}
-
-	return false;
-}
-
-bool apply_viewbox(ID2D1DeviceContext* device_context, std::shared_ptr<SVGGraphicsElement> e, IXmlReader* pReader) {
-	//Default viewport width and height
-	float width = device_context->GetSize().width, height = device_context->GetSize().height;
-	float vb_x = 0.0f, vb_y = 0.0f, vb_width = width, vb_height = height;
-
-	//Read width and height attributes
-	get_size_attribute(pReader, device_context, L"width", width);
-	get_size_attribute(pReader, device_context, L"height", height);
-
-	std::wstring_view viewBoxStr;
-	std::wstringstream ws;
-
-	if (get_attribute(pReader, L"viewBox", viewBoxStr)) {
-		//Replace comma with spaces
-		for (wchar_t ch : viewBoxStr) {
-			if (ch == L',') {
-				ch = L' ';
-			}
-
-			ws << ch;
-		}
-
-		//Parse viewBox attribute.
-		//For now expect all four values to be present.
-		if (!(ws >> vb_x >> vb_y >> vb_width >> vb_height)) {
-			return false;
-		}
-
-		if (vb_width <= 0.0f || vb_height <= 0.0f) {
-			return false;
-		}
-
-		//Calculate scale factors
-		float scale_x = width / vb_width;
-		float scale_y = height / vb_height;
-		float scale = scale_x < scale_y ? scale_x : scale_y;
-
-		//Create transform matrix
-		D2D1_MATRIX_3X2_F viewboxTransform = D2D1::Matrix3x2F::Translation(-vb_x, -vb_y) *
-			D2D1::Matrix3x2F::Scale(scale, scale);
-		e->combined_transform = viewboxTransform;
-
-		return true;
-	}
-	else {
-		return false;
-	}
-}
-
-void SVGGraphicsElement::create_presentation_assets(const std::vector<std::shared_ptr<SVGGraphicsElement>>& parent_stack, const std::map<std::wstring, std::shared_ptr<SVGGraphicsElement>>& id_map, const SVGDevice& device) {
-	std::wstring style_value;
-	HRESULT hr = S_OK;
-
-	//Set brushes
-	float stroke_opacity = 1.0f;
-
-	if (get_style_computed(parent_stack, L"stroke-opacity", style_value) &&
-		get_size_value(device.device_context, style_value, stroke_opacity)) {
-	}
-
-	get_style_computed(parent_stack, L"stroke", style_value, L"none");
-
-	if (style_value == L"none") {
-		this->stroke_brush = nullptr;
-	}
-	else {
-		std::wstring_view gradient_ref_id;
-		float r, g, b, a;
-
-		if (get_css_color(style_value, r, g, b, a)) {
-			CComPtr<ID2D1SolidColorBrush> brush;
-
-			hr = device.device_context->CreateSolidColorBrush(
-				D2D1::ColorF(r, g, b, a * stroke_opacity),
-				&brush
-			);
-
-			if (SUCCEEDED(hr)) {
-				this->stroke_brush = brush;
-			}
-		}
-		else if (get_href_id(style_value, gradient_ref_id)) {
-			auto it = id_map.find(std::wstring(gradient_ref_id));
-
-			if (it != id_map.end()) {
-				auto linear_gradient = std::dynamic_pointer_cast<SVGLinearGradientElement>(it->second);
-				auto radial_gradient = std::dynamic_pointer_cast<SVGRadialGradientElement>(it->second);
-
-				if (linear_gradient) {
-					this->stroke_brush = create_linear_gradient_brush(device, parent_stack, id_map, *linear_gradient, *this);
-				} 
-				else if (radial_gradient) {
-					this->stroke_brush = create_radial_gradient_brush(device, parent_stack, id_map, *radial_gradient, *this);
-				}
-			}
-		}
-
-		D2D1_CAP_STYLE cap_style = D2D1_CAP_STYLE_FLAT;
-
-		if (get_style_computed(parent_stack, L"stroke-linecap", style_value)) {
-			if (style_value == L"round") {
-				cap_style = D2D1_CAP_STYLE_ROUND;
-			}
-			else if (style_value == L"square") {
-				cap_style = D2D1_CAP_STYLE_SQUARE;
-			}
-		}
-
-		D2D1_LINE_JOIN line_join = D2D1_LINE_JOIN_MITER;
-
-		if (get_style_computed(parent_stack, L"stroke-linejoin", style_value)) {
-			if (style_value == L"bevel") {
-				line_join = D2D1_LINE_JOIN_BEVEL;
-			}
-			else if (style_value == L"round") {
-				line_join = D2D1_LINE_JOIN_ROUND;
-			}
-		}
-
-		float miter_limit = 4.0f;
-
-		if (get_style_computed(parent_stack, L"stroke-miterlimit", style_value) &&
-			get_size_value(device.device_context, style_value, miter_limit)) {
-		}
-
-		D2D1_STROKE_STYLE_PROPERTIES stroke_properties = D2D1::StrokeStyleProperties(
-			cap_style,     // Start cap
-			cap_style,     // End cap
-			D2D1_CAP_STYLE_ROUND,    // Dash cap
-			line_join,    // Line join
-			miter_limit//,                   // Miter limit
-			//D2D1_DASH_STYLE_CUSTOM,  // Dash style
-			//0.0f                     // Dash offset
-		);
-
-		CComPtr<ID2D1StrokeStyle> ss;
-
-		hr = device.d2d_factory->CreateStrokeStyle(
-			&stroke_properties,
-			nullptr,
-			0,
-			&ss
-		);
-
-		if (SUCCEEDED(hr)) {
-			this->stroke_style = ss;
-		}
-	}
-
-	//Get fill opacity
-	//TBD: We read this as a size, even though only % and plain numbers are allowed.
-	float fill_opacity = 1.0f;
-
-	if ((get_style_computed(parent_stack, L"fill-opacity", style_value) || get_style_computed(parent_stack, L"opacity", style_value)) &&
-		get_size_value(device.device_context, style_value, fill_opacity)) {
-	}
-
-	//Get fill
-	get_style_computed(parent_stack, L"fill", style_value, L"black");
-	std::wstring_view gradient_ref_id;
-	float r, g, b, a;
-
-	//href and color can both start with #.
-	//Try to parse as color first, and if it fails, try to parse as reference.
-
-	if (style_value == L"none") {
-		this->fill_brush = nullptr;
-	} 
-	else if (get_css_color(style_value, r, g, b, a)) {
-		CComPtr<ID2D1SolidColorBrush> brush;
-
-		hr = device.device_context->CreateSolidColorBrush(
-			D2D1::ColorF(r, g, b, a * fill_opacity),
-			&brush
-		);
-		if (SUCCEEDED(hr)) {
-			this->fill_brush = brush;
-		}
-	}
-	else if (get_href_id(style_value, gradient_ref_id)) {
-		auto it = id_map.find(std::wstring(gradient_ref_id));
-
-		if (it != id_map.end()) {
-			auto linear_gradient = std::dynamic_pointer_cast<SVGLinearGradientElement>(it->second);
-			auto radial_gradient = std::dynamic_pointer_cast<SVGRadialGradientElement>(it->second);
-
-			if (linear_gradient) {
-				this->fill_brush = create_linear_gradient_brush(device, parent_stack, id_map, *linear_gradient, *this);
-			} else if (radial_gradient) {
-				this->fill_brush = create_radial_gradient_brush(device, parent_stack, id_map, *radial_gradient, *this);
-			}
-		}
-	}
-
-	//Get stroke width
-	float w;
-
-	if (get_style_computed(parent_stack, L"stroke-width", style_value) &&
-		get_size_value(device.device_context, style_value, w)) {
-		this->stroke_width = w;
-	}
-}
-
-void resolve_href(const std::shared_ptr<SVGGraphicsElement>& element, 
-	std::vector<std::shared_ptr<SVGGraphicsElement>>& parent_stack,
-	const std::map<std::wstring, std::shared_ptr<SVGGraphicsElement>>& id_map, 
-	const std::map<std::wstring, std::shared_ptr<SVGGraphicsElement>>& defs_map,
-	const SVGDevice& device) {
-
-	if (!element) {
-		return; //Branch is skipped
-	}
-
-	element->create_presentation_assets(parent_stack, id_map, device);
-
-	parent_stack.push_back(element);
-
-	for (size_t i = 0; i < element->children.size(); ++i) {
-		auto& child = element->children[i];
-
-		if (child->tag_name == L"use") {
-			//Cast to use element to get the reference
-			auto use_element = std::dynamic_pointer_cast<SVGUseElement>(child);
-			
-			if (use_element) {
-				std::shared_ptr<SVGGraphicsElement> referenced_element;
-				auto id_it = id_map.find(use_element->href_id);
-				
-				if (id_it != id_map.end()) {
-					referenced_element = id_it->second;
-				}
-
-				if (referenced_element) {
-					//Clone the referenced element and replace the <use> element with it
-					element->children[i] = referenced_element->clone();
-				}
-				else {
-					continue; //skip branch if reference is not found
-				}
-			}
-		}
-
-		resolve_href(element->children[i], parent_stack, id_map, defs_map, device);
-	}
-
-	parent_stack.pop_back();
-}
-
-bool SVG::load(const wchar_t* file_name, const SVGDevice& device, SVGImage& image) {
-	CComPtr<IXmlReader> xml_reader;
-
-	HRESULT hr = ::CreateXmlReader(__uuidof(IXmlReader), (void**)&xml_reader, NULL);
-
-	if (!SUCCEEDED(hr)) {
-		return false;
-	}
-
-	CComPtr<IStream> file_stream;
-
-	hr = ::SHCreateStreamOnFileEx(file_name, 
-		STGM_READ | STGM_SHARE_DENY_WRITE, FILE_ATTRIBUTE_NORMAL, FALSE, NULL, 
-		&file_stream);
-	
-	if (!SUCCEEDED(hr)) {
-		return false;
-	}
-
-	hr = xml_reader->SetInput(file_stream);
-
-	if (!SUCCEEDED(hr)) {
-		return false;
-	}
-
-	//Clear previous image
-	image.clear();
-
-	std::vector<std::shared_ptr<SVGGraphicsElement>> parent_stack;
-	std::map<std::wstring, std::shared_ptr<SVGGraphicsElement>> id_map;
-	std::map<std::wstring, std::shared_ptr<SVGGraphicsElement>> defs_map;
-
-	while (true) {
-		XmlNodeType node_type;
-
-		hr = xml_reader->Read(&node_type);
-
-		if (hr == S_FALSE) {
-			break; //End of file
-		}
-
-		if (!SUCCEEDED(hr)) {
-			return false;
-		}
-
-		if (node_type == XmlNodeType_Element) {
-			//We must call IsEmptyElement before reading
-			//any attributes!!!
-			bool is_self_closing = xml_reader->IsEmptyElement();
-
-			std::wstring_view element_name, attr_value;
-
-			if (!get_element_name(xml_reader, element_name)) {
-				return false;
-			}
-
-			std::shared_ptr<SVGGraphicsElement> parent_element;
-			std::shared_ptr<SVGGraphicsElement> new_element;
-
-			if (!parent_stack.empty()) {
-				parent_element = parent_stack.back();
-			}
-
-			if (element_name == L"svg") {
-				new_element = std::make_shared<SVGGraphicsElement>();
-
-				if (!image.root_element)
-				{
-					//This is the root <svg> element
-					image.root_element = new_element;
-				}
-				else {
-					//Inner svg elements have some special treatment
-					float x = 0.0f, y = 0.0f, width = 100.0f, height = 100.0f;
-
-					if (get_size_attribute(xml_reader, device.device_context, L"x", x) &&
-						get_size_attribute(xml_reader, device.device_context, L"y", y)) {
-						//Position the inner SVG element
-						new_element->combined_transform = D2D1::Matrix3x2F::Translation(x, y);
-					}
-				}
-
-				apply_viewbox(device.device_context, new_element, xml_reader);
-			}
-			else if (element_name == L"rect") {
-				float x = 0.0f, y = 0.0f, width = 0.0f, height = 0.0f, rx = 0.0f, ry = 0.0f;
-
-				get_size_attribute(xml_reader, device.device_context, L"x", x);
-				get_size_attribute(xml_reader, device.device_context, L"y", y);
-				get_size_attribute(xml_reader, device.device_context, L"width", width);
-				get_size_attribute(xml_reader, device.device_context, L"height", height);
-
-				new_element = std::make_shared<SVGRectElement>();
-
-				new_element->points.push_back(x);
-				new_element->points.push_back(y);
-				new_element->points.push_back(width);
-				new_element->points.push_back(height);
-
-				bool has_rx = get_size_attribute(xml_reader, device.device_context, L"rx", rx);
-				bool has_ry = get_size_attribute(xml_reader, device.device_context, L"ry", ry);
-
-				if (has_rx || has_ry) {
-					if (!has_rx) {
-						rx = ry;
-					}
-					if (!has_ry) {
-						ry = rx;
-					}
-
-					new_element->points.push_back(rx);
-					new_element->points.push_back(ry);
-				}
-			}
-			else if (element_name == L"circle") {
-				float cx = 0.0f, cy = 0.0f, r = 0.0f;
-
-				get_size_attribute(xml_reader, device.device_context, L"cx", cx);
-				get_size_attribute(xml_reader, device.device_context, L"cy", cy);
-				get_size_attribute(xml_reader, device.device_context, L"r", r);
-
-				auto circle_element = std::make_shared<SVGCircleElement>();
-
-				circle_element->points.push_back(cx);
-				circle_element->points.push_back(cy);
-				circle_element->points.push_back(r);
-
-				new_element = circle_element;
-			}
-			else if (element_name == L"ellipse") {
-				float cx, cy, rx, ry;
-
-				if (!get_size_attribute(xml_reader, device.device_context, L"cx", cx)) {
-					cx = 0.0f;
-				}
-
-				if (!get_size_attribute(xml_reader, device.device_context, L"cy", cy)) {
-					cy = 0.0f;
-				}
-
-				if (get_size_attribute(xml_reader, device.device_context, L"rx", rx) &&
-					get_size_attribute(xml_reader, device.device_context, L"ry", ry)) {
-					
-					auto ellipse_element = std::make_shared<SVGEllipseElement>();
-
-					ellipse_element->points.push_back(cx);
-					ellipse_element->points.push_back(cy);
-					ellipse_element->points.push_back(rx);
-					ellipse_element->points.push_back(ry);
-
-					new_element = ellipse_element;
-				}
-			}
-			else if (element_name == L"path") {
-				if (get_attribute(xml_reader, L"d", attr_value)) {
-					auto path_element = std::make_shared<SVGPathElement>();
-
-					path_element->build_path(device.d2d_factory, attr_value);
-					new_element = path_element;
-				}
-			}
-			else if (element_name == L"polyline") {
-				if (get_attribute(xml_reader, L"points", attr_value)) {
-					auto polyline_element = std::make_shared<SVGPathElement>();
-					std::wstring path_data(L"M");
-					
-					path_data += attr_value;
-					
-					polyline_element->build_path(device.d2d_factory, path_data);
-
-					new_element = polyline_element;
-				}
-			}
-			else if (element_name == L"polygon") {
-				if (get_attribute(xml_reader, L"points", attr_value)) {
-					auto polygon_element = std::make_shared<SVGPathElement>();
-					std::wstring path_data(L"M");
-
-					path_data.append(attr_value);
-					path_data.append(L"Z");
-
-					polygon_element->build_path(device.d2d_factory, path_data);
-
-					new_element = polygon_element;
-				}
-			}
-
-			else if (element_name == L"group" || element_name == L"g") {
-				new_element = std::make_shared<SVGGElement>();
-			} else if (element_name == L"line") {
-				float x1, y1, x2, y2;
-
-				if (get_size_attribute(xml_reader, device.device_context, L"x1", x1) &&
-					get_size_attribute(xml_reader, device.device_context, L"y1", y1) &&
-					get_size_attribute(xml_reader, device.device_context, L"x2", x2) &&
-					get_size_attribute(xml_reader, device.device_context, L"y2", y2)) {
-					
-					auto line_element = std::make_shared<SVGLineElement>();
-
-					line_element->points.push_back(x1);
-					line_element->points.push_back(y1);
-					line_element->points.push_back(x2);
-					line_element->points.push_back(y2);
-
-					new_element = line_element;
-				}
-			}
-			else if (element_name == L"text") {
-				auto text_element = std::make_shared<SVGTextElement>();
-				float x = 0, y = 0;
-
-				get_size_attribute(xml_reader, device.device_context, L"x", x);
-				get_size_attribute(xml_reader, device.device_context, L"y", y);
-
-				text_element->points.push_back(x);
-				text_element->points.push_back(y);
-
-				text_element->dwrite_factory = device.dwrite_factory;
-
-				new_element = text_element;
-			}
-			else if (element_name == L"defs") {
-				new_element = std::make_shared<SVGDefsElement>();
-			}
-			else if (element_name == L"use") {
-				auto use_element = std::make_shared<SVGUseElement>();
-
-				if (get_href_id(xml_reader, attr_value)) {
-					use_element->href_id = attr_value;
-					new_element = use_element;
-				}
-			}
-			else if (element_name == L"linearGradient") {
-				auto linear_gradient = std::make_shared<SVGLinearGradientElement>();
-				
-				//Gradient attrubutes like x1, y1 are special since they could be inherited
-				//from a reference chain. We can't do that until we resolve the references, 
-				// so we save them as attributes for now and process them later in create_presentation_assets.
-				save_all_attributes(xml_reader, linear_gradient);
-
-				new_element = linear_gradient;
-			}
-			else if (element_name == L"radialGradient") {
-				auto radial_gradient = std::make_shared<SVGRadialGradientElement>();
-				
-				//Gradient attrubutes like cx, cy are special since they could be inherited
-				//from a reference chain. We can't do that until we resolve the references, 
-				// so we save them as attributes for now and process them later in create_presentation_assets.
-				save_all_attributes(xml_reader, radial_gradient);
-
-				new_element = radial_gradient;
-			}
-			else if (element_name == L"stop") {
-				auto stop_element = std::make_shared<SVGStopElement>();
-				float offset = 0;
-
-				get_size_attribute(xml_reader, device.device_context, L"offset", offset);
-
-				stop_element->offset = offset;
-
-				new_element = stop_element;
-			}
-			else {
-				//Unknown element
-				new_element = std::make_shared<SVGGraphicsElement>();
-			}
-
-			if (new_element) {
-				new_element->tag_name = element_name;
-
-				if (get_attribute(xml_reader, L"id", attr_value)) {
-					std::wstring id(attr_value);
-
-					id_map[id] = new_element;
-
-					if (parent_element && parent_element->tag_name == L"defs") {
-						defs_map[id] = new_element;
-					}
-				}
-
-				//Transform is not inherited
-				if (get_attribute(xml_reader, L"transform", attr_value)) {
-					D2D1_MATRIX_3X2_F trans = D2D1::Matrix3x2F::Identity();
-
-					//If the element already has a transform (like inner <svg>), combine them
-					if (new_element->combined_transform)
-					{
-						trans = new_element->combined_transform.value();
-					}
-
-					if (build_transform_matrix(attr_value, trans)) {
-						new_element->combined_transform = trans;
-					}
-				}
-
-				if (get_attribute(xml_reader, L"gradientTransform", attr_value)) {
-					D2D1_MATRIX_3X2_F trans = D2D1::Matrix3x2F::Identity();
-
-					//If the element already has a transform (like inner <svg>), combine them
-					if (new_element->combined_transform)
-					{
-						trans = new_element->combined_transform.value();
-					}
-
-					if (build_transform_matrix(attr_value, trans)) {
-						new_element->combined_transform = trans;
-					}
-				}
-
-				save_presentation_attributes(xml_reader, new_element);
-
-				if (parent_element) {
-					//Add the new element to its parent
-					DEBUG_OUT(L"Parent::Child: " << parent_element->tag_name << L"::" << element_name);
-
-					parent_element->children.push_back(new_element);
-				}
-			}
-
-			if (is_self_closing) {
-				//This is the end of the element
-
-				if (new_element) {
-					new_element->compute_bbox();
-				}
-			}
-			else {
-				//Push the new element onto the stack
-				//This may be null if the element is not supported
-				parent_stack.push_back(new_element);
-			}
-		}
-		else if (node_type == XmlNodeType_Text) {
-			if (parent_stack.empty()) {
-				return false;
-			}
-
-			std::shared_ptr<SVGGraphicsElement> parent_element = parent_stack.back();
-
-			//If the parent is a text then cast it to SVGTextElement
-			if (!parent_element || parent_element->tag_name != L"text") {
-				continue; //Text nodes are only valid inside <text> elements
-			}
-
-			auto text_element = std::dynamic_pointer_cast<SVGTextElement>(parent_element);
-
-			if (!text_element) {
-				return false;
-			}
-
-			const wchar_t* pwszValue = NULL;
-			UINT32 len;
-
-			hr = xml_reader->GetValue(&pwszValue, &len);
-
-			if (!SUCCEEDED(hr) || pwszValue == nullptr) {
-				return false;
-			}
-
-			//Collapse white space if needed.
-			std::wstring style_value;
-
-			text_element->get_style_computed(parent_stack, L"white-space", style_value, L"normal");
-
-			if (style_value == L"normal") {
-				std::wstring_view source(pwszValue, len);
-
-				collapse_whitespace(source, text_element->text_content);
-			}
-			else {
-				text_element->text_content.assign(pwszValue, len);
-			}
-		}
-		else if (node_type == XmlNodeType_EndElement) {
-			std::wstring_view element_name;
-
-			if (!get_element_name(xml_reader, element_name)) {
-				return false;
-			}
-
-			DEBUG_OUT(L"End Element: " << element_name);
-
-			if (!parent_stack.empty()) {
-				//Now that all children are added
-				//we can calculate bbox.
-				auto element = parent_stack.back();
-
-				parent_stack.pop_back();
-
-				if (element) {
-					element->compute_bbox();
-				}
-			}
-		}
-
-	}
-
-	//Do a second pass to resolve references in styles (like fill="url(#gradient1)")
-	parent_stack.clear();
-	resolve_href(image.root_element, parent_stack, id_map, defs_map, device);
-
-	return true;
-}
-
-// Render the loaded bitmap onto the window
-void SVG::render(const SVGDevice& device, const SVGImage& image)
-{
-	device.device_context->BeginDraw();
-
-	if (image.root_element) {
-		//Render the SVG element tree
-		image.root_element->render_tree(device);
-	}
-
-	device.device_context->EndDraw();
-}
-
-void SVG::render(const SVGDevice& device, const SVGImage& image, float x, float y, float scale)
-{
-	device.device_context->BeginDraw();
-
-	if (image.root_element) {
-		D2D1_MATRIX_3X2_F old_transform;
-		D2D1_MATRIX_3X2_F display_transform = D2D1::Matrix3x2F::Scale(scale, scale) * D2D1::Matrix3x2F::Translation(x, y);
-
-		device.device_context->GetTransform(&old_transform);
-
-		auto total_transform = display_transform * old_transform;
-
-		device.device_context->SetTransform(total_transform);
-
-		//Render the SVG element tree
-		image.root_element->render_tree(device);
-
-		device.device_context->SetTransform(old_transform);
-	}
-
-	device.device_context->EndDraw();
-}
-
-void SVG::clear(const SVGDevice& device, float red, float green, float blue, float alpha) {
-	device.device_context->BeginDraw();
-	device.device_context->Clear(D2D1::ColorF(red, green, blue, alpha));
-	device.device_context->EndDraw();
-}
-
-void SVGDevice::redraw()
-{
-	InvalidateRect(wnd, NULL, FALSE);
-}
-
-bool SVGDevice::init(HWND _wnd)
-{
-	wnd = _wnd;
-
-	HRESULT hr = D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED, &d2d_factory);
-
-	if (!SUCCEEDED(hr)) {
-		return false;
-	}
-
-	hr = DWriteCreateFactory(
-		DWRITE_FACTORY_TYPE_SHARED,
-		__uuidof(IDWriteFactory),
-		reinterpret_cast<IUnknown**>(&dwrite_factory)
-	);
-
-	if (!SUCCEEDED(hr)) {
-		return false;
-	}
-
-	// Create Render Target
-	RECT rc;
-
-	GetClientRect(_wnd, &rc);
-
-	hr = d2d_factory->CreateHwndRenderTarget(
-		D2D1::RenderTargetProperties(),
-		D2D1::HwndRenderTargetProperties(
-			_wnd,
-			D2D1::SizeU(rc.right - rc.left, rc.bottom - rc.top)
-		),
-		&render_target
-	);
-
-	if (!SUCCEEDED(hr)) {
-		return false;
-	}
-
-	//Get the device context from the render target
-	hr = render_target->QueryInterface(IID_PPV_ARGS(&device_context));
-
-	if (!SUCCEEDED(hr)) {
-		return false;
-	}
-
-	return true;
-}
-
-// Resize the render target when the window size changes
-void SVGDevice::resize()
-{
-	RECT rc;
-
-	GetClientRect(wnd, &rc);
-	render_target->Resize(D2D1::SizeU(rc.right - rc.left, rc.bottom - rc.top));
-}
+#include <atomic>
+#include <thread>
+#include "svglib.h"
+#include "document_reader.h"
+#include "mapped_file.h"
+#include "d2d_renderer.h"
+#include "d2d_assets.h"
+
+void SVGImage::clear() {
+	assets.clear();
+	SVGImageBase::clear();
+}
+
+void SVG::bind(std::shared_ptr<const SVGDocument> document, const SVGDevice& device, SVGImage& image) {
+	image.clear();
+
+	if (!document) {
+		return;
+	}
+
+	const SVGDom& dom = document->dom;
+
+	//Only shapes that get drawn have assets. Shapes in <defs> that no <use> element
+	//references get none, and neither do the gradients that only they paint with.
+	//Paint references like fill="url(#gradient1)" are resolved here.
+	std::vector<bool> drawn(dom.geometries.size());
+	std::vector<uint32_t> found;
+
+	find_drawn_geometries(dom, 0, static_cast<NodeIndex>(dom.size()), no_index, drawn, found);
+	image.assets.resize(dom.geometries.size());
+
+	for (uint32_t i : found) {
+		create_element_assets(*dom.geometries[i], *dom.styles[dom.geometry_style[i]], document->id_map, document->lengths, device, image.assets[i]);
+	}
+
+	compile_display_list(dom, image.display_list);
+	image.document = std::move(document);
+}
+
+void SVG::get_memory_report(const SVGImage& image, SVGMemoryReport& report) {
+	report = SVGMemoryReport();
+
+	if (!image.document) {
+		return;
+	}
+
+	for (const SVGGraphicsElement* element : image.document->dom.element) {
+		report.element_count += 1;
+		report.element_bytes += sizeof(*element) +
+			element->points.capacity() * sizeof(float) +
+			element->children.capacity() * sizeof(element->children[0]) +
+			element->styles.heap_size() +
+			element->attributes.heap_size();
+	}
+
+	report.arena_bytes = image.document->arena.reserved_bytes();
+
+	const SVGDom& dom = image.document->dom;
+
+	for (size_t i = 0; i < dom.geometries.size(); ++i) {
+		ElementKind kind = dom.geometries[i]->kind;
+
+		if (kind == ElementKind::Path || kind == ElementKind::Polyline || kind == ElementKind::Polygon) {
+			report.path_count += 1;
+			report.realized_path_count += i < image.assets.size() && image.assets[i].path_geometry ? 1 : 0;
+		}
+	}
+
+	for (const SVGElementAssets& assets : image.assets) {
+		report.brush_count += (assets.fill_brush ? 1 : 0) + (assets.stroke_brush ? 1 : 0);
+		report.stroke_style_count += assets.stroke_style ? 1 : 0;
+	}
+
+	report.display_list_bytes = image.display_list.ops.capacity() * sizeof(SVGDrawOp) +
+		image.display_list.transforms.capacity() * sizeof(Matrix) +
+		image.display_list.groups.capacity() * sizeof(SVGDisplayGroup) +
+		image.display_list.index.get_memory_size();
+
+	std::vector<bool> drawn(dom.geometries.size());
+	std::vector<uint32_t> found;
+
+	find_drawn_geometries(dom, 0, static_cast<NodeIndex>(dom.size()), no_index, drawn, found);
+
+	for (size_t i = 0; i < dom.geometries.size(); ++i) {
+		if (!drawn[i]) {
+			const ComputedStyle& style = *dom.styles[dom.geometry_style[i]];
+
+			report.skipped_brush_count += (style.fill.type != PaintType::None ? 1 : 0) + (style.stroke.type != PaintType::None ? 1 : 0);
+			report.skipped_stroke_style_count += style.stroke.type != PaintType::None ? 1 : 0;
+		}
+	}
+}
+
+bool SVG::load_from_memory(const void* data, size_t size, const SVGDevice& device, SVGImage& image) {
+	auto document = std::make_shared<SVGDocument>();
+
+	if (!parse_from_memory(data, size, *document, device.get_lengths())) {
+		image.clear();
+
+		return false;
+	}
+
+	bind(std::move(document), device, image);
+
+	return true;
+}
+
+bool SVG::load(const wchar_t* file_name, const SVGDevice& device, SVGImage& image) {
+	MappedFile file;
+
+	if (!file.open(file_name)) {
+		image.clear();
+
+		return false;
+	}
+
+	return load_from_memory(file.data, file.size, device, image);
+}
+
+size_t SVG::load_batch(const wchar_t* const file_names[], size_t count, const SVGDevice& device, SVGImage images[], bool results[], unsigned max_threads) {
+	//The device is only read here, on the calling thread
+	LengthContext lengths = device.get_lengths();
+	std::vector<std::shared_ptr<SVGDocument>> documents(count);
+	std::atomic<size_t> next_file{ 0 };
+
+	//Each thread takes the next file that nobody has started on
+	auto parse_files = [&]() {
+		for (size_t i = next_file++; i < count; i = next_file++) {
+			auto document = std::make_shared<SVGDocument>();
+
+			if (parse(file_names[i], *document, lengths)) {
+				documents[i] = std::move(document);
+			}
+		}
+	};
+
+	unsigned thread_count = max_threads ? max_threads : std::thread::hardware_concurrency();
+
+	if (thread_count == 0) {
+		thread_count = 1;
+	}
+
+	if (thread_count > count) {
+		thread_count = static_cast<unsigned>(count);
+	}
+
+	std::vector<std::thread> threads;
+
+	for (unsigned i = 1; i < thread_count; ++i) {
+		threads.emplace_back(parse_files);
+	}
+
+	parse_files();
+
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	//Direct2D and DirectWrite objects are created on the thread that owns the device
+	size_t loaded = 0;
+
+	for (size_t i = 0; i < count; ++i) {
+		results[i] = documents[i] != nullptr;
+
+		if (results[i]) {
+			bind(std::move(documents[i]), device, images[i]);
+			++loaded;
+		}
+		else {
+			images[i].clear();
+		}
+	}
+
+	return loaded;
+}
+
+struct SVGStreamState {
+	MappedFile file;
+	//The document converted to UTF-8, if it was not already
+	std::string converted;
+	std::shared_ptr<SVGDocument> document = std::make_shared<SVGDocument>();
+	SVGDomBuilder dom_builder{ document->dom };
+	std::unique_ptr<DocumentReader> reader;
+	//Nodes whose shapes were given assets in the image, if they are drawn
+	NodeIndex bound_nodes = 0;
+	//Entries of dom.geometries that are drawn and have assets
+	std::vector<bool> drawn;
+	//Shapes painted with url(). Their assets are created again at the end, since the
+	//gradient, or a gradient it refers to, may not have been read when they were bound.
+	std::vector<uint32_t> url_painted;
+};
+
+SVGStreamLoader::SVGStreamLoader() = default;
+
+SVGStreamLoader::~SVGStreamLoader() = default;
+
+bool SVGStreamLoader::open(const wchar_t* file_name, const SVGDevice& device) {
+	close();
+
+	auto new_state = std::make_unique<SVGStreamState>();
+	std::string_view utf8;
+
+	if (!new_state->file.open(file_name) || !get_utf8(new_state->file.data, new_state->file.size, new_state->converted, utf8)) {
+		return false;
+	}
+
+	new_state->document->dom.reserve(count_start_tags(utf8));
+	new_state->reader = std::make_unique<DocumentReader>(utf8.data(), utf8.size(), device.get_lengths(), *new_state->document, &new_state->dom_builder);
+	state = std::move(new_state);
+
+	return true;
+}
+
+//True if node is inside a <defs> or <symbol> element, whose content is not drawn where it is
+static bool is_in_definition(const SVGDom& dom, NodeIndex node) {
+	for (NodeIndex p = dom.parent[node]; p != no_index; p = dom.parent[p]) {
+		if (dom.kind[p] == ElementKind::Defs || dom.kind[p] == ElementKind::Symbol) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//Makes everything read so far ready to render in image
+static void bind_new_shapes(SVGStreamState& state, const SVGDevice& device, SVGImage& image) {
+	SVGDocument& document = *state.document;
+	const SVGDom& dom = document.dom;
+
+	if (image.document != state.document) {
+		image.clear();
+		image.document = state.document;
+		state.bound_nodes = 0;
+		state.drawn.clear();
+		state.url_painted.clear();
+	}
+
+	document.lengths = state.reader->lengths();
+	state.dom_builder.extend_open_nodes();
+	image.assets.resize(dom.geometries.size());
+	state.drawn.resize(dom.geometries.size());
+
+	//Shapes drawn by the new nodes. That includes shapes read earlier that a new <use>
+	//element draws. Each subtree that starts in the new nodes is searched once.
+	std::vector<uint32_t> found;
+
+	for (NodeIndex i = state.bound_nodes; i < dom.size(); i = dom.subtree_end[i]) {
+		if (!is_in_definition(dom, i)) {
+			find_drawn_geometries(dom, i, dom.subtree_end[i], no_index, state.drawn, found);
+		}
+	}
+
+	for (uint32_t i : found) {
+		const ComputedStyle& style = *dom.styles[dom.geometry_style[i]];
+
+		create_element_assets(*dom.geometries[i], style, document.id_map, document.lengths, device, image.assets[i]);
+
+		if (style.fill.type == PaintType::Url || style.stroke.type == PaintType::Url) {
+			state.url_painted.push_back(i);
+		}
+	}
+
+	state.bound_nodes = static_cast<NodeIndex>(dom.size());
+}
+
+SVGLoadStatus SVGStreamLoader::load_more(const SVGDevice& device, SVGImage& image, size_t element_count) {
+	if (!state || !state->reader) {
+		return SVGLoadStatus::Failed;
+	}
+
+	DocumentReader& reader = *state->reader;
+	size_t stop_at = reader.element_count() + element_count;
+
+	while (true) {
+		XmlToken token = reader.next();
+
+		if (token == XmlToken::Error) {
+			close();
+			image.clear();
+
+			return SVGLoadStatus::Failed;
+		}
+
+		if (token == XmlToken::EndOfDocument) {
+			break;
+		}
+
+		//A shape is only complete after its end tag, like the content of a <text>
+		if (reader.element_count() >= stop_at && !state->dom_builder.has_open_shape()) {
+			bind_new_shapes(*state, device, image);
+
+			return SVGLoadStatus::Loading;
+		}
+	}
+
+	if (reader.deferred_use_count() > 0) {
+		//Instances made so far may draw subtrees with these <use> elements in them. Make them all again.
+		reader.finish();
+		SVG::bind(state->document, device, image);
+	}
+	else {
+		//The dom is complete. Only paint references may still need resolving.
+		bind_new_shapes(*state, device, image);
+
+		for (uint32_t i : state->url_painted) {
+			image.assets[i] = SVGElementAssets();
+			const SVGDom& dom = state->document->dom;
+
+			create_element_assets(*dom.geometries[i], *dom.styles[dom.geometry_style[i]], state->document->id_map, state->document->lengths, device, image.assets[i]);
+		}
+
+		compile_display_list(state->document->dom, image.display_list);
+	}
+
+	close();
+
+	return SVGLoadStatus::Done;
+}
+
+void SVGStreamLoader::close() {
+	state.reset();
+}
+
+//Finds the part of the image that can show on the device when it is drawn with base:
+//the render target, with a pixel more for anti-aliasing, mapped to image coordinates.
+static bool get_device_clip(const SVGDevice& device, const D2D1_MATRIX_3X2_F& base, Bounds& clip) {
+	D2D1_SIZE_F size = device.device_context->GetSize();
+	Matrix inverse;
+
+	if (!Matrix{ base._11, base._12, base._21, base._22, base._31, base._32 }.invert(inverse)) {
+		return false;
+	}
+
+	clip = transform_bounds(Bounds{ 0.0f, 0.0f, size.width, size.height }, 1.0f, inverse);
+
+	return true;
+}
+
+// Render the loaded bitmap onto the window
+void SVG::render(const SVGDevice& device, const SVGImage& image, SVGRenderStats* stats)
+{
+	if (stats) {
+		*stats = SVGRenderStats();
+	}
+
+	device.device_context->BeginDraw();
+
+	if (image.document && !image.document->dom.empty()) {
+		D2D1_MATRIX_3X2_F old_transform;
+
+		device.device_context->GetTransform(&old_transform);
+
+		//Render the SVG element tree, without the shapes that are off the device
+		SVGDirect2DRenderer renderer(device, image.assets, old_transform);
+		Bounds clip;
+
+		if (get_device_clip(device, old_transform, clip)) {
+			render(renderer, image, clip, stats);
+		}
+		else {
+			render(renderer, image, stats);
+		}
+
+		device.device_context->SetTransform(old_transform);
+	}
+
+	device.device_context->EndDraw();
+}
+
+void SVG::render(const SVGDevice& device, const SVGImage& image, float x, float y, float scale, SVGRenderStats* stats)
+{
+	if (stats) {
+		*stats = SVGRenderStats();
+	}
+
+	device.device_context->BeginDraw();
+
+	if (image.document && !image.document->dom.empty()) {
+		D2D1_MATRIX_3X2_F old_transform;
+		D2D1_MATRIX_3X2_F display_transform = D2D1::Matrix3x2F::Scale(scale, scale) * D2D1::Matrix3x2F::Translation(x, y);
+
+		device.device_context->GetTransform(&old_transform);
+
+		auto total_transform = display_transform * old_transform;
+
+		//Render the SVG element tree, without the shapes that are off the device
+		SVGDirect2DRenderer renderer(device, image.assets, total_transform);
+		Bounds clip;
+
+		if (get_device_clip(device, total_transform, clip)) {
+			render(renderer, image, clip, stats);
+		}
+		else {
+			render(renderer, image, stats);
+		}
+
+		device.device_context->SetTransform(old_transform);
+	}
+
+	device.device_context->EndDraw();
+}
+
+void SVG::clear(const SVGDevice& device, float red, float green, float blue, float alpha) {
+	device.device_context->BeginDraw();
+	device.device_context->Clear(D2D1::ColorF(red, green, blue, alpha));
+	device.device_context->EndDraw();
+}
+
+void SVGDevice::redraw()
+{
+	InvalidateRect(wnd, NULL, FALSE);
+}
+
+bool SVGDevice::init(HWND _wnd)
+{
+	wnd = _wnd;
+
+	HRESULT hr = D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED, &d2d_factory);
+
+	if (!SUCCEEDED(hr)) {
+		return false;
+	}
+
+	hr = DWriteCreateFactory(
+		DWRITE_FACTORY_TYPE_SHARED,
+		__uuidof(IDWriteFactory),
+		reinterpret_cast<IUnknown**>(&dwrite_factory)
+	);
+
+	if (!SUCCEEDED(hr)) {
+		return false;
+	}
+
+	// Create Render Target
+	RECT rc;
+
+	GetClientRect(_wnd, &rc);
+
+	hr = d2d_factory->CreateHwndRenderTarget(
+		D2D1::RenderTargetProperties(),
+		D2D1::HwndRenderTargetProperties(
+			_wnd,
+			D2D1::SizeU(rc.right - rc.left, rc.bottom - rc.top)
+		),
+		&render_target
+	);
+
+	if (!SUCCEEDED(hr)) {
+		return false;
+	}
+
+	//Get the device context from the render target
+	hr = render_target->QueryInterface(IID_PPV_ARGS(&device_context));
+
+	if (!SUCCEEDED(hr)) {
+		return false;
+	}
+
+	return true;
+}
+
+// Resize the render target when the window size changes
+void SVGDevice::resize()
+{
+	RECT rc;
+
+	GetClientRect(wnd, &rc);
+	render_target->Resize(D2D1::SizeU(rc.right - rc.left, rc.bottom - rc.top));
+}
+
+//Units that lengths in documents are resolved against: the DPI and the size of the render target
+LengthContext SVGDevice::get_lengths() const {
+	LengthContext lengths;
+	float dpi_x, dpi_y;
+
+	//Take an average of the horizontal and vertical DPI.
+	device_context->GetDpi(&dpi_x, &dpi_y);
+
+	lengths.dpi = (dpi_x + dpi_y) / 2.0f;
+	lengths.viewport_width = device_context->GetSize().width;
+	lengths.viewport_height = device_context->GetSize().height;
+
+	return lengths;
+}
@@ -1,98 +1,144 @@
-#pragma once
-
-#include <d2d1_2.h>
-#include <wincodec.h>
-#include <atlbase.h>
-#include <vector>
-#include <string>
-#include <memory>
-#include <optional>
-#include <map>
-#include <dwrite.h>
-
-//Represents the rendering device and associated Direct2D and DirectWrite objects.
-//At this time only Win32 HWND based device is supported.
-struct SVGDevice
-{
-	HWND wnd;
-	CComPtr<ID2D1Factory> d2d_factory;
-	CComPtr<IDWriteFactory> dwrite_factory;
-	CComPtr<ID2D1HwndRenderTarget> render_target;
-	CComPtr<ID2D1DeviceContext> device_context;
-
-	//Initializes the SVGDevice with the given window handle. 
-	//Various Direct2D and DirectWrite objects are created at this point. 
-	//Returns true on success, false on failure.
-	bool init(HWND wnd);
-
-	//Resizes the display surface to match the current size of the window. 
-	//This should be called in response to WM_SIZE messages.
-	void resize();
-
-	//Redraws the window. This should be called after any changes to the 
-	//SVGImage that require a redraw. Such as after loading an image or changing 
-	//the zoom level.
-	void redraw();
-};
-
-//Represents an XML element in the SVG file such as <g>, <rect>, <circle>, etc.
-struct SVGGraphicsElement {
-	std::wstring tag_name;
-	float stroke_width = 1.0f;
-	CComPtr<ID2D1Brush> fill_brush;
-	CComPtr<ID2D1Brush> stroke_brush;
-	CComPtr<ID2D1StrokeStyle> stroke_style;
-	std::vector<std::shared_ptr<SVGGraphicsElement>> children;
-	std::optional<D2D1_MATRIX_3X2_F> combined_transform;
-	std::vector<float> points;
-	std::map<std::wstring, std::wstring> styles;
-	std::map<std::wstring, std::wstring> attributes;
-	D2D1_RECT_F bbox{};
-
-	SVGGraphicsElement() = default;
-	SVGGraphicsElement(const SVGGraphicsElement& that);
-
-	virtual void render_tree(const SVGDevice& device) const;
-	virtual void render(const SVGDevice& device) const {};
-	virtual void create_presentation_assets(const std::vector<std::shared_ptr<SVGGraphicsElement>>& parent_stack, const std::map<std::wstring, std::shared_ptr<SVGGraphicsElement>>& id_map, const SVGDevice& device);
-	virtual void compute_bbox();
-	virtual ~SVGGraphicsElement() = default;
-	//Creates a deep copy of the element. Used for <use> elements.
-	virtual std::shared_ptr<SVGGraphicsElement> clone() const;
-
-	bool get_style_computed(const std::vector<std::shared_ptr<SVGGraphicsElement>>& parent_stack, const std::wstring& style_name, std::wstring& style_value);
-	void get_style_computed(const std::vector<std::shared_ptr<SVGGraphicsElement>>& parent_stack, const std::wstring& style_name, std::wstring& style_value, const std::wstring& default_value);
-	bool get_attribute_in_references(const std::vector<std::shared_ptr<SVGGraphicsElement>>& chain, const std::wstring& attr_name, std::wstring& attr_value) const;
-};
-
-//Represents a loaded SVG image. 
-//Contains the root element of the SVG file and any presentation assets created during 
-//loading such as brushes and stroke styles.
-struct SVGImage
-{
-	std::shared_ptr<SVGGraphicsElement> root_element;
-
-	void clear();
-};
-
-struct SVG
-{
-	//Loads an SVG file and populates the SVGImage structure. Returns true on success, false on failure.
-	//The must later be rendered using the same device that was used to load it. This is because some presentation assets 
-	//like brushes are created for that device during loading and are stored in the SVGImage structure.
-	//The device must be initialized before calling this function.
-	//If an image was already loaded in the SVGImage structure, it will be cleared before loading the new one.
-	static bool load(const wchar_t* file_name, const SVGDevice& device, SVGImage& image);
-
-	//Clears the display surface by filling it with the specified color. The default color is white.
-	//This is optional and can be called before rendering an SVGImage to clear any previous content. 
-	//It is not necessary to call this function before every render, only when you want to clear the previous content.
-	static void clear(const SVGDevice& device, float red=1.0f, float green=1.0f, float blue=1.0f, float alpha=1.0f);
-
-	//Renders the SVGImage on the given device. The image must have been loaded using the same device.
-	static void render(const SVGDevice& device, const SVGImage& image);
-
-	//Renders the SVGImage on the given device with the specified position and scale. The image must be loaded using the same device.
-	static void render(const SVGDevice& device, const SVGImage& image, float x, float y, float scale);
-};
-
+#pragma once
+
+#include <d2d1_2.h>
+#include <wincodec.h>
+#include <atlbase.h>
+#include <string>
+#include <dwrite.h>
+#include "document.h"
+
+//The Direct2D backend: a device for a window, and images bound to it.
+//The device-free part of the library is in document.h.
+
+//Represents the rendering device and associated Direct2D and DirectWrite objects.
+//At this time only Win32 HWND based device is supported.
+struct SVGDevice
+{
+	HWND wnd;
+	CComPtr<ID2D1Factory> d2d_factory;
+	CComPtr<IDWriteFactory> dwrite_factory;
+	CComPtr<ID2D1HwndRenderTarget> render_target;
+	CComPtr<ID2D1DeviceContext> device_context;
+
+	//Initializes the SVGDevice with the given window handle. 
+	//Various Direct2D and DirectWrite objects are created at this point. 
+	//Returns true on success, false on failure.
+	bool init(HWND wnd);
+
+	//Resizes the display surface to match the current size of the window. 
+	//This should be called in response to WM_SIZE messages.
+	void resize();
+
+	//Redraws the window. This should be called after any changes to the 
+	//SVGImage that require a redraw. Such as after loading an image or changing 
+	//the zoom level.
+	void redraw();
+
+	//Returns the DPI and the size of the display surface as units for resolving lengths.
+	//Pass these to SVG::parse() to parse a document for this device on another thread.
+	LengthContext get_lengths() const;
+};
+
+//Device resources of a shape element. They are kept apart from the element so that
+//a parsed document can be bound to more than one device, or bound again after the
+//device was lost, without parsing it again.
+struct SVGElementAssets {
+	CComPtr<ID2D1Brush> fill_brush;
+	CComPtr<ID2D1Brush> stroke_brush;
+	CComPtr<ID2D1StrokeStyle> stroke_style;
+	//Geometry of <path>, <polyline> and <polygon>. Built from the path data when the
+	//element is first rendered, so shapes that are never drawn don't get one.
+	mutable CComPtr<ID2D1PathGeometry> path_geometry;
+	//Layout of <text> and the offset of its baseline from the top of the layout
+	CComPtr<IDWriteTextLayout> text_layout;
+	float baseline = 0.0f;
+};
+
+//Creates the device assets of a shape drawn with the given style, with the
+//create_presentation_assets() member of its element type.
+void create_element_assets(const SVGGraphicsElement& element, const ComputedStyle& style, const std::map<std::string_view, SVGGraphicsElement*>& id_map, const LengthContext& lengths, const SVGDevice& device, SVGElementAssets& assets);
+
+//Represents a loaded SVG image: a document bound to a device.
+//Contains the document and the presentation assets created for the device, such as
+//brushes, stroke styles, geometries and text layouts. Entry i of assets belongs to
+//shape i of the document, dom.geometries[i].
+struct SVGImage : SVGImageBase
+{
+	std::vector<SVGElementAssets> assets;
+
+	//Releases the device assets and the image's share of the document
+	void clear();
+};
+
+//Approximate memory held by the element tree of a loaded image.
+struct SVGMemoryReport {
+	size_t element_count = 0;
+	//Bytes used by the elements together with their names, styles, attributes and child lists.
+	//Device assets like brushes and geometries are not included.
+	size_t element_bytes = 0;
+	//Bytes the arena of the document took from the heap. This covers the elements,
+	//computed styles, paths and text, and unused space at the end of arena chunks.
+	size_t arena_bytes = 0;
+	//Shapes drawn from path data, and how many of them have had their Direct2D
+	//geometry built so far. Geometries are built when a shape is first rendered.
+	size_t path_count = 0;
+	size_t realized_path_count = 0;
+	//Brushes and stroke styles of the image. Shapes that are never drawn, like the ones in
+	//<defs> that no <use> element references, get none. The skipped counts are the ones
+	//they would have needed.
+	size_t brush_count = 0;
+	size_t stroke_style_count = 0;
+	size_t skipped_brush_count = 0;
+	size_t skipped_stroke_style_count = 0;
+	//Bytes held by the display list of the image and its index
+	size_t display_list_bytes = 0;
+};
+
+//Result of SVGStreamLoader::load_more()
+enum class SVGLoadStatus {
+	//More of the document is ready to render and the rest is still to be read
+	Loading,
+	//The whole document was read
+	Done,
+	//The document could not be read. The image is cleared.
+	Failed,
+};
+
+//Progress of a progressive load. Private to the library.
+struct SVGStreamState;
+
+//Loads a large document in steps, so that the part read so far can be drawn while
+//the rest is still being read. This cuts the time to the first picture of files that
+//take seconds to load, like map exports. Each call to load_more() reads some more
+//elements and makes everything read so far ready to render in the image.
+//
+//Elements are rendered as soon as they were read, except for <use> elements that
+//reference an element further down, and paint like fill="url(#gradient1)" that
+//references a gradient further down. These are resolved when the whole document was
+//read, and the image is then the same as one from SVG::load().
+//
+//The image shares the document with the loader, which keeps adding to it. Render the
+//image only between calls to load_more(), on the same thread.
+struct SVGStreamLoader {
+	SVGStreamLoader();
+	~SVGStreamLoader();
+	SVGStreamLoader(const SVGStreamLoader&) = delete;
+	SVGStreamLoader& operator=(const SVGStreamLoader&) = delete;
+
+	//Starts loading a file. The file is memory mapped and only read by load_more().
+	//Any previous load is abandoned. Returns false if the file can not be opened.
+	bool open(const wchar_t* file_name, const SVGDevice& device);
+
+	//Reads at least element_count more elements, or the rest of the document, and
+	//creates the device assets of what was read. Pass the same device and image every
+	//time. Every step redraws all that was read so far, so increasing element_count from
+	//one step to the next, like doubling it, keeps the total cost of redrawing low.
+	SVGLoadStatus load_more(const SVGDevice& device, SVGImage& image, size_t element_count = 10000);
+
+	//Releases the file and the state of the load. The image keeps the part read so far.
+	void close();
+
+private:
+	std::unique_ptr<SVGStreamState> state;
+};
+
@@ -0,0 +1,21 @@
+#include "document.h"
+#include "use.h"
+#include "symbol.h"
+
+bool SVGSymbolElement::get_viewport_transform(const SVGUseElement& use, Matrix& transform) const {
+	float viewport_width = use.width.value_or(width);
+	float viewport_height = use.height.value_or(height);
+
+	if (viewport_width <= 0.0f || viewport_height <= 0.0f) {
+		return false;
+	}
+
+	if (viewbox_width > 0.0f && viewbox_height > 0.0f) {
+		transform = viewbox_transform(viewbox_x, viewbox_y, viewbox_width, viewbox_height, viewport_width, viewport_height, aspect_ratio);
+	}
+	else {
+		transform = Matrix();
+	}
+
+	return true;
+}
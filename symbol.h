@@ -0,0 +1,18 @@
+#pragma once
+
+//Represents <symbol> elements. A symbol is only drawn by the <use> elements that
+//reference it. Its viewBox is fitted into the size of the <use> element, or of the symbol.
+struct SVGSymbolElement : public SVGGraphicsElement {
+	//viewBox. Not used if the width or height is 0.
+	float viewbox_x = 0.0f, viewbox_y = 0.0f, viewbox_width = 0.0f, viewbox_height = 0.0f;
+	AspectRatio aspect_ratio;
+	//Size of the viewport. 100% of the viewport of the document unless specified.
+	float width = 0.0f, height = 0.0f;
+
+	using ArenaOwned = SVGSymbolElement;
+	using SVGGraphicsElement::SVGGraphicsElement;
+
+	//Gets the transform from the symbol content to the space of a <use> element.
+	//Returns false if the viewport is empty, in which case nothing is drawn.
+	bool get_viewport_transform(const SVGUseElement& use, Matrix& transform) const;
+};
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include "document.h"
+
+//Shared parts of the benchmarks: a timer and generators for the test documents that the
+//numbers in the commit messages were measured on. The generators are seeded, so every run
+//builds the same documents.
+
+//Runs f runs times and returns the fastest run in milliseconds
+template <typename F>
+double best_of(int runs, F&& f) {
+	double best = 0.0;
+
+	for (int i = 0; i < runs; ++i) {
+		auto start = std::chrono::steady_clock::now();
+
+		f();
+
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		if (i == 0 || ms < best) {
+			best = ms;
+		}
+	}
+
+	return best;
+}
+
+//Written by keep(). Being volatile, the compiler can't drop the writes.
+inline const void* volatile kept;
+
+//Keeps the compiler from dropping a result that is not used otherwise
+template <typename T>
+void keep(const T& value) {
+	kept = &value;
+}
+
+inline int random_int(std::mt19937& random, int low, int high) {
+	return std::uniform_int_distribution<int>(low, high)(random);
+}
+
+inline std::shared_ptr<SVGDocument> parse_text(const std::string& text) {
+	auto document = std::make_shared<SVGDocument>();
+
+	if (!SVG::parse_from_memory(text.data(), text.size(), *document)) {
+		std::printf("failed to parse a generated document\n");
+	}
+
+	return document;
+}
+
+//A map of layers of small closed polygons on a 4000x4000 canvas. One in five polygons is
+//filled with a gradient. map.svg is make_map(20, 10000): 200k paths.
+inline std::string make_map(int layers, int paths_per_layer) {
+	std::mt19937 random(1);
+	std::string text = "<svg xmlns='http://www.w3.org/2000/svg' width='4000' height='4000'>"
+		"<defs><linearGradient id='sea'><stop offset='0' stop-color='#9cf'/><stop offset='1' stop-color='#36c'/></linearGradient></defs>"
+		"<g id='map' stroke='#333' stroke-width='0.5'>";
+	char buffer[64];
+
+	for (int layer = 0; layer < layers; ++layer) {
+		std::snprintf(buffer, sizeof(buffer), "<g id='layer%d' fill='#%06x'>", layer, random_int(random, 0, 0xffffff));
+		text += buffer;
+
+		for (int i = 0; i < paths_per_layer; ++i) {
+			int cx = random_int(random, 30, 3970);
+			int cy = random_int(random, 30, 3970);
+
+			text += (i % 5 == 0) ? "<path fill='url(#sea)' d='M" : "<path d='M";
+
+			for (int point = 0; point < 13; ++point) {
+				std::snprintf(buffer, sizeof(buffer), "%s%d %d", point == 0 ? "" : " L", cx + random_int(random, -30, 30), cy + random_int(random, -30, 30));
+				text += buffer;
+			}
+
+			text += " Z'/>";
+		}
+
+		text += "</g>";
+	}
+
+	text += "</g></svg>";
+
+	return text;
+}
+
+//Groups of 8 icons: rects, styled circles, gradient paths, <use> of a group, and text.
+//icons5k.svg is make_icons(5000).
+inline std::string make_icons(int count) {
+	std::mt19937 random(1);
+	std::string text = "<svg xmlns='http://www.w3.org/2000/svg' xmlns:xlink='http://www.w3.org/1999/xlink' viewBox='0 0 1000 1000' width='1000' height='1000'>"
+		"<defs><linearGradient id='lg' x1='0' y1='0' x2='1' y2='1'><stop offset='0' stop-color='red'/><stop offset='1' stop-color='blue'/></linearGradient>"
+		"<g id='icon'><circle cx='5' cy='5' r='4' fill='orange'/><path d='M0 0L10 10' stroke='black'/></g></defs>";
+	char buffer[128];
+
+	for (int i = 0; i < count; i += 8) {
+		std::snprintf(buffer, sizeof(buffer), "<g transform='translate(%d,%d)' fill='#%06x'>", random_int(random, 0, 900), random_int(random, 0, 900), random_int(random, 0, 0xffffff));
+		text += buffer;
+
+		for (int j = 0; j < 8; ++j) {
+			int kind = random_int(random, 0, 4);
+			int x = random_int(random, 0, 100);
+			int y = random_int(random, 0, 100);
+
+			switch (kind) {
+			case 0:
+				std::snprintf(buffer, sizeof(buffer), "<rect x='%d' y='%d' width='20' height='10' stroke='black' stroke-width='2'/>", x, y);
+				break;
+			case 1:
+				std::snprintf(buffer, sizeof(buffer), "<circle cx='%d' cy='%d' r='5' style='fill:rgb(10,20,30);opacity:0.5'/>", x, y);
+				break;
+			case 2:
+				std::snprintf(buffer, sizeof(buffer), "<path d='M%d %d l10 0 l0 10 z' fill='url(#lg)'/>", x, y);
+				break;
+			case 3:
+				std::snprintf(buffer, sizeof(buffer), "<use xlink:href='#icon' x='%d' y='%d'/>", x, y);
+				break;
+			default:
+				std::snprintf(buffer, sizeof(buffer), "<text x='%d' y='%d' font-size='12'>Label</text>", x, y);
+				break;
+			}
+
+			text += buffer;
+		}
+
+		text += "</g>";
+	}
+
+	text += "</svg>";
+
+	return text;
+}
+
+//Groups nested up to 4 deep with up to 6 children each, some of them translated, holding
+//rects, circles and paths. grp30k.svg is make_groups(30000).
+inline std::string make_groups(int count) {
+	struct Generator {
+		std::mt19937 random{ 2 };
+		std::uniform_real_distribution<double> chance{ 0.0, 1.0 };
+		std::string text;
+		int count = 1;
+		int limit = 0;
+		char buffer[96];
+
+		void group(int depth) {
+			if (chance(random) < 0.5) {
+				std::snprintf(buffer, sizeof(buffer), "<g transform='translate(%d,%d)'>", random_int(random, 0, 50), random_int(random, 0, 50));
+				text += buffer;
+			}
+			else {
+				text += "<g>";
+			}
+
+			++count;
+
+			for (int j = 0; j < 6 && count < limit; ++j) {
+				if (depth < 4 && chance(random) < 0.3) {
+					group(depth + 1);
+					continue;
+				}
+
+				int kind = random_int(random, 0, 2);
+				int x = random_int(random, 0, 100);
+				int y = random_int(random, 0, 100);
+
+				if (kind == 0) {
+					std::snprintf(buffer, sizeof(buffer), "<rect x='%d' y='%d' width='20' height='10' fill='red'/>", x, y);
+				}
+				else if (kind == 1) {
+					std::snprintf(buffer, sizeof(buffer), "<circle cx='%d' cy='%d' r='5' fill='blue'/>", x, y);
+				}
+				else {
+					std::snprintf(buffer, sizeof(buffer), "<path d='M%d %d l10 0 l0 10 z'/>", x, y);
+				}
+
+				text += buffer;
+				++count;
+			}
+
+			text += "</g>";
+		}
+	};
+
+	Generator generator;
+
+	generator.limit = count;
+	generator.text = "<svg xmlns='http://www.w3.org/2000/svg' viewBox='0 0 1000 1000' width='1000' height='1000'>";
+
+	while (generator.count < count) {
+		generator.group(0);
+	}
+
+	generator.text += "</svg>";
+
+	return generator.text;
+}
+
+//A dashboard of <use> elements on a grid of 80 per row, alternating between a <symbol>
+//and a <g> of five shapes. dash2k.svg is make_dashboard(2000).
+inline std::string make_dashboard(int count) {
+	const char* shapes = "<circle cx='12' cy='12' r='10' stroke='black'/><path d='M4 12h16M12 4v16' stroke='black'/>"
+		"<rect x='6' y='6' width='4' height='4'/><path d='M2 2L22 22'/><ellipse cx='12' cy='18' rx='4' ry='2'/>";
+	const char* fills[] = { "red", "green", "blue", "#888" };
+	std::string text = "<svg xmlns='http://www.w3.org/2000/svg' xmlns:xlink='http://www.w3.org/1999/xlink' width='2000' height='2000'><defs>";
+	char buffer[128];
+
+	text += "<symbol id='icon' viewBox='0 0 24 24'>";
+	text += shapes;
+	text += "</symbol><g id='gicon'>";
+	text += shapes;
+	text += "</g></defs>";
+
+	for (int i = 0; i < count; ++i) {
+		std::snprintf(buffer, sizeof(buffer), "<use xlink:href='%s' x='%d' y='%d' width='24' height='24'", i % 2 ? "#icon" : "#gicon", (i % 80) * 25, (i / 80) * 25);
+		text += buffer;
+
+		if (i % 3 == 0) {
+			text += " fill='";
+			text += fills[i % 4];
+			text += "'";
+		}
+
+		text += "/>";
+	}
+
+	text += "</svg>";
+
+	return text;
+}
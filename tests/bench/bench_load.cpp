@@ -0,0 +1,248 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench.h"
+#include "raster_renderer.h"
+
+//Benchmarks of loading documents. Each line of output starts with the request whose
+//numbers it measures.
+
+//Heap allocations made with operator new since the start of the process
+static std::atomic<size_t> allocation_count{ 0 };
+
+void* operator new(size_t size) {
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+	if (void* p = std::malloc(size ? size : 1)) {
+		return p;
+	}
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+	std::free(p);
+}
+
+static std::string temp_file_name(const char* name) {
+	const char* directory = std::getenv("TMPDIR");
+
+	return std::string(directory ? directory : "/tmp") + "/" + name;
+}
+
+//Parsing map.svg (200k paths) from a file, which is memory mapped, and from a buffer
+static void bench_file_and_memory(const std::string& text) {
+	std::string file_name = temp_file_name("svglib_bench_map.svg");
+	FILE* file = std::fopen(file_name.c_str(), "wb");
+
+	if (!file) {
+		std::printf("file (001)        can't write %s\n", file_name.c_str());
+
+		return;
+	}
+
+	std::fwrite(text.data(), 1, text.size(), file);
+	std::fclose(file);
+
+	bool ok = true;
+
+	double file_ms = best_of(5, [&] {
+		SVGDocument document;
+
+		ok &= SVG::parse(file_name.c_str(), document);
+	});
+
+	double memory_ms = best_of(5, [&] {
+		SVGDocument document;
+
+		ok &= SVG::parse_from_memory(text.data(), text.size(), document);
+	});
+
+	std::remove(file_name.c_str());
+
+	std::printf("file (001)        map: parse %.1f ms, parse_from_memory %.1f ms%s\n", file_ms, memory_ms, ok ? "" : ", PARSE FAILED");
+}
+
+//Bytes held by the elements of a document, counted like SVG::get_memory_report() does
+static size_t get_element_bytes(const SVGDocument& document) {
+	size_t bytes = 0;
+
+	for (const SVGGraphicsElement* element : document.dom.element) {
+		bytes += sizeof(*element) +
+			element->points.capacity() * sizeof(float) +
+			element->children.capacity() * sizeof(element->children[0]) +
+			element->styles.heap_size() +
+			element->attributes.heap_size();
+	}
+
+	return bytes;
+}
+
+//Heap allocations, load and clear time, and memory of the element tree
+static void bench_arena(const char* name, const std::string& text) {
+	size_t allocations = 0;
+	size_t elements = 0;
+	size_t element_bytes = 0;
+	size_t arena_bytes = 0;
+	double clear_ms = 0.0;
+
+	double load_ms = best_of(5, [&] {
+		SVGDocument document;
+		size_t start = allocation_count.load();
+
+		SVG::parse_from_memory(text.data(), text.size(), document);
+
+		allocations = allocation_count.load() - start;
+		elements = document.dom.element.size();
+		element_bytes = get_element_bytes(document);
+		arena_bytes = document.arena.reserved_bytes();
+
+		auto clear_start = std::chrono::steady_clock::now();
+
+		document.clear();
+
+		clear_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - clear_start).count();
+	});
+
+	std::printf("arena (006, 010)  %-8s %zu elements: load %.2f ms, clear %.3f ms, %zu heap allocations, %.1f element bytes and %.1f arena bytes per element\n",
+		name, elements, load_ms, clear_ms, allocations, double(element_bytes) / elements, double(arena_bytes) / elements);
+}
+
+//Parses a batch of documents on 1 to 8 threads, each thread taking the next document
+//that nobody has started on, like SVG::load_batch() does
+static void bench_threads() {
+	std::vector<std::string> texts;
+
+	for (int i = 0; i < 48; ++i) {
+		texts.push_back(make_icons(500 + i * 40));
+	}
+
+	for (unsigned thread_count = 1; thread_count <= 8; thread_count *= 2) {
+		double ms = best_of(5, [&] {
+			std::vector<SVGDocument> documents(texts.size());
+			std::atomic<size_t> next{ 0 };
+
+			auto work = [&] {
+				for (size_t i = next++; i < texts.size(); i = next++) {
+					SVG::parse_from_memory(texts[i].data(), texts[i].size(), documents[i]);
+				}
+			};
+
+			std::vector<std::thread> threads;
+
+			for (unsigned i = 1; i < thread_count; ++i) {
+				threads.emplace_back(work);
+			}
+
+			work();
+
+			for (std::thread& thread : threads) {
+				thread.join();
+			}
+		});
+
+		std::printf("threads (014)     %zu documents on %u thread%s: %.1f ms\n", texts.size(), thread_count, thread_count > 1 ? "s" : "", ms);
+	}
+}
+
+//Loads a document and renders it once into a small bitmap, which resolves its <use>
+//elements and gradients
+static void load_and_render(const char* name, const std::string& text) {
+	std::vector<uint8_t> pixels(64 * 64 * 4);
+	SVGBitmap bitmap{ pixels.data(), 64, 64, 64 * 4 };
+	size_t drawn = 0;
+	bool ok = false;
+
+	double ms = best_of(3, [&] {
+		auto document = std::make_shared<SVGDocument>();
+
+		ok = SVG::parse_from_memory(text.data(), text.size(), *document);
+
+		if (ok) {
+			SVGImageBase image;
+			SVGRasterRenderer renderer(bitmap, *document);
+			SVGRenderStats stats;
+
+			image.document = document;
+			SVG::render(renderer, image, &stats);
+			drawn = stats.drawn;
+		}
+	});
+
+	if (ok) {
+		std::printf("limits (020)      %-26s %.2f ms, %zu drawn\n", name, ms, drawn);
+	}
+	else {
+		std::printf("limits (020)      %-26s rejected in %.2f ms\n", name, ms);
+	}
+}
+
+//Documents that nest or chain references far deeper than SVGLimits allows
+static void bench_limits() {
+	const char* header = "<svg xmlns='http://www.w3.org/2000/svg' xmlns:xlink='http://www.w3.org/1999/xlink' width='64' height='64'>";
+	std::string text;
+
+	for (int count : { 1000, 100000 }) {
+		text = header;
+		text += "<rect id='u0' width='10' height='10'/>";
+
+		for (int i = 1; i < count; ++i) {
+			text += "<use id='u" + std::to_string(i) + "' xlink:href='#u" + std::to_string(i - 1) + "'/>";
+		}
+
+		text += "</svg>";
+		load_and_render(count == 1000 ? "1k <use> chain" : "100k <use> chain", text);
+	}
+
+	text = header;
+	text += "<linearGradient id='a' xlink:href='#b'/><linearGradient id='b' xlink:href='#a'><stop offset='0' stop-color='red'/></linearGradient>"
+		"<rect width='10' height='10' fill='url(#a)'/></svg>";
+	load_and_render("gradient href cycle", text);
+
+	text = header;
+	text += "<linearGradient id='g0'><stop offset='0' stop-color='red'/><stop offset='1' stop-color='blue'/></linearGradient>";
+
+	for (int i = 1; i < 100000; ++i) {
+		text += "<linearGradient id='g" + std::to_string(i) + "' xlink:href='#g" + std::to_string(i - 1) + "'/>";
+	}
+
+	text += "<rect width='10' height='10' fill='url(#g99999)'/></svg>";
+	load_and_render("100k gradient href chain", text);
+
+	for (int count : { 1000, 100000 }) {
+		text = header;
+
+		for (int i = 0; i < count; ++i) {
+			text += "<g>";
+		}
+
+		text += "<rect width='10' height='10'/>";
+
+		for (int i = 0; i < count; ++i) {
+			text += "</g>";
+		}
+
+		text += "</svg>";
+		load_and_render(count == 1000 ? "1k nested <g>" : "100k nested <g>", text);
+	}
+}
+
+int main() {
+	std::string map = make_map(20, 10000);
+
+	bench_file_and_memory(map);
+	bench_arena("map", map);
+	bench_arena("icons5k", make_icons(5000));
+	bench_arena("grp30k", make_groups(30000));
+	bench_threads();
+	bench_limits();
+
+	return 0;
+}
@@ -0,0 +1,250 @@
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "raster_renderer.h"
+
+//Benchmarks of drawing documents. Each line of output starts with the request whose
+//numbers it measures.
+//Files given on the command line are rasterized as well.
+
+//Visits every node of a document through the child lists of the elements and through
+//the flat arrays of the dom
+static void bench_walk(const char* name, const SVGDocument& document) {
+	std::vector<const SVGGraphicsElement*> stack;
+	size_t tree_sum = 0;
+	size_t flat_sum = 0;
+
+	double tree_ms = best_of(20, [&] {
+		tree_sum = 0;
+		stack.assign(1, document.root_element);
+
+		while (!stack.empty()) {
+			const SVGGraphicsElement* element = stack.back();
+			stack.pop_back();
+			tree_sum += static_cast<size_t>(element->kind);
+
+			for (const SVGGraphicsElement* child : element->children) {
+				stack.push_back(child);
+			}
+		}
+	});
+
+	double flat_ms = best_of(20, [&] {
+		flat_sum = 0;
+
+		for (ElementKind kind : document.dom.kind) {
+			flat_sum += static_cast<size_t>(kind);
+		}
+	});
+
+	size_t nodes = document.dom.size();
+
+	std::printf("walk (011)        %-8s %zu nodes: element tree %.2f ms (%.1f ns/node), dom arrays %.2f ms (%.1f ns/node)%s\n",
+		name, nodes, tree_ms, tree_ms * 1e6 / nodes, flat_ms, flat_ms * 1e6 / nodes, tree_sum == flat_sum ? "" : ", WALKS DIFFER");
+}
+
+struct Sample {
+	const char* name;
+	std::shared_ptr<SVGDocument> document;
+};
+
+//A full frame through the null and counting renderers, from the dom and from a display
+//list, and a frame of the top left quarter of the image
+static void bench_renderers(const Sample& sample) {
+	SVGImageBase walked;
+	SVGImageBase listed;
+
+	walked.document = sample.document;
+	listed.document = sample.document;
+	compile_display_list(sample.document->dom, listed.display_list);
+
+	const LengthContext& lengths = sample.document->lengths;
+	Bounds quarter{ 0.0f, 0.0f, lengths.viewport_width / 2, lengths.viewport_height / 2 };
+	SVGNullRenderer null_renderer;
+	SVGRenderStats stats;
+
+	double null_ms = best_of(20, [&] { SVG::render(null_renderer, walked, &stats); });
+	size_t drawn = stats.drawn;
+	double counting_ms = best_of(20, [&] {
+		SVGCountingRenderer counting;
+
+		SVG::render(counting, walked, &stats);
+	});
+	double list_ms = best_of(20, [&] { SVG::render(null_renderer, listed, &stats); });
+	double walk_clip_ms = best_of(20, [&] { SVG::render(null_renderer, walked, quarter, &stats); });
+	double list_clip_ms = best_of(20, [&] { SVG::render(null_renderer, listed, quarter, &stats); });
+
+	std::printf("render (021, 023) %-8s %zu shapes: dom null %.3f ms, counting %.3f ms, list %.3f ms; quarter dom %.3f ms, list %.3f ms\n",
+		sample.name, drawn, null_ms, counting_ms, list_ms, walk_clip_ms, list_clip_ms);
+}
+
+//Build, queries, updates and size of the index on random boxes of 1 to 20 units spread
+//over a square that holds 100 boxes per 10k square units
+static void bench_bounds_tree() {
+	for (size_t count : { 10000, 100000, 1000000 }) {
+		std::mt19937 random(4);
+		float side = std::sqrt(count * 100.0f);
+		std::uniform_real_distribution<float> position(0.0f, side);
+		std::uniform_real_distribution<float> size(1.0f, 20.0f);
+		std::vector<Bounds> boxes(count);
+
+		for (Bounds& box : boxes) {
+			box.left = position(random);
+			box.top = position(random);
+			box.right = box.left + size(random);
+			box.bottom = box.top + size(random);
+		}
+
+		BoundsTree tree;
+		std::vector<uint32_t> found;
+
+		double build_ms = best_of(3, [&] { tree.build(boxes.data(), boxes.size()); });
+
+		//A view of a hundredth of the area
+		const int queries = 100;
+		size_t hits = 0;
+		double query_ms = best_of(3, [&] {
+			hits = 0;
+
+			for (int i = 0; i < queries; ++i) {
+				float x = position(random) * 0.9f;
+				float y = position(random) * 0.9f;
+
+				found.clear();
+				tree.query(Bounds{ x, y, x + side / 10, y + side / 10 }, found);
+				hits += found.size();
+			}
+		});
+
+		double scan_ms = best_of(3, [&] {
+			float x = position(random) * 0.9f;
+			float y = position(random) * 0.9f;
+			Bounds view{ x, y, x + side / 10, y + side / 10 };
+
+			found.clear();
+
+			for (size_t i = 0; i < boxes.size(); ++i) {
+				if (bounds_intersect(boxes[i], view)) {
+					found.push_back(static_cast<uint32_t>(i));
+				}
+			}
+		});
+
+		const int points = 10000;
+		double point_ms = best_of(3, [&] {
+			for (int i = 0; i < points; ++i) {
+				found.clear();
+				tree.query_point(position(random), position(random), found);
+			}
+		});
+
+		const int updates = 10000;
+		double update_ms = best_of(3, [&] {
+			for (int i = 0; i < updates; ++i) {
+				uint32_t entry = static_cast<uint32_t>(random() % count);
+				Bounds box = boxes[entry];
+
+				box.left += 1.0f;
+				box.right += 1.0f;
+				tree.update(entry, box);
+			}
+		});
+
+		double refit_ms = best_of(3, [&] { tree.refit(boxes.data()); });
+
+		std::printf("index (025)       %7zu boxes: build %.1f ms, view query %.1f us (%zu hits), scan %.0f us, point %.2f us, update %.2f us, refit %.2f ms, %.1f bytes per box\n",
+			count, build_ms, query_ms * 1000.0 / queries, hits / queries, scan_ms * 1000.0, point_ms * 1000.0 / points,
+			update_ms * 1000.0 / updates, refit_ms, double(tree.get_memory_size()) / count);
+	}
+}
+
+//Frames of the top left corner of an image at 1x, 4x and 16x zoom, from the indexed display list
+//and from the same list with its index dropped, which walks its groups instead
+static void bench_zoom(const Sample& sample) {
+	SVGImageBase indexed;
+	SVGImageBase grouped;
+
+	indexed.document = sample.document;
+	grouped.document = sample.document;
+	compile_display_list(sample.document->dom, indexed.display_list);
+	compile_display_list(sample.document->dom, grouped.display_list);
+	grouped.display_list.index.clear();
+
+	const LengthContext& lengths = sample.document->lengths;
+	SVGNullRenderer renderer;
+	SVGRenderStats stats;
+
+	std::printf("zoom (025)        %-8s %zu ops%s:", sample.name, indexed.display_list.ops.size(), indexed.display_list.index.empty() ? ", not indexed" : "");
+
+	for (float zoom : { 1.0f, 4.0f, 16.0f }) {
+		Bounds view{ 0.0f, 0.0f, lengths.viewport_width / zoom, lengths.viewport_height / zoom };
+
+		double indexed_ms = best_of(20, [&] { SVG::render(renderer, indexed, view, &stats); });
+		double grouped_ms = best_of(20, [&] { SVG::render(renderer, grouped, view, &stats); });
+
+		std::printf(" x%g %.0f us, groups %.0f us;", zoom, indexed_ms * 1000.0, grouped_ms * 1000.0);
+	}
+
+	std::printf("\n");
+}
+
+//Rasterizes a document scaled to fit a square bitmap
+static void bench_raster(const char* name, const SVGDocument& document, uint32_t size) {
+	std::vector<uint8_t> pixels(size_t(size) * size * 4);
+	SVGBitmap bitmap{ pixels.data(), size, size, size_t(size) * 4 };
+	const LengthContext& lengths = document.lengths;
+	float extent = std::max(lengths.viewport_width, lengths.viewport_height);
+	float scale = extent > 0.0f ? size / extent : 1.0f;
+	SVGImageBase image;
+
+	image.document = std::shared_ptr<const SVGDocument>(&document, [](const SVGDocument*) {});
+
+	SVGRasterRenderer renderer(bitmap, document, Matrix::scale(scale, scale));
+
+	double ms = best_of(5, [&] {
+		renderer.clear(1.0f, 1.0f, 1.0f, 1.0f);
+		SVG::render(renderer, image, renderer.get_clip());
+	});
+
+	std::printf("raster (022)      %-8s %ux%u: %.2f ms, %.0f Mpixel/s\n", name, size, size, ms, size * size / (ms * 1000.0));
+}
+
+int main(int argc, char** argv) {
+	bench_walk("grp500k", *parse_text(make_groups(500000)));
+
+	std::vector<Sample> samples = {
+		{ "map", parse_text(make_map(20, 10000)) },
+		{ "icons5k", parse_text(make_icons(5000)) },
+		{ "dash2k", parse_text(make_dashboard(2000)) },
+		{ "grp30k", parse_text(make_groups(30000)) },
+	};
+
+	for (const Sample& sample : samples) {
+		bench_renderers(sample);
+	}
+
+	bench_bounds_tree();
+
+	for (const Sample& sample : samples) {
+		bench_zoom(sample);
+	}
+
+	bench_raster("icons5k", *samples[1].document, 400);
+	bench_raster("icons5k", *samples[1].document, 1024);
+	bench_raster("dash2k", *samples[2].document, 1024);
+
+	for (int i = 1; i < argc; ++i) {
+		SVGDocument document;
+
+		if (SVG::parse(argv[i], document)) {
+			bench_raster(argv[i], document, 1024);
+		}
+		else {
+			std::printf("raster (022)      %s: failed to parse\n", argv[i]);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,212 @@
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "xml_tokenizer.h"
+#include "number.h"
+#include "atoms.h"
+#include "color.h"
+#include "transform.h"
+
+//Benchmarks of the scanners that parsing is built on. Each one also checks that the
+//result is the one it measures the speed of.
+
+//Tokenizes the map document without building elements
+static void bench_tokenizer() {
+	std::string text = make_map(20, 10000);
+	size_t elements = 0;
+	size_t attributes = 0;
+	bool ok = true;
+
+	double ms = best_of(5, [&] {
+		XmlTokenizer xml(text.data(), text.size());
+
+		elements = 0;
+		attributes = 0;
+
+		for (;;) {
+			XmlToken token = xml.next();
+
+			if (token == XmlToken::StartElement) {
+				++elements;
+				attributes += xml.attributes().size();
+			}
+			else if (token == XmlToken::EndOfDocument || token == XmlToken::Error) {
+				ok = token == XmlToken::EndOfDocument;
+
+				break;
+			}
+		}
+	});
+
+	double mb = text.size() / (1024.0 * 1024.0);
+
+	std::printf("tokenizer (002)   %.1f MB, %zu elements, %zu attributes: %.1f ms, %.0f MB/s%s\n",
+		mb, elements, attributes, ms, mb * 1000.0 / ms, ok ? "" : ", TOKENIZER ERROR");
+}
+
+//A 12 MB coordinate list, like path data, scanned with scan_next_number() and with a
+//strtof() loop, the way the path parser used to read it.
+static void bench_numbers() {
+	std::mt19937 random(3);
+	std::uniform_real_distribution<float> coordinate(-1000.0f, 1000.0f);
+	std::string text;
+	char buffer[32];
+
+	while (text.size() < 12 * 1024 * 1024) {
+		std::snprintf(buffer, sizeof(buffer), "%.3f,%.3f ", coordinate(random), coordinate(random));
+		text += buffer;
+	}
+
+	std::vector<float> scanned;
+	std::vector<float> reference;
+	scanned.reserve(text.size() / 8);
+	reference.reserve(text.size() / 8);
+
+	double scan_ms = best_of(5, [&] {
+		scanned.clear();
+
+		const char* p = text.data();
+		const char* end = p + text.size();
+		float value;
+
+		while (scan_next_number(p, end, value)) {
+			scanned.push_back(value);
+		}
+	});
+
+	double strtof_ms = best_of(5, [&] {
+		reference.clear();
+
+		const char* p = text.c_str();
+
+		for (;;) {
+			while (*p == ' ' || *p == ',') {
+				++p;
+			}
+
+			char* next;
+			float value = std::strtof(p, &next);
+
+			if (next == p) {
+				break;
+			}
+
+			reference.push_back(value);
+			p = next;
+		}
+	});
+
+	double mb = text.size() / (1024.0 * 1024.0);
+
+	std::printf("numbers (003)     %.1f MB: scan_next_number %.0f MB/s, strtof %.0f MB/s, %s\n",
+		mb, mb * 1000.0 / scan_ms, mb * 1000.0 / strtof_ms, scanned == reference ? "same values" : "VALUES DIFFER");
+}
+
+//Element, attribute and style names, in the mix that documents use them
+static const char* names[] = { "rect", "circle", "path", "g", "use", "linearGradient", "stop", "text", "stroke-width", "fill", "transform", "font-family" };
+static const int name_count = sizeof(names) / sizeof(names[0]);
+static const int name_rounds = 1000000;
+
+//Name lookup with find_atom(), which the tokenizer's names go through, and with
+//find_interned_atom()
+static void bench_atoms() {
+	std::vector<std::string_view> views(names, names + name_count);
+	size_t found = 0;
+
+	double find_ms = best_of(5, [&] {
+		for (int i = 0; i < name_rounds; ++i) {
+			found += find_atom(views[i % name_count]) != Atom::Unknown;
+		}
+	});
+
+	double interned_ms = best_of(5, [&] {
+		for (int i = 0; i < name_rounds; ++i) {
+			found += find_interned_atom(views[i % name_count]) != Atom::Unknown;
+		}
+	});
+
+	keep(found);
+
+	std::printf("atoms (006)       find_atom %.1f ns, find_interned_atom %.1f ns per name\n",
+		find_ms * 1e6 / name_rounds, interned_ms * 1e6 / name_rounds);
+}
+
+//Colors in the forms that documents use, parsed with get_css_color() and with a ColorCache
+static void bench_colors() {
+	const char* sources[] = { "red", "#369", "#3a6b9c", "rgb(10,20,30)", "rgba(10%, 20%, 30%, 0.5)", "cornflowerblue", "hsl(120, 50%, 50%)", "transparent" };
+	const int count = sizeof(sources) / sizeof(sources[0]);
+	const int rounds = 200000;
+	float r, g, b, a;
+	float sum = 0.0f;
+
+	double parse_ms = best_of(5, [&] {
+		for (int i = 0; i < rounds; ++i) {
+			get_css_color(sources[i % count], r, g, b, a);
+			sum += r;
+		}
+	});
+
+	ColorCache cache;
+
+	double cache_ms = best_of(5, [&] {
+		for (int i = 0; i < rounds; ++i) {
+			cache.get_css_color(sources[i % count], r, g, b, a);
+			sum += r;
+		}
+	});
+
+	keep(sum);
+
+	std::printf("colors (007)      get_css_color %.0f ns, ColorCache %.0f ns per value\n",
+		parse_ms * 1e6 / rounds, cache_ms * 1e6 / rounds);
+}
+
+//A 95 byte list of four transform functions
+static void bench_transforms() {
+	std::string_view source = "translate(100.5, -20) rotate(45, 10.25, 10.75) scale(1.5, 2.25) matrix(1 0.5 -0.5 1 12.5 -7.25)";
+	const int rounds = 200000;
+	Matrix matrix;
+	bool ok = true;
+
+	double ms = best_of(5, [&] {
+		for (int i = 0; i < rounds; ++i) {
+			ok &= parse_transform(source, matrix);
+		}
+	});
+
+	keep(matrix);
+
+	double ns = ms * 1e6 / rounds;
+
+	std::printf("transforms (008)  %zu bytes: %.0f ns per attribute, %.0f MB/s%s\n",
+		source.size(), ns, source.size() * 1000.0 / ns, ok ? "" : ", PARSE FAILED");
+}
+
+//The lookup that element creation does for every start tag: the atom of the name, then
+//its handler in the registry
+static void bench_handlers() {
+	std::vector<std::string_view> views(names, names + name_count);
+	size_t found = 0;
+
+	double ms = best_of(5, [&] {
+		for (int i = 0; i < name_rounds; ++i) {
+			found += find_element_handler(find_interned_atom(views[i % name_count])) != nullptr;
+		}
+	});
+
+	keep(found);
+
+	std::printf("handlers (013)    find_interned_atom and find_element_handler %.1f ns per name\n", ms * 1e6 / name_rounds);
+}
+
+int main() {
+	bench_tokenizer();
+	bench_numbers();
+	bench_atoms();
+	bench_colors();
+	bench_transforms();
+	bench_handlers();
+
+	return 0;
+}
@@ -1,120 +1,151 @@
-//An application to load and render SVG images.
-
-#include "framework.h"
-#include "svg_viewer.h"
-#include "../../../mgui/include/mgui.h"
-#include "../../svglib.h"
-
-#pragma comment(lib, "D3D11.lib")
-#pragma comment(lib, "d2d1.lib")
-#pragma comment(lib, "xmllite.lib")
-#pragma comment(lib, "dwrite.lib")
-//Needed by mgui
-#pragma comment(lib, "comctl32.lib")
-#pragma comment(lib, "gdi32.lib")
-#pragma comment(lib, "comdlg32.lib")
-
-void check_throw(HRESULT hr) {
-    if (!SUCCEEDED(hr)) {
-        throw hr;
-    }
-}
-
-class MainWindow : public CFrame {
-    SVGDevice device;
-    SVGImage image;
-    float scale = 1.0;
-public:
-    
-    void create() {
-        CFrame::create(L"SVG Viewer", 800, 600, IDC_WINPAGES);
-
-		device.init(getWindow());
-    }
-    void onClose() override {
-        CWindow::stop();
-	}
-    void onCommand(int id, int type, CWindow* source) override {
-        if (id == ID_FILE_OPEN) {
-            std::wstring filename;
-
-            if (!openFileName(L"Open SVG File",
-                { { L"SVG Files", L"*.svg" }, { L"All Files", L"*.*" } },
-                filename)) {
-                return;
-			}
-
-			if (SVG::load(filename.c_str(), device, image)) {
-				device.redraw();
-            }
-            else {
-				errorBox(L"Failed to open or parse the SVG file.");
-            }
-        }
-        else if (id == IDM_EXIT) {
-            onClose();
-        } else if (id == ID_VIEW_ZOOMIN) {
-            scale *= 1.25f;
-            device.redraw();
-        }
-        else if (id == ID_VIEW_ZOOMOUT) {
-            scale /= 1.25f;
-            device.redraw();
-        } else if (id == ID_VIEW_ACTUALSIZE) {
-            scale = 1.0f;
-            device.redraw();
-        }
-	}
-
-    bool handleEvent(UINT message, WPARAM wParam, LPARAM lParam) {
-        switch (message) {
-        case WM_PAINT:
-            PAINTSTRUCT ps;
-
-            //We must call BeginPaint and EndPaint to validate the
-            //invalidated region, or else we will get continuous
-            //WM_PAINT messages.
-            BeginPaint(m_wnd, &ps);
-            SVG::clear(device);
-            SVG::render(device, image, 20, 20, scale);
-            EndPaint(m_wnd, &ps);
-            break;
-        case WM_SIZE:
-            device.resize();
-            break;
-        case WM_ERASEBKGND:
-			//Handle background erase to avoid flickering 
-            //during resizing and move
-            break;
-        default:
-            return CWindow::handleEvent(message, wParam, lParam);
-        }
-
-        return true;
-    }
-};
-
-int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
-    _In_opt_ HINSTANCE hPrevInstance,
-    _In_ LPWSTR    lpCmdLine,
-    _In_ int       nCmdShow)
-{
-    CWindow::init(hInstance, IDC_WINPAGES);
-
-    HRESULT hr = CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
-
-    if (!SUCCEEDED(hr)) {
-        return FALSE;
-    }
-
-    MainWindow mainWin;
-
-    mainWin.create();
-    mainWin.show();
-
-    CWindow::loop();
-
-    CoUninitialize();
-
-    return 0;
+//An application to load and render SVG images.
+
+#include "framework.h"
+#include "svg_viewer.h"
+#include "../../../mgui/include/mgui.h"
+#include "../../svglib.h"
+
+#pragma comment(lib, "D3D11.lib")
+#pragma comment(lib, "d2d1.lib")
+#pragma comment(lib, "dwrite.lib")
+//Needed by mgui
+#pragma comment(lib, "comctl32.lib")
+#pragma comment(lib, "gdi32.lib")
+#pragma comment(lib, "comdlg32.lib")
+
+void check_throw(HRESULT hr) {
+    if (!SUCCEEDED(hr)) {
+        throw hr;
+    }
+}
+
+//Timer that reads the next part of a file being loaded
+const UINT_PTR LOAD_TIMER = 1;
+
+class MainWindow : public CFrame {
+    SVGDevice device;
+    SVGImage image;
+    SVGStreamLoader loader;
+    //Elements to read in the next step of a load
+    size_t load_step = 0;
+    float scale = 1.0;
+public:
+    
+    void create() {
+        CFrame::create(L"SVG Viewer", 800, 600, IDC_WINPAGES);
+
+		device.init(getWindow());
+    }
+    void onClose() override {
+        CWindow::stop();
+	}
+    void onCommand(int id, int type, CWindow* source) override {
+        if (id == ID_FILE_OPEN) {
+            std::wstring filename;
+
+            if (!openFileName(L"Open SVG File",
+                { { L"SVG Files", L"*.svg" }, { L"All Files", L"*.*" } },
+                filename)) {
+                return;
+			}
+
+            //Large files are shown while they are still being read.
+            //WM_TIMER has a lower priority than WM_PAINT, so each step is painted.
+            if (loader.open(filename.c_str(), device)) {
+                load_step = 5000;
+                SetTimer(m_wnd, LOAD_TIMER, 0, NULL);
+            }
+            else {
+				errorBox(L"Failed to open or parse the SVG file.");
+            }
+        }
+        else if (id == IDM_EXIT) {
+            onClose();
+        } else if (id == ID_VIEW_ZOOMIN) {
+            scale *= 1.25f;
+            device.redraw();
+        }
+        else if (id == ID_VIEW_ZOOMOUT) {
+            scale /= 1.25f;
+            device.redraw();
+        } else if (id == ID_VIEW_ACTUALSIZE) {
+            scale = 1.0f;
+            device.redraw();
+        }
+	}
+
+    void loadMore() {
+        SVGLoadStatus status = loader.load_more(device, image, load_step);
+
+        //Every step redraws all that was read so far. Doubling the
+        //step keeps the total redraw cost in line with the file size.
+        load_step *= 2;
+
+        if (status != SVGLoadStatus::Loading) {
+            KillTimer(m_wnd, LOAD_TIMER);
+        }
+
+        device.redraw();
+
+        if (status == SVGLoadStatus::Failed) {
+            errorBox(L"Failed to open or parse the SVG file.");
+        }
+    }
+
+    bool handleEvent(UINT message, WPARAM wParam, LPARAM lParam) {
+        switch (message) {
+        case WM_PAINT:
+            PAINTSTRUCT ps;
+
+            //We must call BeginPaint and EndPaint to validate the
+            //invalidated region, or else we will get continuous
+            //WM_PAINT messages.
+            BeginPaint(m_wnd, &ps);
+            SVG::clear(device);
+            SVG::render(device, image, 20, 20, scale);
+            EndPaint(m_wnd, &ps);
+            break;
+        case WM_SIZE:
+            device.resize();
+            break;
+        case WM_TIMER:
+            if (wParam == LOAD_TIMER) {
+                loadMore();
+            }
+            break;
+        case WM_ERASEBKGND:
+			//Handle background erase to avoid flickering 
+            //during resizing and move
+            break;
+        default:
+            return CWindow::handleEvent(message, wParam, lParam);
+        }
+
+        return true;
+    }
+};
+
+int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
+    _In_opt_ HINSTANCE hPrevInstance,
+    _In_ LPWSTR    lpCmdLine,
+    _In_ int       nCmdShow)
+{
+    CWindow::init(hInstance, IDC_WINPAGES);
+
+    HRESULT hr = CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
+
+    if (!SUCCEEDED(hr)) {
+        return FALSE;
+    }
+
+    MainWindow mainWin;
+
+    mainWin.create();
+    mainWin.show();
+
+    CWindow::loop();
+
+    CoUninitialize();
+
+    return 0;
 }
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdio>
+
+//Minimal checks for the unit tests. A failed check prints where it failed and makes
+//the test return 1 from main(), so ctest reports it. The test carries on after a failure.
+
+static int check_failures = 0;
+
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			++check_failures; \
+		} \
+	} while (0)
+
+#define CHECK_NEAR(a, b, tolerance) \
+	do { \
+		double check_a = (a), check_b = (b); \
+		if (!(check_a - check_b <= (tolerance) && check_b - check_a <= (tolerance))) { \
+			std::printf("%s:%d: CHECK_NEAR(%s, %s) failed: %g != %g\n", __FILE__, __LINE__, #a, #b, check_a, check_b); \
+			++check_failures; \
+		} \
+	} while (0)
+
+//Return this from main()
+#define CHECK_RESULT() (check_failures == 0 ? 0 : 1)
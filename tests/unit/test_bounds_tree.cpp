@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "bounds_tree.h"
+#include "check.h"
+
+//Checks the tree against testing every box, for random boxes and queries
+
+static std::vector<Bounds> random_boxes(size_t count, std::mt19937& random) {
+	std::uniform_real_distribution<float> position(0.0f, 1000.0f);
+	std::uniform_real_distribution<float> size(0.0f, 20.0f);
+	std::vector<Bounds> boxes(count);
+
+	for (Bounds& box : boxes) {
+		box.left = position(random);
+		box.top = position(random);
+		box.right = box.left + size(random);
+		box.bottom = box.top + size(random);
+	}
+
+	return boxes;
+}
+
+static std::vector<uint32_t> brute_force(const std::vector<Bounds>& boxes, const Bounds& rect) {
+	std::vector<uint32_t> found;
+
+	for (uint32_t i = 0; i < boxes.size(); ++i) {
+		if (bounds_intersect(boxes[i], rect)) {
+			found.push_back(i);
+		}
+	}
+
+	return found;
+}
+
+static bool same_entries(std::vector<uint32_t> a, std::vector<uint32_t> b) {
+	std::sort(a.begin(), a.end());
+	std::sort(b.begin(), b.end());
+
+	return a == b;
+}
+
+static void check_queries(const BoundsTree& tree, const std::vector<Bounds>& boxes, std::mt19937& random) {
+	std::uniform_real_distribution<float> position(-50.0f, 1050.0f);
+	std::uniform_real_distribution<float> size(0.0f, 200.0f);
+
+	for (int i = 0; i < 200; ++i) {
+		Bounds rect;
+
+		rect.left = position(random);
+		rect.top = position(random);
+		rect.right = rect.left + size(random);
+		rect.bottom = rect.top + size(random);
+
+		std::vector<uint32_t> found;
+
+		tree.query(rect, found);
+		CHECK(same_entries(found, brute_force(boxes, rect)));
+
+		found.clear();
+		tree.query_point(rect.left, rect.top, found);
+		CHECK(same_entries(found, brute_force(boxes, Bounds{ rect.left, rect.top, rect.left, rect.top })));
+	}
+}
+
+static void test_queries() {
+	std::mt19937 random(1);
+
+	for (size_t count : { size_t(1), size_t(15), size_t(16), size_t(17), size_t(300), size_t(5000) }) {
+		std::vector<Bounds> boxes = random_boxes(count, random);
+		BoundsTree tree;
+
+		tree.build(boxes.data(), boxes.size());
+		CHECK(tree.size() == count);
+		check_queries(tree, boxes, random);
+
+		Bounds all = tree.get_bounds();
+
+		for (const Bounds& box : boxes) {
+			CHECK(bounds_contain(all, box));
+		}
+	}
+}
+
+static void test_updates() {
+	std::mt19937 random(2);
+	std::vector<Bounds> boxes = random_boxes(2000, random);
+	BoundsTree tree;
+
+	tree.build(boxes.data(), boxes.size());
+
+	//Move some boxes one at a time
+	for (uint32_t entry = 0; entry < boxes.size(); entry += 7) {
+		boxes[entry] = Bounds{ boxes[entry].left + 300.0f, boxes[entry].top, boxes[entry].right + 300.0f, boxes[entry].bottom };
+		tree.update(entry, boxes[entry]);
+	}
+
+	check_queries(tree, boxes, random);
+
+	//Move all of them at once
+	for (Bounds& box : boxes) {
+		box = Bounds{ box.left, box.top - 100.0f, box.right, box.bottom - 100.0f };
+	}
+
+	tree.refit(boxes.data());
+	check_queries(tree, boxes, random);
+}
+
+static void test_empty() {
+	BoundsTree tree;
+	std::vector<uint32_t> found;
+
+	CHECK(tree.empty());
+	tree.query(Bounds{ 0, 0, 100, 100 }, found);
+	CHECK(found.empty());
+
+	std::vector<Bounds> boxes = { Bounds{ 0, 0, 10, 10 } };
+
+	tree.build(boxes.data(), boxes.size());
+	CHECK(!tree.empty());
+	tree.clear();
+	CHECK(tree.empty());
+}
+
+int main() {
+	test_queries();
+	test_updates();
+	test_empty();
+
+	return CHECK_RESULT();
+}
@@ -0,0 +1,85 @@
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include "color.h"
+#include "check.h"
+
+static bool is_color(std::string_view source, float r, float g, float b, float a) {
+	float cr = -1.0f, cg = -1.0f, cb = -1.0f, ca = -1.0f;
+
+	if (!get_css_color(source, cr, cg, cb, ca)) {
+		return false;
+	}
+
+	const float tolerance = 0.002f;
+
+	return std::abs(cr - r) < tolerance && std::abs(cg - g) < tolerance && std::abs(cb - b) < tolerance && std::abs(ca - a) < tolerance;
+}
+
+static void test_hex() {
+	CHECK(is_color("#f00", 1, 0, 0, 1));
+	CHECK(is_color("#ff000080", 1, 0, 0, 128 / 255.0f));
+	CHECK(is_color("#00Ff00", 0, 1, 0, 1));
+	CHECK(is_color("#0008", 0, 0, 0, 136 / 255.0f));
+	CHECK(!is_color("#12345", 0, 0, 0, 0));
+	CHECK(!is_color("#ggg", 0, 0, 0, 0));
+}
+
+static void test_functions() {
+	CHECK(is_color("rgb(255, 0, 0)", 1, 0, 0, 1));
+	CHECK(is_color("rgb(100%, 50%, 0%)", 1, 0.5f, 0, 1));
+	CHECK(is_color("RGBA(0,0,255,0.5)", 0, 0, 1, 0.5f));
+	CHECK(is_color("rgb(0 0 255 / 50%)", 0, 0, 1, 0.5f));
+	CHECK(is_color("hsl(120, 100%, 50%)", 0, 1, 0, 1));
+	CHECK(is_color("hsla(0 100% 50% / 0.25)", 1, 0, 0, 0.25f));
+	CHECK(!is_color("rgb(1, 2)", 0, 0, 0, 0));
+	CHECK(!is_color("rgb(1, 2, 3", 0, 0, 0, 0));
+}
+
+static void test_names() {
+	uint32_t rgb = 0;
+
+	CHECK(find_named_color("CornflowerBlue", rgb));
+	CHECK(rgb == 0x6495ED);
+	CHECK(find_named_color("rebeccapurple", rgb));
+	CHECK(rgb == 0x663399);
+	CHECK(!find_named_color("notacolor", rgb));
+
+	CHECK(is_color("transparent", 0, 0, 0, 0));
+	CHECK(is_color("White", 1, 1, 1, 1));
+	CHECK(!is_color("url(#g)", 0, 0, 0, 0));
+}
+
+static void test_cache() {
+	ColorCache cache;
+	float r, g, b, a;
+
+	//Enough distinct values to make the table grow
+	for (int i = 0; i < 1000; ++i) {
+		std::string source = "rgb(" + std::to_string(i % 256) + ", 0, 0)";
+
+		CHECK(cache.get_css_color(source, r, g, b, a));
+		CHECK(std::abs(r - (i % 256) / 255.0f) < 0.002f);
+	}
+
+	CHECK(cache.get_css_color("#00f", r, g, b, a));
+	CHECK(b == 1.0f);
+	CHECK(!cache.get_css_color("url(#g)", r, g, b, a));
+	//Remembered values give the same answer
+	CHECK(!cache.get_css_color("url(#g)", r, g, b, a));
+	CHECK(cache.get_css_color("#00f", r, g, b, a));
+	CHECK(b == 1.0f);
+
+	cache.clear();
+	CHECK(cache.get_css_color("red", r, g, b, a));
+	CHECK(r == 1.0f);
+}
+
+int main() {
+	test_hex();
+	test_functions();
+	test_names();
+	test_cache();
+
+	return CHECK_RESULT();
+}
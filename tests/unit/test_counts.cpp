@@ -0,0 +1,128 @@
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include "document.h"
+#include "check.h"
+
+//Renders documents with SVGCountingRenderer and checks the operations they send.
+//The counts of the sample images are kept in render_counts.txt, one line per file:
+//the name, then fills, strokes, paths, texts, transforms pushed and transforms set.
+//Run with --print to get the lines for the files given.
+
+static std::string format_counts(const SVGRenderCounts& counts) {
+	std::ostringstream line;
+
+	line << counts.fills << ' ' << counts.strokes << ' ' << counts.paths << ' ' << counts.texts << ' '
+		<< counts.transforms_pushed << ' ' << counts.transforms_set;
+
+	return line.str();
+}
+
+//Display lists combine the transforms of instances up front, so only the shapes are compared
+static bool same_shapes(const SVGRenderCounts& a, const SVGRenderCounts& b) {
+	return a.fills == b.fills && a.strokes == b.strokes && a.paths == b.paths && a.texts == b.texts;
+}
+
+static SVGRenderCounts count(const SVGImageBase& image) {
+	SVGCountingRenderer renderer;
+
+	SVG::render(renderer, image);
+
+	return renderer.counts;
+}
+
+static void test_document() {
+	const char text[] =
+		"<svg xmlns='http://www.w3.org/2000/svg' xmlns:xlink='http://www.w3.org/1999/xlink' width='100' height='100'>"
+		"<defs><rect id='r' width='10' height='10' stroke='black'/></defs>"
+		"<rect width='10' height='10'/>"
+		"<circle cx='50' cy='50' r='5' fill='none' stroke='red'/>"
+		"<ellipse cx='50' cy='50' rx='5' ry='3' fill='none'/>"
+		"<line x1='0' y1='0' x2='10' y2='10' stroke='blue'/>"
+		"<path d='M0 0L10 10L0 10Z' stroke='green' transform='translate(5)'/>"
+		"<use xlink:href='#r' x='20'/>"
+		"<use xlink:href='#r' x='40'/>"
+		"</svg>";
+	auto document = std::make_shared<SVGDocument>();
+
+	CHECK(SVG::parse_from_memory(text, sizeof(text) - 1, *document));
+
+	SVGImageBase image;
+
+	image.document = document;
+
+	SVGRenderCounts counts = count(image);
+
+	//The rect, the path and the two instances of r are filled. The ellipse draws nothing.
+	CHECK(counts.fills == 4);
+	//The circle, the line, the path and the two instances are stroked
+	CHECK(counts.strokes == 5);
+	CHECK(counts.paths == 2);
+	CHECK(counts.texts == 0);
+	CHECK(counts.transforms_pushed == 2);
+}
+
+int main(int argc, char* argv[]) {
+	bool print = argc > 1 && std::strcmp(argv[1], "--print") == 0;
+	std::map<std::string, std::string> expected;
+
+	if (!print && argc > 1) {
+		std::ifstream file(argv[1]);
+		std::string name, counts;
+
+		CHECK(file.good());
+
+		while (file >> name && std::getline(file, counts)) {
+			//Lines may end with \r\n
+			size_t first = counts.find_first_not_of(' ');
+			size_t last = counts.find_last_not_of("\r ");
+
+			if (first != std::string::npos) {
+				expected[name] = counts.substr(first, last - first + 1);
+			}
+		}
+	}
+
+	for (int i = 2; i < argc; ++i) {
+		auto document = std::make_shared<SVGDocument>();
+		std::string path = argv[i];
+		std::string name = path.substr(path.find_last_of("/\\") + 1);
+
+		CHECK(SVG::parse(path.c_str(), *document));
+
+		SVGImageBase image;
+
+		image.document = document;
+
+		SVGRenderCounts walked = count(image);
+
+		if (print) {
+			std::printf("%s %s\n", name.c_str(), format_counts(walked).c_str());
+
+			continue;
+		}
+
+#if !defined(SVGLIB_NO_TEXT) && !defined(SVGLIB_NO_GRADIENTS)
+		auto it = expected.find(name);
+
+		CHECK(it != expected.end());
+
+		if (it != expected.end() && it->second != format_counts(walked)) {
+			std::printf("%s: expected %s, got %s\n", name.c_str(), it->second.c_str(), format_counts(walked).c_str());
+			CHECK(false);
+		}
+#endif
+
+		//A display list draws the same shapes as the dom walk
+		compile_display_list(document->dom, image.display_list);
+
+		CHECK(same_shapes(count(image), walked));
+	}
+
+	test_document();
+
+	return CHECK_RESULT();
+}
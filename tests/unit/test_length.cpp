@@ -0,0 +1,78 @@
+#include <cmath>
+#include "length.h"
+#include "check.h"
+
+static void test_units() {
+	LengthContext context;
+	float value = 0.0f;
+
+	CHECK(parse_length("10", context, LengthAxis::None, value));
+	CHECK(value == 10.0f);
+	CHECK(parse_length(" 2.5px ", context, LengthAxis::None, value));
+	CHECK(value == 2.5f);
+	CHECK(parse_length("1in", context, LengthAxis::None, value));
+	CHECK_NEAR(value, 96.0, 1e-4);
+	CHECK(parse_length("2.54cm", context, LengthAxis::None, value));
+	CHECK_NEAR(value, 96.0, 1e-3);
+	CHECK(parse_length("25.4mm", context, LengthAxis::None, value));
+	CHECK_NEAR(value, 96.0, 1e-3);
+	CHECK(parse_length("72pt", context, LengthAxis::None, value));
+	CHECK_NEAR(value, 96.0, 1e-4);
+	CHECK(parse_length("6pc", context, LengthAxis::None, value));
+	CHECK_NEAR(value, 96.0, 1e-4);
+	CHECK(parse_length("2em", context, LengthAxis::None, value));
+	CHECK_NEAR(value, 24.0, 1e-4);
+
+	context.dpi = 192.0f;
+	CHECK(parse_length("1in", context, LengthAxis::None, value));
+	CHECK_NEAR(value, 192.0, 1e-4);
+}
+
+static void test_percentages() {
+	LengthContext context;
+	float value = 0.0f;
+
+	context.viewport_width = 200.0f;
+	context.viewport_height = 100.0f;
+
+	CHECK(parse_length("50%", context, LengthAxis::None, value));
+	CHECK_NEAR(value, 0.5, 1e-6);
+	CHECK(parse_length("50%", context, LengthAxis::Horizontal, value));
+	CHECK_NEAR(value, 100.0, 1e-4);
+	CHECK(parse_length("50%", context, LengthAxis::Vertical, value));
+	CHECK_NEAR(value, 50.0, 1e-4);
+	CHECK(parse_length("100%", context, LengthAxis::Diagonal, value));
+	CHECK_NEAR(value, std::sqrt(200.0 * 200.0 + 100.0 * 100.0) / std::sqrt(2.0), 1e-3);
+}
+
+static void test_errors() {
+	LengthContext context;
+	float value = 7.0f;
+
+	CHECK(!parse_length("", context, LengthAxis::None, value));
+	CHECK(!parse_length("px", context, LengthAxis::None, value));
+	CHECK(!parse_length("10 px", context, LengthAxis::None, value));
+	CHECK(!parse_length("10qq", context, LengthAxis::None, value));
+	CHECK(!parse_length("1 2", context, LengthAxis::None, value));
+	//value is left as is
+	CHECK(value == 7.0f);
+}
+
+static void test_number_or_percentage() {
+	float value = 0.0f;
+
+	CHECK(parse_number_or_percentage("0.5", value));
+	CHECK(value == 0.5f);
+	CHECK(parse_number_or_percentage("50%", value));
+	CHECK(value == 0.5f);
+	CHECK(!parse_number_or_percentage("half", value));
+}
+
+int main() {
+	test_units();
+	test_percentages();
+	test_errors();
+	test_number_or_percentage();
+
+	return CHECK_RESULT();
+}
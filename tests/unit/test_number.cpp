@@ -0,0 +1,119 @@
+#include <cstring>
+#include "number.h"
+#include "check.h"
+
+//Scans all numbers of source with scan_next_number() into values.
+//Returns how many were scanned before the first failure.
+static int scan_all(const char* source, float* values, int max_count) {
+	const char* p = source;
+	const char* end = source + std::strlen(source);
+	int count = 0;
+
+	while (count < max_count && scan_next_number(p, end, values[count])) {
+		++count;
+	}
+
+	return count;
+}
+
+static void test_forms() {
+	float values[8];
+
+	CHECK(scan_all("10", values, 8) == 1);
+	CHECK(values[0] == 10.0f);
+
+	CHECK(scan_all("-1.5 +2 .5 2e-3 1E2", values, 8) == 5);
+	CHECK(values[0] == -1.5f);
+	CHECK(values[1] == 2.0f);
+	CHECK(values[2] == 0.5f);
+	CHECK_NEAR(values[3], 0.002, 1e-9);
+	CHECK(values[4] == 100.0f);
+
+	CHECK(scan_all("0.1", values, 8) == 1);
+	CHECK(values[0] == 0.1f);
+	CHECK(scan_all("3.14159265", values, 8) == 1);
+	CHECK(values[0] == 3.14159265f);
+}
+
+static void test_separators() {
+	float values[8];
+
+	//Numbers can follow each other without a separator
+	CHECK(scan_all("-1-2", values, 8) == 2);
+	CHECK(values[0] == -1.0f);
+	CHECK(values[1] == -2.0f);
+
+	CHECK(scan_all(".5.5", values, 8) == 2);
+	CHECK(values[0] == 0.5f);
+	CHECK(values[1] == 0.5f);
+
+	CHECK(scan_all(" 1 ,\t2,\n3\r\n", values, 8) == 3);
+	CHECK(values[2] == 3.0f);
+}
+
+static void test_stops() {
+	const char source[] = "1em";
+	const char* p = source;
+	float value = 0.0f;
+
+	//An e without digits is not an exponent
+	CHECK(scan_number(p, source + 3, value));
+	CHECK(value == 1.0f);
+	CHECK(p == source + 1);
+
+	const char* end = source + 1;
+
+	//Nothing is read past end
+	p = source;
+	CHECK(scan_number(p, end, value));
+	CHECK(p == end);
+
+	const char letters[] = "abc";
+
+	p = letters;
+	CHECK(!scan_number(p, letters + 3, value));
+	CHECK(p == letters);
+
+	const char dot[] = ".";
+
+	p = dot;
+	CHECK(!scan_number(p, dot + 1, value));
+
+	const char huge[] = "1e39";
+
+	p = huge;
+	CHECK(!scan_number(p, huge + 4, value));
+}
+
+static void test_flags() {
+	const char source[] = "1 1 0 00 10 10";
+	const char* p = source;
+	const char* end = source + sizeof(source) - 1;
+	float value;
+	bool flag;
+
+	CHECK(scan_next_number(p, end, value));
+	CHECK(scan_next_number(p, end, value));
+	CHECK(scan_next_number(p, end, value));
+	//Flags don't need a separator
+	CHECK(scan_next_flag(p, end, flag));
+	CHECK(!flag);
+	CHECK(scan_next_flag(p, end, flag));
+	CHECK(!flag);
+	CHECK(scan_next_number(p, end, value));
+	CHECK(value == 10.0f);
+
+	const char two[] = "2";
+
+	p = two;
+	CHECK(!scan_next_flag(p, two + 1, flag));
+}
+
+int main() {
+	test_forms();
+	test_separators();
+	test_stops();
+	test_flags();
+
+	return CHECK_RESULT();
+}
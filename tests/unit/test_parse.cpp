@@ -0,0 +1,87 @@
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include "document.h"
+#include "check.h"
+
+//Parses every SVG file in the directories given on the command line, from the file
+//and from memory, and checks that both give the same document.
+
+static bool read_file(const std::filesystem::path& path, std::string& contents) {
+	std::ifstream file(path, std::ios::binary);
+
+	if (!file) {
+		return false;
+	}
+
+	contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+	return true;
+}
+
+static void test_file(const std::filesystem::path& path) {
+	SVGDocument document;
+
+	if (!SVG::parse(path.string().c_str(), document)) {
+		std::printf("%s: failed to parse\n", path.string().c_str());
+		CHECK(false);
+
+		return;
+	}
+
+	CHECK(document.root_element != nullptr);
+	CHECK(document.dom.size() > 0);
+	CHECK(document.dom.element[0] == document.root_element);
+
+	std::string contents;
+
+	CHECK(read_file(path, contents));
+
+	SVGDocument from_memory;
+
+	CHECK(SVG::parse_from_memory(contents.data(), contents.size(), from_memory));
+	CHECK(from_memory.dom.size() == document.dom.size());
+	CHECK(from_memory.dom.geometries.size() == document.dom.geometries.size());
+	CHECK(from_memory.id_map.size() == document.id_map.size());
+
+	for (NodeIndex i = 0; i < document.dom.size() && i < from_memory.dom.size(); ++i) {
+		CHECK(from_memory.dom.kind[i] == document.dom.kind[i]);
+	}
+}
+
+static void test_errors() {
+	SVGDocument document;
+	const char text[] = "<svg xmlns='http://www.w3.org/2000/svg'><rect width='10' height='10'/></svg>";
+
+	CHECK(SVG::parse_from_memory(text, sizeof(text) - 1, document));
+	CHECK(document.dom.size() == 2);
+	CHECK(document.dom.kind[1] == ElementKind::Rect);
+
+	const char unclosed[] = "<svg><g><rect width='10' height='10'/></svg>";
+
+	CHECK(!SVG::parse_from_memory(unclosed, sizeof(unclosed) - 1, document));
+	CHECK(!SVG::parse_from_memory(nullptr, 0, document));
+	CHECK(!SVG::parse("no such file.svg", document));
+}
+
+int main(int argc, char* argv[]) {
+	size_t file_count = 0;
+
+	for (int i = 1; i < argc; ++i) {
+		for (const auto& entry : std::filesystem::directory_iterator(argv[i])) {
+			if (entry.path().extension() == ".svg") {
+				test_file(entry.path());
+				++file_count;
+			}
+		}
+	}
+
+	CHECK(file_count > 0);
+
+	test_errors();
+
+	std::printf("%zu files parsed\n", file_count);
+
+	return CHECK_RESULT();
+}
@@ -0,0 +1,147 @@
+#include "path_data.h"
+#include "check.h"
+
+static void test_commands() {
+	PathData path;
+
+	CHECK(parse_path_data("M10 20 l5 5 H0 v-5 z", path));
+	CHECK(path.verbs.size() == 5);
+	CHECK(path.verbs[0] == PathVerb::MoveTo);
+	CHECK(path.verbs[1] == PathVerb::LineTo);
+	CHECK(path.verbs[2] == PathVerb::LineTo);
+	CHECK(path.verbs[3] == PathVerb::LineTo);
+	CHECK(path.verbs[4] == PathVerb::Close);
+
+	//Relative and horizontal or vertical commands are resolved to absolute lines
+	const float expected[] = { 10, 20, 15, 25, 0, 25, 0, 20 };
+
+	CHECK(path.coords.size() == 8);
+
+	for (size_t i = 0; i < 8 && i < path.coords.size(); ++i) {
+		CHECK(path.coords[i] == expected[i]);
+	}
+}
+
+static void test_implicit_commands() {
+	PathData path;
+
+	//Pairs after a moveto are linetos
+	CHECK(parse_path_data("m1 1 2 2 3 3", path));
+	CHECK(path.verbs.size() == 3);
+	CHECK(path.verbs[2] == PathVerb::LineTo);
+	CHECK(path.coords[4] == 6.0f);
+	CHECK(path.coords[5] == 6.0f);
+}
+
+static void test_curves() {
+	PathData path;
+
+	CHECK(parse_path_data("M0 0C1 1 2 1 3 0S5 -1 6 0Q7 1 8 0T10 0", path));
+	CHECK(path.verbs.size() == 5);
+	CHECK(path.verbs[2] == PathVerb::CubicTo);
+	//The first control point of S is the reflection of the last one of C
+	CHECK(path.coords[8] == 4.0f);
+	CHECK(path.coords[9] == -1.0f);
+	CHECK(path.verbs[4] == PathVerb::QuadTo);
+	CHECK(path.coords[18] == 9.0f);
+	CHECK(path.coords[19] == -1.0f);
+}
+
+static void test_arcs() {
+	PathData path;
+
+	//Flags need no separator
+	CHECK(parse_path_data("M0 0a10 10 0 1110 10", path));
+	CHECK(path.verbs.size() == 2);
+	CHECK(path.verbs[1] == PathVerb::ArcTo);
+	CHECK(path.coords[5] == 1.0f);
+	CHECK(path.coords[6] == 1.0f);
+	CHECK(path.coords[7] == 10.0f);
+	CHECK(path.coords[8] == 10.0f);
+
+	ArcCenter arc;
+
+	//Half a circle of radius 5 from (0, 0) to (10, 0)
+	const float c[] = { 5, 5, 0, 0, 1, 10, 0 };
+
+	CHECK(get_arc_center(0, 0, c, arc));
+	CHECK_NEAR(arc.cx, 5.0, 1e-6);
+	CHECK_NEAR(arc.cy, 0.0, 1e-6);
+	CHECK_NEAR(arc.rx, 5.0, 1e-6);
+
+	//Radii too small are scaled up
+	const float small[] = { 1, 1, 0, 0, 1, 10, 0 };
+
+	CHECK(get_arc_center(0, 0, small, arc));
+	CHECK_NEAR(arc.rx, 5.0, 1e-4);
+
+	//Zero radii make a straight line
+	const float flat[] = { 0, 0, 0, 0, 1, 10, 0 };
+
+	CHECK(!get_arc_center(0, 0, flat, arc));
+}
+
+static void test_errors() {
+	PathData path;
+
+	//Everything before the error is kept
+	CHECK(!parse_path_data("M0 0 L10 10 L20", path));
+	CHECK(path.verbs.size() == 2);
+
+	CHECK(!parse_path_data("M0 0 X10 10", path));
+	CHECK(path.verbs.size() == 1);
+
+	//Path data must start with a moveto
+	CHECK(!parse_path_data("L10 10", path));
+	CHECK(path.empty());
+}
+
+static void test_points() {
+	PathData path;
+
+	CHECK(parse_points("0,0 10,0 10,10", true, path));
+	CHECK(path.verbs.size() == 4);
+	CHECK(path.verbs[3] == PathVerb::Close);
+
+	//An odd number of coordinates is an error. The complete points are kept.
+	CHECK(!parse_points("0,0 10,0 10", false, path));
+	CHECK(path.verbs.size() == 2);
+}
+
+static void test_bounds() {
+	PathData path;
+	PathBounds bounds;
+
+	CHECK(!get_path_bounds(path, bounds));
+
+	append_rect(path, 10, 20, 30, 40);
+	CHECK(get_path_bounds(path, bounds));
+	CHECK(bounds.left == 10.0f);
+	CHECK(bounds.top == 20.0f);
+	CHECK(bounds.right == 40.0f);
+	CHECK(bounds.bottom == 60.0f);
+
+	//Curves are bounded by their extreme points, not their control points
+	path.clear();
+	CHECK(parse_path_data("M0 0C0 10 10 10 10 0", path));
+	CHECK(get_path_bounds(path, bounds));
+	CHECK_NEAR(bounds.bottom, 7.5, 1e-4);
+
+	path.clear();
+	append_ellipse(path, 50, 50, 10, 5);
+	CHECK(get_path_bounds(path, bounds));
+	CHECK_NEAR(bounds.left, 40.0, 1e-3);
+	CHECK_NEAR(bounds.bottom, 55.0, 1e-3);
+}
+
+int main() {
+	test_commands();
+	test_implicit_commands();
+	test_curves();
+	test_arcs();
+	test_errors();
+	test_points();
+	test_bounds();
+
+	return CHECK_RESULT();
+}
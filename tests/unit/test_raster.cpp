@@ -0,0 +1,122 @@
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include "document.h"
+#include "raster_renderer.h"
+#include "check.h"
+
+//Draws small documents with SVGRasterRenderer and checks pixels of the result
+
+struct Canvas {
+	std::vector<uint8_t> pixels;
+	SVGBitmap bitmap;
+
+	Canvas(uint32_t width, uint32_t height) : pixels(width * height * 4) {
+		bitmap.pixels = pixels.data();
+		bitmap.width = width;
+		bitmap.height = height;
+		bitmap.stride = width * 4;
+	}
+
+	const uint8_t* at(uint32_t x, uint32_t y) const {
+		return pixels.data() + y * bitmap.stride + x * 4;
+	}
+};
+
+static bool draw(const std::string& text, Canvas& canvas) {
+	auto document = std::make_shared<SVGDocument>();
+
+	if (!SVG::parse_from_memory(text.data(), text.size(), *document)) {
+		return false;
+	}
+
+	SVGImageBase image;
+
+	image.document = document;
+
+	SVGRasterRenderer renderer(canvas.bitmap, *document);
+
+	renderer.clear(1.0f, 1.0f, 1.0f, 1.0f);
+	SVG::render(renderer, image, renderer.get_clip());
+
+	return true;
+}
+
+static bool is_color(const uint8_t* pixel, int r, int g, int b, int a, int tolerance = 1) {
+	return std::abs(pixel[0] - r) <= tolerance && std::abs(pixel[1] - g) <= tolerance &&
+		std::abs(pixel[2] - b) <= tolerance && std::abs(pixel[3] - a) <= tolerance;
+}
+
+static void test_fill() {
+	Canvas canvas(20, 20);
+
+	CHECK(draw("<svg xmlns='http://www.w3.org/2000/svg' width='20' height='20'>"
+		"<rect x='5' y='5' width='10' height='10' fill='#ff0000'/></svg>", canvas));
+	CHECK(is_color(canvas.at(10, 10), 255, 0, 0, 255));
+	CHECK(is_color(canvas.at(2, 2), 255, 255, 255, 255));
+	CHECK(is_color(canvas.at(15, 10), 255, 255, 255, 255));
+}
+
+static void test_coverage() {
+	Canvas canvas(20, 20);
+
+	//The left edge covers half of the pixels of column 5
+	CHECK(draw("<svg xmlns='http://www.w3.org/2000/svg' width='20' height='20'>"
+		"<rect x='5.5' y='0' width='10' height='20' fill='#000000'/></svg>", canvas));
+	CHECK(is_color(canvas.at(5, 10), 128, 128, 128, 255, 2));
+	CHECK(is_color(canvas.at(6, 10), 0, 0, 0, 255));
+}
+
+static void test_fill_rule() {
+	Canvas canvas(30, 30);
+	//Two squares, one inside the other, drawn in the same direction
+	const char* squares = "M0 0H30V30H0Z M10 10H20V20H10Z";
+
+	CHECK(draw(std::string("<svg xmlns='http://www.w3.org/2000/svg' width='30' height='30'>"
+		"<path fill-rule='evenodd' d='") + squares + "'/></svg>", canvas));
+	CHECK(is_color(canvas.at(15, 15), 255, 255, 255, 255));
+	CHECK(is_color(canvas.at(5, 5), 0, 0, 0, 255));
+
+	CHECK(draw(std::string("<svg xmlns='http://www.w3.org/2000/svg' width='30' height='30'>"
+		"<path fill-rule='nonzero' d='") + squares + "'/></svg>", canvas));
+	CHECK(is_color(canvas.at(15, 15), 0, 0, 0, 255));
+}
+
+#ifndef SVGLIB_NO_GRADIENTS
+static void test_gradient() {
+	Canvas canvas(100, 10);
+
+	CHECK(draw("<svg xmlns='http://www.w3.org/2000/svg' width='100' height='10'>"
+		"<linearGradient id='g'><stop offset='0' stop-color='#000000'/><stop offset='1' stop-color='#0000ff'/></linearGradient>"
+		"<rect width='100' height='10' fill='url(#g)'/></svg>", canvas));
+	CHECK(canvas.at(2, 5)[2] < 16);
+	CHECK(canvas.at(97, 5)[2] > 240);
+	CHECK(canvas.at(25, 5)[2] < canvas.at(75, 5)[2]);
+}
+#endif
+
+static void test_overflow() {
+	Canvas canvas(20, 20);
+
+	//Coordinates that overflow when they are transformed must not be drawn out of the
+	//target. The square after them is still drawn.
+	CHECK(draw("<svg xmlns='http://www.w3.org/2000/svg' width='20' height='20'>"
+		"<path d='M3e38 0 L0 10Z' transform='scale(10)'/>"
+		"<path d='M-3e38 -3e38 L3e38 3e38 L0 10Z' transform='scale(10)'/>"
+		"<rect x='5' y='5' width='10' height='10' fill='#00ff00'/></svg>", canvas));
+	CHECK(is_color(canvas.at(10, 10), 0, 255, 0, 255));
+}
+
+int main() {
+	test_fill();
+	test_coverage();
+	test_fill_rule();
+#ifndef SVGLIB_NO_GRADIENTS
+	test_gradient();
+#endif
+	test_overflow();
+
+	return CHECK_RESULT();
+}
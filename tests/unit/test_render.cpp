@@ -0,0 +1,114 @@
+#include <memory>
+#include <string>
+#include "document.h"
+#include "check.h"
+
+//Checks what SVG::render() draws and culls for a clip, walking the dom, from a display
+//list, and from the index of a large display list.
+
+static const char culled_document[] =
+	"<svg xmlns='http://www.w3.org/2000/svg' xmlns:xlink='http://www.w3.org/1999/xlink' width='400' height='100'>"
+	"<g id='left'>"
+	"<rect x='0' y='0' width='10' height='10'/>"
+	"<rect x='20' y='0' width='10' height='10'/>"
+	"<rect x='40' y='0' width='10' height='10'/>"
+	"</g>"
+	"<g>"
+	"<rect x='300' y='0' width='10' height='10'/>"
+	"<rect x='320' y='0' width='10' height='10'/>"
+	"</g>"
+	"<circle cx='150' cy='50' r='10'/>"
+	//Outside of the clip, but its stroke reaches into it
+	"<rect x='105' y='0' width='10' height='10' fill='none' stroke='black' stroke-width='20'/>"
+	"<use xlink:href='#left' x='200'/>"
+	"</svg>";
+
+static std::shared_ptr<SVGDocument> parse(const std::string& text) {
+	auto document = std::make_shared<SVGDocument>();
+
+	CHECK(SVG::parse_from_memory(text.data(), text.size(), *document));
+
+	return document;
+}
+
+static void test_culling(bool compiled) {
+	SVGImageBase image;
+
+	image.document = parse(culled_document);
+
+	if (compiled) {
+		compile_display_list(image.document->dom, image.display_list);
+	}
+
+	SVGCountingRenderer renderer;
+	SVGRenderStats stats;
+
+	SVG::render(renderer, image, Bounds{ 0.0f, 0.0f, 100.0f, 100.0f }, &stats);
+
+	CHECK(stats.drawn == 4);
+	CHECK(stats.culled == 6);
+	CHECK(renderer.counts.fills == 3);
+	CHECK(renderer.counts.strokes == 1);
+
+	//The dom walk tests every shape. The display list skips the right hand group and
+	//the <use> instance as a whole.
+	CHECK(stats.culled_groups == (compiled ? 2 : 0));
+
+	SVGCountingRenderer all;
+
+	SVG::render(all, image, &stats);
+
+	CHECK(stats.drawn == 10);
+	CHECK(stats.culled == 0);
+	CHECK(all.counts.fills == 9);
+}
+
+static void test_indexed() {
+	//A grid large enough for the display list to get an index
+	std::string text = "<svg xmlns='http://www.w3.org/2000/svg' width='1280' height='1280'>";
+	const int cells = 128;
+
+	for (int y = 0; y < cells; ++y) {
+		for (int x = 0; x < cells; ++x) {
+			text += "<rect x='" + std::to_string(x * 10) + "' y='" + std::to_string(y * 10) + "' width='5' height='5'/>";
+		}
+	}
+
+	text += "</svg>";
+
+	SVGImageBase image;
+
+	image.document = parse(text);
+	compile_display_list(image.document->dom, image.display_list);
+
+	CHECK(image.display_list.ops.size() == cells * cells);
+	CHECK(!image.display_list.index.empty());
+
+	//Columns and rows 0 to 9 reach the clip
+	Bounds clip{ 0.0f, 0.0f, 99.0f, 99.0f };
+	SVGCountingRenderer renderer;
+	SVGRenderStats indexed, walked;
+
+	SVG::render(renderer, image, clip, &indexed);
+
+	CHECK(indexed.drawn == 100);
+	CHECK(indexed.culled == cells * cells - 100);
+	CHECK(indexed.culled_groups == 0);
+	CHECK(renderer.counts.fills == 100);
+
+	//The dom walk must agree with the index
+	image.display_list = SVGDisplayList();
+
+	SVG::render(renderer, image, clip, &walked);
+
+	CHECK(walked.drawn == indexed.drawn);
+	CHECK(walked.culled == indexed.culled);
+}
+
+int main() {
+	test_culling(false);
+	test_culling(true);
+	test_indexed();
+
+	return CHECK_RESULT();
+}
@@ -0,0 +1,142 @@
+#include <cmath>
+#include "transform.h"
+#include "check.h"
+
+static bool is_matrix(const Matrix& m, float a, float b, float c, float d, float e, float f) {
+	const float tolerance = 1e-5f;
+
+	return std::abs(m.a - a) < tolerance && std::abs(m.b - b) < tolerance && std::abs(m.c - c) < tolerance &&
+		std::abs(m.d - d) < tolerance && std::abs(m.e - e) < tolerance && std::abs(m.f - f) < tolerance;
+}
+
+static void test_functions() {
+	Matrix m;
+
+	CHECK(parse_transform("translate(10 20)", m));
+	CHECK(is_matrix(m, 1, 0, 0, 1, 10, 20));
+
+	m = Matrix();
+	CHECK(parse_transform("scale(2)", m));
+	CHECK(is_matrix(m, 2, 0, 0, 2, 0, 0));
+
+	m = Matrix();
+	CHECK(parse_transform("rotate(90)", m));
+	CHECK(is_matrix(m, 0, 1, -1, 0, 0, 0));
+
+	m = Matrix();
+	CHECK(parse_transform("matrix(1,2,3,4,5,6)", m));
+	CHECK(is_matrix(m, 1, 2, 3, 4, 5, 6));
+
+	m = Matrix();
+	CHECK(parse_transform("skewX(45)", m));
+	CHECK(is_matrix(m, 1, 0, 1, 1, 0, 0));
+}
+
+static void test_lists() {
+	Matrix m;
+
+	//The last function applies to points first
+	CHECK(parse_transform("translate(10,0) scale(2)", m));
+
+	float x = 1.0f, y = 1.0f;
+
+	m.transform_point(x, y);
+	CHECK_NEAR(x, 12.0, 1e-5);
+	CHECK_NEAR(y, 2.0, 1e-5);
+
+	//Separators are optional between functions
+	m = Matrix();
+	CHECK(parse_transform(" translate( 1 , 2 ),scale(3)rotate(0) ", m));
+	CHECK(is_matrix(m, 3, 0, 0, 3, 1, 2));
+}
+
+static void test_units() {
+	Matrix m;
+
+	CHECK(parse_transform("rotate(0.25turn)", m));
+	CHECK(is_matrix(m, 0, 1, -1, 0, 0, 0));
+
+	m = Matrix();
+	CHECK(parse_transform("translate(5px, 6px)", m));
+	CHECK(is_matrix(m, 1, 0, 0, 1, 5, 6));
+
+	//px only goes on lengths
+	m = Matrix();
+	CHECK(!parse_transform("scale(2px)", m));
+	CHECK(!parse_transform("rotate(90px)", m));
+	CHECK(parse_transform("rotate(90, 5px, 5px)", m));
+}
+
+static void test_errors() {
+	Matrix m = Matrix::translation(1, 1);
+
+	//A list with an error is invalid as a whole and leaves the matrix as is
+	CHECK(!parse_transform("translate(10) bogus(1)", m));
+	CHECK(!parse_transform("translate(10", m));
+	CHECK(!parse_transform("matrix(1 2 3)", m));
+	CHECK(is_matrix(m, 1, 0, 0, 1, 1, 1));
+}
+
+static void test_matrix() {
+	Matrix m = Matrix::scale(2, 4).then(Matrix::translation(10, 20));
+	Matrix inverse;
+
+	CHECK(m.invert(inverse));
+
+	float x = 3.0f, y = 5.0f;
+
+	m.transform_point(x, y);
+	inverse.transform_point(x, y);
+	CHECK_NEAR(x, 3.0, 1e-5);
+	CHECK_NEAR(y, 5.0, 1e-5);
+
+	CHECK(!Matrix::scale(0, 1).invert(inverse));
+
+	//Rotated boxes are bounded by their corners
+	Bounds box = transform_bounds(Bounds{ 0, 0, 10, 10 }, 0.0f, Matrix::rotation(45));
+
+	CHECK_NEAR(box.left, -7.0710678, 1e-4);
+	CHECK_NEAR(box.right, 7.0710678, 1e-4);
+	CHECK_NEAR(box.bottom, 14.142136, 1e-4);
+
+	CHECK(bounds_intersect(Bounds{ 0, 0, 10, 10 }, Bounds{ 10, 10, 20, 20 }));
+	CHECK(!bounds_intersect(Bounds{ 0, 0, 10, 10 }, Bounds{ 11, 0, 20, 10 }));
+	CHECK(bounds_contain(Bounds{ 0, 0, 10, 10 }, Bounds{ 0, 0, 10, 10 }));
+}
+
+static void test_viewbox() {
+	float x, y, width, height;
+
+	CHECK(parse_viewbox("0 0 100 50", x, y, width, height));
+	CHECK(width == 100.0f);
+	CHECK(!parse_viewbox("0 0 100", x, y, width, height));
+
+	AspectRatio ratio;
+
+	//A 100 by 50 viewBox in a 200 by 200 viewport is scaled by 2 and centered
+	Matrix m = viewbox_transform(0, 0, 100, 50, 200, 200, ratio);
+
+	CHECK(is_matrix(m, 2, 0, 0, 2, 0, 50));
+
+	CHECK(parse_aspect_ratio("xMinYMin slice", ratio));
+	CHECK(ratio.align_x == 0.0f);
+	CHECK(ratio.slice);
+
+	m = viewbox_transform(0, 0, 100, 50, 200, 200, ratio);
+	CHECK(is_matrix(m, 4, 0, 0, 4, 0, 0));
+
+	CHECK(parse_aspect_ratio("none", ratio));
+	CHECK(!ratio.preserve);
+	CHECK(!parse_aspect_ratio("middle", ratio));
+}
+
+int main() {
+	test_functions();
+	test_lists();
+	test_units();
+	test_errors();
+	test_matrix();
+	test_viewbox();
+
+	return CHECK_RESULT();
+}
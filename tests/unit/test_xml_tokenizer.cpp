@@ -0,0 +1,115 @@
+#include <string>
+#include <string_view>
+#include "xml_tokenizer.h"
+#include "check.h"
+
+static XmlTokenizer tokenizer(std::string_view text) {
+	return XmlTokenizer(text.data(), text.size());
+}
+
+static void test_elements() {
+	const std::string_view text = "<?xml version='1.0'?><!DOCTYPE svg><!-- a comment --><svg width=\"10\"><rect x='1'/><g></g></svg>";
+	XmlTokenizer xml = tokenizer(text);
+	std::string_view value;
+
+	CHECK(xml.next() == XmlToken::StartElement);
+	CHECK(xml.local_name() == "svg");
+	CHECK(xml.get_attribute("width", value));
+	CHECK(value == "10");
+
+	CHECK(xml.next() == XmlToken::StartElement);
+	CHECK(xml.local_name() == "rect");
+	CHECK(xml.is_empty_element());
+	CHECK(xml.attributes().size() == 1);
+
+	CHECK(xml.next() == XmlToken::StartElement);
+	CHECK(xml.local_name() == "g");
+	CHECK(!xml.is_empty_element());
+	CHECK(xml.next() == XmlToken::EndElement);
+	CHECK(xml.next() == XmlToken::EndElement);
+	CHECK(xml.local_name() == "svg");
+	CHECK(xml.next() == XmlToken::EndOfDocument);
+	CHECK(xml.next() == XmlToken::EndOfDocument);
+}
+
+static void test_namespaces() {
+	XmlTokenizer xml = tokenizer("<svg:use xlink:href='#a' inkscape:label='x' href='#b'/>");
+	std::string_view value;
+
+	CHECK(xml.next() == XmlToken::StartElement);
+	CHECK(xml.prefix() == "svg");
+	CHECK(xml.local_name() == "use");
+	//href wins over xlink:href
+	CHECK(xml.get_attribute("href", value));
+	CHECK(value == "#b");
+	CHECK(!xml.get_attribute("label", value));
+	CHECK(xml.attributes()[0].is_svg_attribute());
+	CHECK(!xml.attributes()[1].is_svg_attribute());
+
+	XmlTokenizer xlink = tokenizer("<use xlink:href='#a'/>");
+
+	CHECK(xlink.next() == XmlToken::StartElement);
+	CHECK(xlink.get_attribute("href", value));
+	CHECK(value == "#a");
+}
+
+static void test_text() {
+	XmlTokenizer xml = tokenizer("<text a='&lt;&#65;&#x42;'>1 &amp; 2<![CDATA[<3>]]></text>");
+	std::string_view value;
+
+	CHECK(xml.next() == XmlToken::StartElement);
+	CHECK(xml.get_attribute("a", value));
+	CHECK(value == "<AB");
+	CHECK(xml.next() == XmlToken::Text);
+	CHECK(xml.text() == "1 & 2");
+	CHECK(xml.next() == XmlToken::Text);
+	CHECK(xml.text() == "<3>");
+	CHECK(xml.next() == XmlToken::EndElement);
+
+	std::string decoded;
+
+	xml_decode_entities("&quot;&apos;&unknown;", decoded);
+	CHECK(decoded == "\"'&unknown;");
+}
+
+static void test_errors() {
+	const std::string_view malformed[] = {
+		"<svg><g></svg>",
+		"<svg>",
+		"<svg a='1' a2></svg>",
+		"<svg a='1></svg>",
+		"</svg>",
+	};
+
+	for (std::string_view text : malformed) {
+		XmlTokenizer xml = tokenizer(text);
+		XmlToken token;
+
+		do {
+			token = xml.next();
+		} while (token != XmlToken::Error && token != XmlToken::EndOfDocument);
+
+		if (token != XmlToken::Error) {
+			std::printf("not an error: %.*s\n", static_cast<int>(text.size()), text.data());
+		}
+
+		CHECK(token == XmlToken::Error);
+		CHECK(xml.next() == XmlToken::Error);
+	}
+
+	//Nothing is read past the end of the buffer
+	const char text[] = "<svg/>trailing";
+	XmlTokenizer xml(text, 6);
+
+	CHECK(xml.next() == XmlToken::StartElement);
+	CHECK(xml.next() == XmlToken::EndOfDocument);
+}
+
+int main() {
+	test_elements();
+	test_namespaces();
+	test_text();
+	test_errors();
+
+	return CHECK_RESULT();
+}
@@ -1,17 +1,12 @@
-#pragma once
-
-struct SVGTextElement : public SVGGraphicsElement {
-	std::wstring text_content;
-	CComPtr<IDWriteFactory> dwrite_factory;
-	CComPtr<IDWriteTextFormat> text_format;
-	CComPtr<IDWriteTextLayout> text_layout;
-	float baseline = 0.0f;
-
-	SVGTextElement() = default;
-	SVGTextElement(const SVGTextElement& that);
-
-	void create_presentation_assets(const std::vector<std::shared_ptr<SVGGraphicsElement>>& parent_stack, const std::map<std::wstring, std::shared_ptr<SVGGraphicsElement>>& id_map, const SVGDevice& device) override;
-	void compute_bbox() override;
-	void render(const SVGDevice& device) const override;
-	std::shared_ptr<SVGGraphicsElement> clone() const override;
+#pragma once
+
+struct SVGTextElement : public SVGGraphicsElement {
+	std::pmr::wstring text_content;
+
+	using ArenaOwned = SVGTextElement;
+	explicit SVGTextElement(Arena& arena);
+
+	void create_presentation_assets(const ComputedStyle& style, const std::map<std::string_view, SVGGraphicsElement*>& id_map, const LengthContext& lengths, const SVGDevice& device, SVGElementAssets& assets) const;
+	void compute_bbox();
+	void render(SVGRenderer& renderer, const SVGPaint& paint) const;
 };
\ No newline at end of file
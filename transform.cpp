@@ -0,0 +1,525 @@
+#include "transform.h"
+#include "number.h"
+#include <cmath>
+
+static const float pi = 3.14159265358979f;
+
+static float degrees_to_radians(float angle) {
+	return angle * pi / 180.0f;
+}
+
+Matrix Matrix::translation(float tx, float ty) {
+	return Matrix{ 1.0f, 0.0f, 0.0f, 1.0f, tx, ty };
+}
+
+Matrix Matrix::scale(float sx, float sy) {
+	return Matrix{ sx, 0.0f, 0.0f, sy, 0.0f, 0.0f };
+}
+
+Matrix Matrix::rotation(float angle) {
+	float radians = degrees_to_radians(angle);
+	float cos_a = std::cos(radians);
+	float sin_a = std::sin(radians);
+
+	return Matrix{ cos_a, sin_a, -sin_a, cos_a, 0.0f, 0.0f };
+}
+
+Matrix Matrix::rotation(float angle, float cx, float cy) {
+	//Move the center to the origin, rotate and move it back
+	return translation(-cx, -cy).then(rotation(angle)).then(translation(cx, cy));
+}
+
+Matrix Matrix::skew_x(float angle) {
+	return Matrix{ 1.0f, 0.0f, std::tan(degrees_to_radians(angle)), 1.0f, 0.0f, 0.0f };
+}
+
+Matrix Matrix::skew_y(float angle) {
+	return Matrix{ 1.0f, std::tan(degrees_to_radians(angle)), 0.0f, 1.0f, 0.0f, 0.0f };
+}
+
+Matrix Matrix::then(const Matrix& m) const {
+	return Matrix{
+		a * m.a + b * m.c,
+		a * m.b + b * m.d,
+		c * m.a + d * m.c,
+		c * m.b + d * m.d,
+		e * m.a + f * m.c + m.e,
+		e * m.b + f * m.d + m.f
+	};
+}
+
+void Matrix::transform_point(float& x, float& y) const {
+	float tx = a * x + c * y + e;
+
+	y = b * x + d * y + f;
+	x = tx;
+}
+
+bool Matrix::invert(Matrix& result) const {
+	float det = a * d - b * c;
+
+	if (det == 0.0f) {
+		return false;
+	}
+
+	result = Matrix{
+		d / det,
+		-b / det,
+		-c / det,
+		a / det,
+		(c * f - d * e) / det,
+		(b * e - a * f) / det
+	};
+
+	return true;
+}
+
+Bounds infinite_bounds() {
+	return Bounds{ -INFINITY, -INFINITY, INFINITY, INFINITY };
+}
+
+Bounds transform_bounds(const Bounds& box, float margin, const Matrix& matrix) {
+	float xs[4] = { box.left - margin, box.right + margin, box.right + margin, box.left - margin };
+	float ys[4] = { box.top - margin, box.top - margin, box.bottom + margin, box.bottom + margin };
+
+	for (int i = 0; i < 4; ++i) {
+		matrix.transform_point(xs[i], ys[i]);
+	}
+
+	Bounds result{ xs[0], ys[0], xs[0], ys[0] };
+
+	for (int i = 1; i < 4; ++i) {
+		result.left = std::fmin(result.left, xs[i]);
+		result.top = std::fmin(result.top, ys[i]);
+		result.right = std::fmax(result.right, xs[i]);
+		result.bottom = std::fmax(result.bottom, ys[i]);
+	}
+
+	return result;
+}
+
+bool bounds_intersect(const Bounds& a, const Bounds& b) {
+	return a.left <= b.right && b.left <= a.right && a.top <= b.bottom && b.top <= a.bottom;
+}
+
+bool bounds_contain(const Bounds& bounds, const Bounds& box) {
+	return bounds.left <= box.left && box.right <= bounds.right && bounds.top <= box.top && box.bottom <= bounds.bottom;
+}
+
+void add_bounds(Bounds& bounds, const Bounds& box) {
+	bounds.left = std::fmin(bounds.left, box.left);
+	bounds.top = std::fmin(bounds.top, box.top);
+	bounds.right = std::fmax(bounds.right, box.right);
+	bounds.bottom = std::fmax(bounds.bottom, box.bottom);
+}
+
+enum class TransformFunction {
+	Matrix,
+	Translate,
+	TranslateX,
+	TranslateY,
+	Scale,
+	ScaleX,
+	ScaleY,
+	Rotate,
+	Skew,
+	SkewX,
+	SkewY
+};
+
+static bool is_letter(char ch) {
+	return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z');
+}
+
+static bool find_transform_function(std::string_view name, TransformFunction& function) {
+	static const struct {
+		std::string_view name;
+		TransformFunction function;
+	} functions[] = {
+		{ "matrix", TransformFunction::Matrix },
+		{ "translate", TransformFunction::Translate },
+		{ "translateX", TransformFunction::TranslateX },
+		{ "translateY", TransformFunction::TranslateY },
+		{ "scale", TransformFunction::Scale },
+		{ "scaleX", TransformFunction::ScaleX },
+		{ "scaleY", TransformFunction::ScaleY },
+		{ "rotate", TransformFunction::Rotate },
+		{ "skew", TransformFunction::Skew },
+		{ "skewX", TransformFunction::SkewX },
+		{ "skewY", TransformFunction::SkewY },
+	};
+
+	for (const auto& f : functions) {
+		if (f.name == name) {
+			function = f.function;
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//True if argument number index of the function is an angle
+static bool is_angle_argument(TransformFunction function, int index) {
+	switch (function) {
+	case TransformFunction::Rotate:
+		return index == 0;
+	case TransformFunction::Skew:
+	case TransformFunction::SkewX:
+	case TransformFunction::SkewY:
+		return true;
+	default:
+		return false;
+	}
+}
+
+//True if argument number index of the function is a length: the offsets of a
+//translation and the center of a rotation
+static bool is_length_argument(TransformFunction function, int index) {
+	switch (function) {
+	case TransformFunction::Translate:
+	case TransformFunction::TranslateX:
+	case TransformFunction::TranslateY:
+		return true;
+	case TransformFunction::Rotate:
+		return index > 0;
+	default:
+		return false;
+	}
+}
+
+//Reads an optional unit after an argument. Angles are converted to degrees.
+static bool scan_unit(const char*& p, const char* end, TransformFunction function, int index, float& value) {
+	const char* unit_start = p;
+
+	while (p < end && is_letter(*p)) {
+		++p;
+	}
+
+	std::string_view unit(unit_start, p - unit_start);
+
+	if (unit.empty()) {
+		return true;
+	}
+
+	if (is_angle_argument(function, index)) {
+		if (unit == "deg") {
+			return true;
+		}
+		if (unit == "grad") {
+			value *= 0.9f;
+
+			return true;
+		}
+		if (unit == "rad") {
+			value *= 180.0f / pi;
+
+			return true;
+		}
+		if (unit == "turn") {
+			value *= 360.0f;
+
+			return true;
+		}
+
+		return false;
+	}
+
+	//Lengths in a transform are in user units
+	return unit == "px" && is_length_argument(function, index);
+}
+
+//Builds the matrix of one function. Returns false if the number of arguments is wrong.
+static bool build_function_matrix(TransformFunction function, const float* args, int count, Matrix& m) {
+	switch (function) {
+	case TransformFunction::Matrix:
+		if (count != 6) {
+			return false;
+		}
+
+		m = Matrix{ args[0], args[1], args[2], args[3], args[4], args[5] };
+
+		return true;
+	case TransformFunction::Translate:
+		if (count != 1 && count != 2) {
+			return false;
+		}
+
+		m = Matrix::translation(args[0], count == 2 ? args[1] : 0.0f);
+
+		return true;
+	case TransformFunction::TranslateX:
+		if (count != 1) {
+			return false;
+		}
+
+		m = Matrix::translation(args[0], 0.0f);
+
+		return true;
+	case TransformFunction::TranslateY:
+		if (count != 1) {
+			return false;
+		}
+
+		m = Matrix::translation(0.0f, args[0]);
+
+		return true;
+	case TransformFunction::Scale:
+		if (count != 1 && count != 2) {
+			return false;
+		}
+
+		m = Matrix::scale(args[0], count == 2 ? args[1] : args[0]);
+
+		return true;
+	case TransformFunction::ScaleX:
+		if (count != 1) {
+			return false;
+		}
+
+		m = Matrix::scale(args[0], 1.0f);
+
+		return true;
+	case TransformFunction::ScaleY:
+		if (count != 1) {
+			return false;
+		}
+
+		m = Matrix::scale(1.0f, args[0]);
+
+		return true;
+	case TransformFunction::Rotate:
+		if (count == 1) {
+			m = Matrix::rotation(args[0]);
+
+			return true;
+		}
+		if (count == 3) {
+			m = Matrix::rotation(args[0], args[1], args[2]);
+
+			return true;
+		}
+
+		return false;
+	case TransformFunction::Skew:
+		if (count != 1 && count != 2) {
+			return false;
+		}
+
+		m = Matrix{ 1.0f, std::tan(degrees_to_radians(count == 2 ? args[1] : 0.0f)), std::tan(degrees_to_radians(args[0])), 1.0f, 0.0f, 0.0f };
+
+		return true;
+	case TransformFunction::SkewX:
+		if (count != 1) {
+			return false;
+		}
+
+		m = Matrix::skew_x(args[0]);
+
+		return true;
+	case TransformFunction::SkewY:
+		if (count != 1) {
+			return false;
+		}
+
+		m = Matrix::skew_y(args[0]);
+
+		return true;
+	}
+
+	return false;
+}
+
+bool parse_transform(std::string_view source, Matrix& matrix) {
+	const char* p = source.data();
+	const char* end = p + source.length();
+	//The combined transform of the functions read so far
+	Matrix result;
+
+	p = skip_spaces(p, end);
+
+	while (p < end) {
+		//Function name
+		const char* name_start = p;
+
+		while (p < end && is_letter(*p)) {
+			++p;
+		}
+
+		TransformFunction function;
+
+		if (!find_transform_function(std::string_view(name_start, p - name_start), function)) {
+			return false;
+		}
+
+		p = skip_spaces(p, end);
+
+		if (p == end || *p != '(') {
+			return false;
+		}
+
+		p = skip_spaces(p + 1, end);
+
+		//Arguments
+		float args[6];
+		int count = 0;
+
+		while (p < end && *p != ')') {
+			if (count > 0 && *p == ',') {
+				p = skip_spaces(p + 1, end);
+			}
+
+			if (count == 6 || !scan_number(p, end, args[count])) {
+				return false;
+			}
+
+			if (!scan_unit(p, end, function, count, args[count])) {
+				return false;
+			}
+
+			++count;
+			p = skip_spaces(p, end);
+		}
+
+		if (p == end) {
+			//Missing )
+			return false;
+		}
+
+		++p;
+
+		Matrix m;
+
+		if (!build_function_matrix(function, args, count, m)) {
+			return false;
+		}
+
+		//The functions apply from right to left. So this function
+		//applies before the ones that were read so far.
+		result = m.then(result);
+
+		//Functions are separated by white space and/or a comma
+		p = skip_spaces(p, end);
+
+		if (p < end && *p == ',') {
+			p = skip_spaces(p + 1, end);
+
+			if (p == end) {
+				return false;
+			}
+		}
+	}
+
+	matrix = result;
+
+	return true;
+}
+
+bool parse_viewbox(std::string_view source, float& x, float& y, float& width, float& height) {
+	const char* p = source.data();
+	const char* end = p + source.length();
+	float values[4];
+
+	for (float& value : values) {
+		if (!scan_next_number(p, end, value)) {
+			return false;
+		}
+	}
+
+	if (skip_separators(p, end) != end) {
+		return false;
+	}
+
+	x = values[0];
+	y = values[1];
+	width = values[2];
+	height = values[3];
+
+	return true;
+}
+
+bool parse_aspect_ratio(std::string_view source, AspectRatio& ratio) {
+	const char* p = source.data();
+	const char* end = p + source.length();
+	AspectRatio result;
+
+	auto next_word = [&]() {
+		p = skip_spaces(p, end);
+
+		const char* start = p;
+
+		while (p < end && !is_svg_space(*p)) {
+			++p;
+		}
+
+		return std::string_view(start, p - start);
+	};
+
+	std::string_view align = next_word();
+
+	if (align == "none") {
+		result.preserve = false;
+	}
+	else if (align.size() == 8 && align[0] == 'x' && align[4] == 'Y') {
+		auto get_align = [](std::string_view name, float& value) {
+			if (name == "Min") {
+				value = 0.0f;
+			}
+			else if (name == "Mid") {
+				value = 0.5f;
+			}
+			else if (name == "Max") {
+				value = 1.0f;
+			}
+			else {
+				return false;
+			}
+
+			return true;
+		};
+
+		if (!get_align(align.substr(1, 3), result.align_x) || !get_align(align.substr(5, 3), result.align_y)) {
+			return false;
+		}
+	}
+	else {
+		return false;
+	}
+
+	std::string_view meet_or_slice = next_word();
+
+	if (meet_or_slice == "slice") {
+		result.slice = true;
+	}
+	else if (!meet_or_slice.empty() && meet_or_slice != "meet") {
+		return false;
+	}
+
+	if (!next_word().empty()) {
+		return false;
+	}
+
+	ratio = result;
+
+	return true;
+}
+
+Matrix viewbox_transform(float x, float y, float width, float height, float viewport_width, float viewport_height, const AspectRatio& ratio) {
+	float scale_x = viewport_width / width;
+	float scale_y = viewport_height / height;
+
+	if (ratio.preserve) {
+		//meet uses the smaller scale so that all of the viewBox is visible
+		float scale = (scale_x < scale_y) != ratio.slice ? scale_x : scale_y;
+
+		scale_x = scale;
+		scale_y = scale;
+	}
+
+	//Align the scaled viewBox within the viewport
+	float tx = (viewport_width - width * scale_x) * (ratio.preserve ? ratio.align_x : 0.0f);
+	float ty = (viewport_height - height * scale_y) * (ratio.preserve ? ratio.align_y : 0.0f);
+
+	return Matrix::translation(-x, -y).then(Matrix::scale(scale_x, scale_y)).then(Matrix::translation(tx, ty));
+}
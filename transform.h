@@ -0,0 +1,83 @@
+#pragma once
+
+#include <string_view>
+
+//A 2D affine transform with the same layout as matrix(a, b, c, d, e, f) in SVG
+//and D2D1_MATRIX_3X2_F. A point is transformed as:
+//x' = a * x + c * y + e
+//y' = b * x + d * y + f
+struct Matrix {
+	float a = 1.0f, b = 0.0f, c = 0.0f, d = 1.0f, e = 0.0f, f = 0.0f;
+
+	static Matrix translation(float tx, float ty);
+	static Matrix scale(float sx, float sy);
+	//Angles are in degrees. Positive angles rotate clockwise since y points down.
+	static Matrix rotation(float angle);
+	static Matrix rotation(float angle, float cx, float cy);
+	static Matrix skew_x(float angle);
+	static Matrix skew_y(float angle);
+
+	//Returns the transform that applies this transform first and then that.
+	//Same as the D2D1 expression this * that.
+	Matrix then(const Matrix& that) const;
+
+	void transform_point(float& x, float& y) const;
+
+	//Sets result to the transform that undoes this one. Returns false and leaves
+	//result as is if there is none, like for a scale by 0.
+	bool invert(Matrix& result) const;
+};
+
+//An axis aligned box, like the extent of a shape or the visible part of an image
+struct Bounds {
+	float left = 0.0f, top = 0.0f, right = 0.0f, bottom = 0.0f;
+};
+
+//Bounds that hold every point. For shapes whose extent is not known.
+Bounds infinite_bounds();
+
+//Returns the bounds of box after growing it by margin on every side and mapping it
+//with matrix. The corners are mapped, so the result holds the box under any rotation or skew.
+Bounds transform_bounds(const Bounds& box, float margin, const Matrix& matrix);
+
+//True if the boxes overlap or touch. Bounds with a NaN don't overlap anything.
+bool bounds_intersect(const Bounds& a, const Bounds& b);
+
+//True if box is inside bounds, edges included
+bool bounds_contain(const Bounds& bounds, const Bounds& box);
+
+//Grows bounds to hold box
+void add_bounds(Bounds& bounds, const Bounds& box);
+
+//How a viewBox is fitted into a viewport. Parsed from preserveAspectRatio.
+//The default is xMidYMid meet.
+struct AspectRatio {
+	//0, 0.5 or 1 for the Min, Mid and Max alignments
+	float align_x = 0.5f;
+	float align_y = 0.5f;
+	//False for none. The viewBox is then stretched to the viewport.
+	bool preserve = true;
+	//True if the viewBox covers the viewport (slice) instead of fitting in it (meet)
+	bool slice = false;
+};
+
+//Parses the value of a transform attribute into matrix. The SVG 2 grammar is
+//followed: functions and their arguments may be separated by white space and/or
+//commas. Supported functions are matrix, translate, translateX, translateY, scale,
+//scaleX, scaleY, rotate, skew, skewX and skewY. Angles may have a deg, grad, rad
+//or turn unit and lengths a px unit.
+//A transform list with an error is invalid as a whole. In that case false is
+//returned and matrix is left as is. Does not allocate or throw.
+bool parse_transform(std::string_view source, Matrix& matrix);
+
+//Parses the "min-x min-y width height" value of a viewBox attribute.
+//Returns false unless there are exactly four numbers.
+bool parse_viewbox(std::string_view source, float& x, float& y, float& width, float& height);
+
+//Parses the value of a preserveAspectRatio attribute, like "xMinYMid slice".
+//Returns false and leaves ratio as is if the value is invalid.
+bool parse_aspect_ratio(std::string_view source, AspectRatio& ratio);
+
+//Returns the transform that fits the viewBox (x, y, width, height) into a viewport of
+//viewport_width by viewport_height at the origin. The viewBox size must not be 0.
+Matrix viewbox_transform(float x, float y, float width, float height, float viewport_width, float viewport_height, const AspectRatio& ratio);
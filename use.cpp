@@ -1,6 +0,0 @@
-#include "svglib.h"
-#include "use.h"
-
-void SVGUseElement::create_presentation_assets(const std::vector<std::shared_ptr<SVGGraphicsElement>>& parent_stack, const std::map<std::wstring, std::shared_ptr<SVGGraphicsElement>>& id_map, const SVGDevice& device) {
-
-}
\ No newline at end of file
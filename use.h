@@ -1,7 +1,13 @@
-#pragma once
-struct SVGUseElement : public SVGGraphicsElement {
-	std::wstring href_id;
-
-	void create_presentation_assets(const std::vector<std::shared_ptr<SVGGraphicsElement>>& parent_stack, const std::map<std::wstring, std::shared_ptr<SVGGraphicsElement>>& id_map, const SVGDevice& device) override;
-};
-
+#pragma once
+
+//Represents <use> elements. A <use> element draws an instance of the element it
+//references. It is not replaced by a copy. See SVGInstance.
+struct SVGUseElement : public SVGGraphicsElement {
+	//Copied into the arena of the document
+	std::string_view href_id;
+	//Size of the viewport of a referenced <symbol>. Overrides the size of the symbol.
+	std::optional<float> width, height;
+
+	using ArenaOwned = SVGUseElement;
+	using SVGGraphicsElement::SVGGraphicsElement;
+};
@@ -1,29 +1,25 @@
-#pragma once
-
-#include <xmllite.h>
-
-#ifdef DEBUG
-#define DEBUG_OUT(x) {std::wstringstream ws; ws << x << std::endl; OutputDebugStringW(ws.str().c_str());}
-#else
-#define DEBUG_OUT(x)
-#endif
-
-struct TransformFunction {
-	std::wstring name;
-	std::vector<float> values;
-};
-
-void ltrim_str(std::wstring_view& source);
-void rtrim_str(std::wstring_view& source);
-void collapse_whitespace(std::wstring_view& source, std::wstring& result);
-std::vector<std::wstring_view> split_string(std::wstring_view source, std::wstring_view separator);
-bool get_css_color(std::wstring_view source, float& r, float& g, float& b, float& a);
-bool get_attribute(IXmlReader* xml_reader, const wchar_t* attr_name, std::wstring_view& attr_value);
-bool get_href_id(IXmlReader* xml_reader, std::wstring_view& ref_id);
-bool get_href_id(std::wstring_view source, std::wstring_view& ref_id);
-bool get_size_value(ID2D1DeviceContext* pContext, const std::wstring_view& source, float& size);
-bool get_size_attribute(IXmlReader* xml_reader, ID2D1DeviceContext* device_context, const wchar_t* attr_name, float& size);
-bool get_transform_functions(const std::wstring_view& source, std::vector<TransformFunction>& functions);
-bool build_transform_matrix(const std::wstring_view& transform_str, D2D1_MATRIX_3X2_F& matrix);
-bool char_is_number(wchar_t ch);
-void build_reference_chain(const SVGGraphicsElement& element, const std::map<std::wstring, std::shared_ptr<SVGGraphicsElement>>& id_map, std::vector<std::shared_ptr<SVGGraphicsElement>>& chain);
\ No newline at end of file
+#pragma once
+
+#include "xml_tokenizer.h"
+#include "transform.h"
+#include "length.h"
+
+#ifdef DEBUG
+#define DEBUG_OUT(x) {std::stringstream ws; ws << x << std::endl; OutputDebugStringA(ws.str().c_str());}
+#else
+#define DEBUG_OUT(x)
+#endif
+
+void ltrim_str(std::string_view& source);
+void rtrim_str(std::string_view& source);
+void collapse_whitespace(std::string_view& source, std::string& result);
+void utf8_to_wide(std::string_view source, std::pmr::wstring& result);
+bool utf16_to_utf8(const unsigned char* data, size_t size, std::string& result);
+std::vector<std::string_view> split_string(std::string_view source, std::string_view separator);
+bool get_attribute(const XmlTokenizer& xml_reader, const char* attr_name, std::string_view& attr_value);
+bool get_href_id(const XmlTokenizer& xml_reader, std::string_view& ref_id);
+bool get_href_id(std::string_view source, std::string_view& ref_id);
+bool get_size_attribute(const XmlTokenizer& xml_reader, const LengthContext& context, const char* attr_name, float& size, LengthAxis axis = LengthAxis::None);
+bool build_transform_matrix(const std::string_view& transform_str, Matrix& matrix);
+bool char_is_number(char ch);
+void build_reference_chain(const SVGGraphicsElement& element, const std::map<std::string_view, SVGGraphicsElement*>& id_map, std::vector<SVGGraphicsElement*>& chain);
\ No newline at end of file
@@ -0,0 +1,460 @@
+#include "xml_tokenizer.h"
+#include <cstring>
+
+static inline bool is_xml_space(char ch) {
+	return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+}
+
+//Characters that end an element or attribute name
+static inline bool is_name_end(char ch) {
+	return is_xml_space(ch) || ch == '/' || ch == '>' || ch == '=' || ch == '<';
+}
+
+static void split_qualified_name(std::string_view qname, std::string_view& prefix, std::string_view& local_name) {
+	size_t colon = qname.find(':');
+
+	if (colon == std::string_view::npos) {
+		prefix = std::string_view();
+		local_name = qname;
+	}
+	else {
+		prefix = qname.substr(0, colon);
+		local_name = qname.substr(colon + 1);
+	}
+}
+
+static void append_utf8(unsigned long code_point, std::string& out) {
+	if (code_point < 0x80) {
+		out.push_back(static_cast<char>(code_point));
+	}
+	else if (code_point < 0x800) {
+		out.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+		out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+	}
+	else if (code_point < 0x10000) {
+		out.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+		out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+		out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+	}
+	else {
+		out.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+		out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+		out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+		out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+	}
+}
+
+//Decodes a single entity like "lt" or "#x20". Returns false if it is unknown.
+static bool decode_entity(std::string_view entity, std::string& out) {
+	if (entity == "lt") {
+		out.push_back('<');
+	}
+	else if (entity == "gt") {
+		out.push_back('>');
+	}
+	else if (entity == "amp") {
+		out.push_back('&');
+	}
+	else if (entity == "quot") {
+		out.push_back('"');
+	}
+	else if (entity == "apos") {
+		out.push_back('\'');
+	}
+	else if (entity.size() > 1 && entity[0] == '#') {
+		unsigned long code_point = 0;
+		bool is_hex = entity[1] == 'x' || entity[1] == 'X';
+		size_t i = is_hex ? 2 : 1;
+
+		if (i == entity.size()) {
+			return false;
+		}
+
+		for (; i < entity.size(); ++i) {
+			char ch = entity[i];
+			unsigned long digit;
+
+			if (ch >= '0' && ch <= '9') {
+				digit = ch - '0';
+			}
+			else if (is_hex && ch >= 'a' && ch <= 'f') {
+				digit = ch - 'a' + 10;
+			}
+			else if (is_hex && ch >= 'A' && ch <= 'F') {
+				digit = ch - 'A' + 10;
+			}
+			else {
+				return false;
+			}
+
+			code_point = code_point * (is_hex ? 16 : 10) + digit;
+
+			if (code_point > 0x10FFFF) {
+				return false;
+			}
+		}
+
+		if (code_point == 0) {
+			return false;
+		}
+
+		append_utf8(code_point, out);
+	}
+	else {
+		return false;
+	}
+
+	return true;
+}
+
+void xml_decode_entities(std::string_view source, std::string& out) {
+	size_t start = 0;
+
+	while (start < source.length()) {
+		size_t amp = source.find('&', start);
+
+		if (amp == std::string_view::npos) {
+			break;
+		}
+
+		out.append(source.data() + start, amp - start);
+
+		size_t semicolon = source.find(';', amp + 1);
+
+		if (semicolon == std::string_view::npos || !decode_entity(source.substr(amp + 1, semicolon - amp - 1), out)) {
+			//Not a valid entity. Keep the ampersand as is.
+			out.push_back('&');
+			start = amp + 1;
+
+			continue;
+		}
+
+		start = semicolon + 1;
+	}
+
+	if (start < source.length()) {
+		out.append(source.data() + start, source.length() - start);
+	}
+}
+
+XmlTokenizer::XmlTokenizer(const char* data, size_t size)
+	: begin(data), pos(data), end(data + size) {
+
+	//Skip the UTF-8 byte order mark
+	if (size >= 3 && memcmp(data, "\xEF\xBB\xBF", 3) == 0) {
+		pos += 3;
+	}
+}
+
+XmlToken XmlTokenizer::fail() {
+	state = XmlToken::Error;
+
+	return state;
+}
+
+//Moves past the next occurrence of terminator. Returns false if it is not found.
+bool XmlTokenizer::skip_past(std::string_view terminator) {
+	std::string_view rest(pos, end - pos);
+	size_t found = rest.find(terminator);
+
+	if (found == std::string_view::npos) {
+		return false;
+	}
+
+	pos += found + terminator.length();
+
+	return true;
+}
+
+//Skips <!DOCTYPE ...> including an internal subset in square brackets.
+bool XmlTokenizer::skip_doctype() {
+	int bracket_depth = 0;
+	char quote = 0;
+
+	for (; pos < end; ++pos) {
+		char ch = *pos;
+
+		if (quote != 0) {
+			if (ch == quote) {
+				quote = 0;
+			}
+		}
+		else if (ch == '"' || ch == '\'') {
+			quote = ch;
+		}
+		else if (ch == '[') {
+			++bracket_depth;
+		}
+		else if (ch == ']') {
+			--bracket_depth;
+		}
+		else if (ch == '>' && bracket_depth <= 0) {
+			++pos;
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void XmlTokenizer::skip_spaces() {
+	while (pos < end && is_xml_space(*pos)) {
+		++pos;
+	}
+}
+
+std::string_view XmlTokenizer::read_name() {
+	const char* start = pos;
+
+	while (pos < end && !is_name_end(*pos)) {
+		++pos;
+	}
+
+	return std::string_view(start, pos - start);
+}
+
+XmlToken XmlTokenizer::next() {
+	if (state == XmlToken::Error || state == XmlToken::EndOfDocument) {
+		return state;
+	}
+
+	attrs.clear();
+	empty_element = false;
+
+	while (pos < end) {
+		if (*pos != '<') {
+			return state = read_text();
+		}
+
+		std::string_view rest(pos, end - pos);
+
+		if (rest.compare(0, 4, "<!--") == 0) {
+			pos += 4;
+
+			if (!skip_past("-->")) {
+				return fail();
+			}
+		}
+		else if (rest.compare(0, 9, "<![CDATA[") == 0) {
+			const char* start = pos + 9;
+
+			pos = start;
+
+			if (!skip_past("]]>")) {
+				return fail();
+			}
+
+			//CDATA content is returned verbatim
+			text_value = std::string_view(start, pos - 3 - start);
+
+			return state = XmlToken::Text;
+		}
+		else if (rest.compare(0, 2, "<?") == 0) {
+			//XML declaration and processing instructions
+			pos += 2;
+
+			if (!skip_past("?>")) {
+				return fail();
+			}
+		}
+		else if (rest.compare(0, 2, "<!") == 0) {
+			pos += 2;
+
+			if (!skip_doctype()) {
+				return fail();
+			}
+		}
+		else if (rest.compare(0, 2, "</") == 0) {
+			return state = read_end_tag();
+		}
+		else {
+			return state = read_start_tag();
+		}
+	}
+
+	if (!open_elements.empty()) {
+		//Premature end of document
+		return fail();
+	}
+
+	return state = XmlToken::EndOfDocument;
+}
+
+XmlToken XmlTokenizer::read_text() {
+	const char* start = pos;
+	const void* lt = memchr(pos, '<', end - pos);
+
+	pos = lt ? static_cast<const char*>(lt) : end;
+	text_value = std::string_view(start, pos - start);
+
+	if (text_value.find('&') != std::string_view::npos) {
+		decoded.clear();
+		xml_decode_entities(text_value, decoded);
+		text_value = decoded;
+	}
+
+	return XmlToken::Text;
+}
+
+XmlToken XmlTokenizer::read_start_tag() {
+	++pos; //Skip '<'
+
+	std::string_view qname = read_name();
+
+	if (qname.empty()) {
+		return fail();
+	}
+
+	split_qualified_name(qname, name_prefix, name_local);
+
+	//Length of all values that need entity decoding
+	size_t decode_length = 0;
+
+	//Read all attributes in one pass
+	while (true) {
+		skip_spaces();
+
+		if (pos >= end) {
+			return fail();
+		}
+
+		if (*pos == '>') {
+			++pos;
+
+			open_elements.push_back(qname);
+
+			break;
+		}
+
+		if (*pos == '/') {
+			if (pos + 1 >= end || pos[1] != '>') {
+				return fail();
+			}
+
+			pos += 2;
+			empty_element = true;
+
+			break;
+		}
+
+		XmlAttribute attr;
+		std::string_view attr_name = read_name();
+
+		if (attr_name.empty()) {
+			return fail();
+		}
+
+		split_qualified_name(attr_name, attr.prefix, attr.local_name);
+
+		skip_spaces();
+
+		if (pos >= end || *pos != '=') {
+			return fail();
+		}
+
+		++pos;
+
+		skip_spaces();
+
+		if (pos >= end || (*pos != '"' && *pos != '\'')) {
+			return fail();
+		}
+
+		char quote = *pos++;
+		const void* closing = memchr(pos, quote, end - pos);
+
+		if (closing == nullptr) {
+			return fail();
+		}
+
+		attr.value = std::string_view(pos, static_cast<const char*>(closing) - pos);
+		pos = static_cast<const char*>(closing) + 1;
+
+		if (attr.value.find('&') != std::string_view::npos) {
+			//Leave room for a null terminator after each decoded value
+			decode_length += attr.value.length() + 1;
+		}
+
+		attrs.push_back(attr);
+	}
+
+	if (decode_length > 0) {
+		decoded.clear();
+		//A decoded value is never longer than its source. Reserving up front
+		//keeps views into the buffer valid while values are appended.
+		decoded.reserve(decode_length);
+
+		for (auto& attr : attrs) {
+			if (attr.value.find('&') == std::string_view::npos) {
+				continue;
+			}
+
+			size_t start = decoded.length();
+
+			xml_decode_entities(attr.value, decoded);
+
+			attr.value = std::string_view(decoded.data() + start, decoded.length() - start);
+
+			//Values from the input buffer are always followed by a quote. Keep
+			//decoded values delimited the same way for parsers that scan past the end.
+			decoded.push_back('\0');
+		}
+	}
+
+	return XmlToken::StartElement;
+}
+
+XmlToken XmlTokenizer::read_end_tag() {
+	pos += 2; //Skip "</"
+
+	std::string_view qname = read_name();
+
+	skip_spaces();
+
+	if (qname.empty() || pos >= end || *pos != '>') {
+		return fail();
+	}
+
+	++pos;
+
+	if (open_elements.empty() || open_elements.back() != qname) {
+		//Mismatched end tag
+		return fail();
+	}
+
+	open_elements.pop_back();
+
+	split_qualified_name(qname, name_prefix, name_local);
+
+	return XmlToken::EndElement;
+}
+
+bool XmlTokenizer::get_attribute(std::string_view local_name, std::string_view& value) const {
+	bool found = false;
+
+	for (const auto& attr : attrs) {
+		if (attr.local_name != local_name || !attr.is_svg_attribute()) {
+			continue;
+		}
+
+		value = attr.value;
+		found = true;
+
+		if (attr.prefix.empty()) {
+			break;
+		}
+	}
+
+	return found;
+}
+
+bool XmlTokenizer::text_is_whitespace() const {
+	for (char ch : text_value) {
+		if (!is_xml_space(ch)) {
+			return false;
+		}
+	}
+
+	return true;
+}
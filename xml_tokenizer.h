@@ -0,0 +1,97 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+//Kinds of tokens returned by XmlTokenizer::next().
+enum class XmlToken {
+	StartElement,
+	EndElement,
+	Text,
+	EndOfDocument,
+	Error
+};
+
+//An attribute of the current start tag. All views point into the input
+//buffer, unless the value had entity references. Decoded values point into
+//a scratch buffer owned by the tokenizer. Either way they remain valid until
+//the next call to XmlTokenizer::next().
+struct XmlAttribute {
+	//Namespace prefix, such as "xlink" for xlink:href. Empty if there is none.
+	std::string_view prefix;
+	std::string_view local_name;
+	std::string_view value;
+
+	//True for attributes of SVG itself: the ones without a prefix, and xlink:href, the
+	//SVG 1.1 spelling of href. Attributes of other namespaces, like sodipodi:cx or
+	//inkscape:label, share local names with SVG ones but mean something else.
+	bool is_svg_attribute() const { return prefix.empty() || (prefix == "xlink" && local_name == "href"); }
+};
+
+//A zero-copy pull tokenizer for UTF-8 encoded XML. Only the subset of XML
+//used by SVG documents is supported. Comments, processing instructions and the
+//DOCTYPE declaration are skipped. CDATA sections are returned as Text.
+//Well-formedness of the element structure is checked, but DTD validation and
+//namespace URI resolution are not done.
+//The input buffer is not copied and must outlive the tokenizer.
+class XmlTokenizer {
+public:
+	XmlTokenizer(const char* data, size_t size);
+
+	//Advances to the next token. Once Error or EndOfDocument is
+	//returned all subsequent calls return the same.
+	XmlToken next();
+
+	//Name of the current start or end element.
+	std::string_view prefix() const { return name_prefix; }
+	std::string_view local_name() const { return name_local; }
+
+	//True if the current start element is self closing like <rect/>.
+	//No EndElement token is returned for such elements.
+	bool is_empty_element() const { return empty_element; }
+
+	//All attributes of the current start element in document order.
+	//They are read in one scan when the start tag is tokenized.
+	const std::vector<XmlAttribute>& attributes() const { return attrs; }
+
+	//Looks up an SVG attribute of the current start element by its local name. Only
+	//attributes without a prefix are found, and xlink:href for "href" when there is no
+	//href. See XmlAttribute::is_svg_attribute().
+	bool get_attribute(std::string_view local_name, std::string_view& value) const;
+
+	//Character data of the current Text token with entity references decoded.
+	std::string_view text() const { return text_value; }
+
+	//True if the current Text token only has white spaces.
+	bool text_is_whitespace() const;
+
+	//Byte offset of the tokenizer in the input. Useful to report errors.
+	size_t offset() const { return static_cast<size_t>(pos - begin); }
+
+private:
+	const char* begin;
+	const char* pos;
+	const char* end;
+	XmlToken state = XmlToken::StartElement;
+	std::string_view name_prefix;
+	std::string_view name_local;
+	std::string_view text_value;
+	bool empty_element = false;
+	std::vector<XmlAttribute> attrs;
+	std::vector<std::string_view> open_elements;
+	std::string decoded;
+
+	XmlToken fail();
+	bool skip_past(std::string_view terminator);
+	bool skip_doctype();
+	void skip_spaces();
+	std::string_view read_name();
+	XmlToken read_start_tag();
+	XmlToken read_end_tag();
+	XmlToken read_text();
+};
+
+//Replaces the predefined entities and character references in source
+//and appends the result to out. Unknown entities are kept as is.
+void xml_decode_entities(std::string_view source, std::string& out);